@@ -0,0 +1,103 @@
+#include <micro/micro.h>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Packet pipeline like workload: objects of the same size are allocated
+// and freed in bursts of 32-256, either one by one or with the batch API.
+
+static std::atomic<int> errors{ 0 };
+
+static constexpr int kNumIterations = 20000;
+static constexpr size_t kMaxBurst = 256;
+
+template<class Alloc, class Free>
+static void burst_thread(unsigned seed, Alloc alloc, Free free_all)
+{
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<> burst_distribution(32, kMaxBurst);
+    std::uniform_int_distribution<> size_distribution(8, 512);
+
+    void* ptrs[kMaxBurst];
+    for (int i = 0; i < kNumIterations; ++i) {
+        size_t count = static_cast<size_t>(burst_distribution(gen));
+        size_t size = static_cast<size_t>(size_distribution(gen));
+
+        if (alloc(size, count, ptrs) != count) {
+            ++errors;
+            return;
+        }
+        for (size_t j = 0; j < count; ++j) {
+            char* p = static_cast<char*>(ptrs[j]);
+            p[0] = p[size - 1] = static_cast<char>(j);
+        }
+        for (size_t j = 0; j < count; ++j) {
+            const char* p = static_cast<const char*>(ptrs[j]);
+            if (p[0] != static_cast<char>(j) || p[size - 1] != static_cast<char>(j)) {
+                ++errors;
+                return;
+            }
+        }
+        free_all(ptrs, count);
+    }
+}
+
+template<class Alloc, class Free>
+static int bench(const char* name, unsigned threads, Alloc alloc, Free free_all)
+{
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> ths;
+    for (unsigned i = 0; i < threads; ++i)
+        ths.emplace_back([=]() { burst_thread(42 + i, alloc, free_all); });
+    for (auto& t : ths)
+        t.join();
+    const auto end = std::chrono::steady_clock::now();
+
+    const auto num_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    std::cout << name << ": " << threads << " threads, burst allocations done in " << num_ms << "ms." << std::endl;
+    return errors.load() == 0 ? 0 : 1;
+}
+
+int batch_alloc(int, char** const)
+{
+    int res = 0;
+#ifdef MICRO_BENCH_MICROMALLOC
+    auto single_alloc = [](size_t size, size_t count, void** out) -> size_t {
+        for (size_t i = 0; i < count; ++i)
+            if (!(out[i] = micro_malloc(size)))
+                return i;
+        return count;
+    };
+    auto single_free = [](void** ptrs, size_t count) {
+        for (size_t i = 0; i < count; ++i)
+            micro_free(ptrs[i]);
+    };
+    auto batched_alloc = [](size_t size, size_t count, void** out) { return micro_malloc_batch(size, count, out); };
+    auto batched_free = [](void** ptrs, size_t count) { micro_free_batch(ptrs, count); };
+
+    res |= bench("micro (single)", 1, single_alloc, single_free);
+    res |= bench("micro (batch)", 1, batched_alloc, batched_free);
+    res |= bench("micro (single)", 4, single_alloc, single_free);
+    res |= bench("micro (batch)", 4, batched_alloc, batched_free);
+    micro::allocator_trim("micro");
+
+    // Mixed batch: small and medium chunks, with null pointers
+    {
+        void* ptrs[64];
+        if (micro_malloc_batch(24, 32, ptrs) != 32 || micro_malloc_batch(2000, 31, ptrs + 32) != 31)
+            res |= 1;
+        ptrs[63] = nullptr;
+        std::shuffle(ptrs, ptrs + 64, std::mt19937(0));
+        micro_free_batch(ptrs, 64);
+    }
+    micro::print_process_infos();
+#endif
+    return res;
+}
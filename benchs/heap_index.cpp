@@ -0,0 +1,101 @@
+#include <micro/micro.h>
+#include <micro/micro.hpp>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+// Address to manager lookup with an increasing number of heaps.
+// The lookup cost must not depend on the number of heaps alive.
+
+using namespace micro::detail;
+
+static constexpr size_t kNumLookups = 2000000;
+static constexpr size_t kChunksPerHeap = 16;
+
+static int foreign_object = 0;
+
+static int bench(size_t heap_count)
+{
+	int errors = 0;
+	std::mt19937 gen(42);
+	std::uniform_int_distribution<size_t> medium_distribution(1024, 64 * 1024);
+
+	std::vector<micro_heap*> heaps(heap_count);
+	std::vector<void*> ptrs;
+	std::vector<size_t> owners;
+	for (size_t i = 0; i < heap_count; ++i) {
+		heaps[i] = micro_heap_create();
+		for (size_t j = 0; j < kChunksPerHeap; ++j) {
+			// Mix small, medium and big chunks
+			size_t size = (j & 1) ? 16 + j * 8 : (j == 0 ? 4 * 1024 * 1024 : medium_distribution(gen));
+			void* p = micro_heap_malloc(heaps[i], size);
+			if (!p)
+				return 1;
+			ptrs.push_back(p);
+			owners.push_back(i);
+		}
+	}
+
+	// Chunks of the same heap share the same manager, different heaps use different managers
+	std::vector<MemoryManager*> mgrs(heap_count, nullptr);
+	for (size_t i = 0; i < ptrs.size(); ++i) {
+		MemoryManager* m = MemoryManager::find_from_ptr(ptrs[i]);
+		if (!m)
+			++errors;
+		else if (!mgrs[owners[i]])
+			mgrs[owners[i]] = m;
+		else if (mgrs[owners[i]] != m)
+			++errors;
+	}
+	for (size_t i = 1; i < heap_count; ++i)
+		if (mgrs[i] == mgrs[i - 1])
+			++errors;
+
+	// Foreign addresses
+	int stack_object = 0;
+	if (MemoryManager::find_from_ptr(&stack_object) || MemoryManager::find_from_ptr(&foreign_object))
+		++errors;
+
+	std::uniform_int_distribution<size_t> dist(0, ptrs.size() - 1);
+	std::vector<void*> queries(kNumLookups);
+	for (auto& q : queries)
+		q = static_cast<char*>(ptrs[dist(gen)]) + 8;
+
+	size_t found = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (void* q : queries)
+		found += MemoryManager::find_from_ptr(q) != nullptr;
+	const auto end = std::chrono::steady_clock::now();
+	if (found != kNumLookups)
+		++errors;
+
+	const auto num_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+	std::cout << heap_count << " heaps: " << static_cast<double>(num_ns) / kNumLookups << "ns per lookup" << std::endl;
+
+	for (void* p : ptrs)
+		micro_free(p);
+	for (micro_heap* h : heaps)
+		micro_heap_destroy(h);
+
+	// Destroyed heaps must not be found anymore
+	for (void* p : ptrs)
+		if (MemoryManager::find_from_ptr(p))
+			++errors;
+	return errors;
+}
+
+int heap_index(int, char** const)
+{
+	int errors = 0;
+#ifdef MICRO_BENCH_MICROMALLOC
+	errors += bench(1);
+	errors += bench(16);
+	errors += bench(256);
+	if (errors)
+		std::cout << errors << " heap index errors" << std::endl;
+#endif
+	return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+#include <micro/micro.h>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Huge pages of the OS page provider (MicroHugePages): big chunks are allocated
+// in page runs aligned on the huge page size, and random accesses through a
+// large table are timed for each mode. Transparent huge pages reduce TLB misses
+// if enabled on the system, explicit huge pages fall back to them if the huge
+// page pool is empty.
+
+static constexpr size_t kHugePageSize = 2u << 20u;
+static constexpr size_t kTableSize = 256u << 20u;
+static constexpr size_t kNumAccesses = 4000000;
+
+static size_t anon_huge_pages_kb()
+{
+	// Transparent huge pages currently used by the process
+	std::ifstream in("/proc/self/smaps_rollup");
+	std::string line;
+	while (std::getline(in, line))
+		if (line.compare(0, 14, "AnonHugePages:") == 0)
+			return static_cast<size_t>(std::strtoull(line.c_str() + 14, nullptr, 10));
+	return 0;
+}
+
+static int bench(const char* name, unsigned mode)
+{
+	int errors = 0;
+	micro_heap* h = micro_heap_create();
+	micro_heap_set_parameter(h, MicroHugePages, mode);
+
+	// Big chunks of at least one huge page start in a huge page aligned page run
+	std::vector<char*> chunks;
+	for (size_t size : { kHugePageSize, 3 * kHugePageSize + 12345, 16 * kHugePageSize }) {
+		char* p = static_cast<char*>(micro_heap_malloc(h, size));
+		if (!p) {
+			++errors;
+			continue;
+		}
+		if (mode != MicroHugePagesNone && reinterpret_cast<std::uintptr_t>(p) % kHugePageSize > 4096)
+			++errors;
+		memset(p, static_cast<int>(size), size);
+		chunks.push_back(p);
+	}
+	// Huge page runs are not remapped: growing copies the content
+	if (!chunks.empty()) {
+		char* p = static_cast<char*>(micro_realloc(chunks[0], 8 * kHugePageSize));
+		if (!p || p[kHugePageSize - 1] != static_cast<char>(kHugePageSize))
+			++errors;
+		else
+			chunks[0] = p;
+	}
+	for (char* p : chunks)
+		micro_free(p);
+
+	// Random accesses in a large table
+	std::uint32_t* table = static_cast<std::uint32_t*>(micro_heap_malloc(h, kTableSize));
+	if (!table) {
+		micro_heap_destroy(h);
+		return errors + 1;
+	}
+	const size_t count = kTableSize / sizeof(std::uint32_t);
+	for (size_t i = 0; i < count; ++i)
+		table[i] = static_cast<std::uint32_t>(i);
+	const size_t huge_kb = anon_huge_pages_kb();
+
+	std::mt19937 gen(42);
+	std::uint32_t sum = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < kNumAccesses; ++i)
+		sum += table[gen() % count];
+	const auto end = std::chrono::steady_clock::now();
+	std::cout << name << ": " << kNumAccesses << " random accesses in " << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << "ms, "
+		  << huge_kb / 1024 << "MB of transparent huge pages (" << sum << ")" << std::endl;
+
+	micro_free(table);
+	micro_heap_destroy(h);
+	return errors;
+}
+
+int huge_pages(int, char** const)
+{
+	int errors = 0;
+	errors += bench("default pages", MicroHugePagesNone);
+	errors += bench("transparent huge pages", MicroHugePagesTransparent);
+	errors += bench("explicit huge pages", MicroHugePagesExplicit);
+	if (errors)
+		std::cout << errors << " huge pages errors" << std::endl;
+	return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+#include <micro/micro.h>
+#include <micro/internal/defines.hpp>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// Threads sharing a single arena, each one working on its own size class.
+// Neighbor size classes (small objects) and neighbor radix tree positions
+// (medium chunks) use locks that might share a cache line.
+// Compare builds with and without MICRO_PAD_LOCKS, together with
+// the cache_scratch and mstress benchmarks.
+
+static std::atomic<int> errors{ 0 };
+
+static constexpr int kNumIterations = 1000000;
+static constexpr size_t kBatch = 16;
+
+static void class_thread(micro_heap* h, size_t size)
+{
+    void* ptrs[kBatch];
+    for (int i = 0; i < kNumIterations / static_cast<int>(kBatch); ++i) {
+        for (size_t j = 0; j < kBatch; ++j) {
+            char* p = static_cast<char*>(micro_heap_malloc(h, size));
+            if (!p) {
+                ++errors;
+                return;
+            }
+            p[0] = p[size - 1] = static_cast<char>(size);
+            ptrs[j] = p;
+        }
+        for (size_t j = 0; j < kBatch; ++j) {
+            if (static_cast<char*>(ptrs[j])[size - 1] != static_cast<char>(size))
+                ++errors;
+            micro_free(ptrs[j]);
+        }
+    }
+}
+
+static int bench(const char* name, unsigned threads, size_t base_size)
+{
+    micro_heap* h = micro_heap_create();
+    micro_heap_set_parameter(h, MicroMaxArenas, 1);
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> ths;
+    for (unsigned i = 0; i < threads; ++i)
+        ths.emplace_back(class_thread, h, base_size + i * 16u);
+    for (auto& t : ths)
+        t.join();
+    const auto end = std::chrono::steady_clock::now();
+
+    const auto num_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    std::cout << name << ": " << threads << " threads, done in " << num_ms << "ms." << std::endl;
+    micro_heap_destroy(h);
+    return errors.load() == 0 ? 0 : 1;
+}
+
+int lock_layout(int, char** const)
+{
+    int res = 0;
+#ifdef MICRO_BENCH_MICROMALLOC
+    std::cout << "MICRO_PAD_LOCKS: " << MICRO_PAD_LOCKS << std::endl;
+    res |= bench("micro (small, neighbor classes)", 1, 16);
+    res |= bench("micro (small, neighbor classes)", 4, 16);
+    res |= bench("micro (medium, neighbor radix positions)", 1, 1024);
+    res |= bench("micro (medium, neighbor radix positions)", 4, 1024);
+    micro::print_process_infos();
+#endif
+    return res;
+}
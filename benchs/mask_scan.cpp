@@ -0,0 +1,136 @@
+#include <micro/micro.h>
+#include <micro/internal/uint_large.hpp>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <chrono>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Best fit lookup in a 2 levels bit mask, as done by the radix tree
+// (UInt256 first level, UInt512 leaves), on sparse and dense trees.
+// Results are checked against a naive scan.
+
+using namespace micro::detail;
+
+static constexpr unsigned kL0 = 256;
+static constexpr unsigned kL1 = 512;
+static constexpr size_t kNumLookups = 2000000;
+
+struct Tree
+{
+	UInt256 mask;
+	UInt512 leaves[kL0];
+	std::vector<bool> ref = std::vector<bool>(kL0 * kL1, false);
+
+	void set(unsigned pos)
+	{
+		leaves[pos / kL1].set(pos % kL1);
+		mask.set(pos / kL1);
+		ref[pos] = true;
+	}
+
+	// Same algorithm as RadixTree::lower_bound()
+	unsigned lower_bound(unsigned pos) const
+	{
+		unsigned index0 = pos / kL1;
+		unsigned index1 = pos % kL1;
+		for (;;) {
+			unsigned i0 = mask.scan_forward(index0);
+			if (i0 == kL0)
+				return kL0 * kL1;
+			if (i0 != index0)
+				index1 = 0;
+			unsigned i1 = leaves[i0].scan_forward(index1);
+			if (i1 != kL1)
+				return i0 * kL1 + i1;
+			if (++i0 == kL0)
+				return kL0 * kL1;
+			index0 = i0;
+			index1 = 0;
+		}
+	}
+
+	unsigned naive_lower_bound(unsigned pos) const
+	{
+		while (pos < kL0 * kL1 && !ref[pos])
+			++pos;
+		return pos;
+	}
+};
+
+template<class U, unsigned Bits>
+static int check_mask(std::mt19937& gen)
+{
+	// Compare scan_forward() and null() to a naive scan on random masks
+	int errors = 0;
+	std::uniform_int_distribution<unsigned> dist(0, Bits - 1);
+	for (unsigned count = 0; count < 8; ++count) {
+		U u;
+		std::vector<bool> ref(Bits, false);
+		if (!u.null())
+			++errors;
+		for (unsigned k = 0; k < count; ++k) {
+			unsigned p = dist(gen);
+			u.set(p);
+			ref[p] = true;
+		}
+		if (u.null() != (count == 0))
+			++errors;
+		for (unsigned start = 0; start < Bits; ++start) {
+			unsigned expect = start;
+			while (expect < Bits && !ref[expect])
+				++expect;
+			if (u.scan_forward(start) != expect)
+				++errors;
+		}
+	}
+	return errors;
+}
+
+static int bench(const char* name, size_t entries)
+{
+	std::mt19937 gen(42);
+	std::uniform_int_distribution<unsigned> dist(0, kL0 * kL1 - 1);
+
+	std::unique_ptr<Tree> tree(new Tree());
+	for (size_t i = 0; i < entries; ++i)
+		tree->set(dist(gen));
+
+	std::vector<unsigned> queries(kNumLookups);
+	for (auto& q : queries)
+		q = dist(gen);
+
+	int errors = 0;
+	for (size_t i = 0; i < 10000; ++i)
+		if (tree->lower_bound(queries[i]) != tree->naive_lower_bound(queries[i]))
+			++errors;
+
+	unsigned sum = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (unsigned q : queries)
+		sum += tree->lower_bound(q);
+	const auto end = std::chrono::steady_clock::now();
+
+	const auto num_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+	std::cout << name << " (" << entries << " entries): " << static_cast<double>(num_ns) / kNumLookups << "ns per lookup (" << sum << ")" << std::endl;
+	return errors;
+}
+
+int mask_scan(int, char** const)
+{
+	int errors = 0;
+	std::mt19937 gen(42);
+	errors += check_mask<UInt128, 128>(gen);
+	errors += check_mask<UInt256, 256>(gen);
+	errors += check_mask<UInt512, 512>(gen);
+	if (errors)
+		std::cout << errors << " mask scan errors" << std::endl;
+
+	std::cout << "mask scanning: " << (MICRO_SIMD_MASK == 2 ? "AVX2" : (MICRO_SIMD_MASK == 1 ? "SSE4.1" : "portable")) << std::endl;
+	errors += bench("sparse tree", 16);
+	errors += bench("medium tree", 1024);
+	errors += bench("dense tree", kL0 * kL1 / 2);
+	return errors == 0 ? 0 : 1;
+}
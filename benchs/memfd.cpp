@@ -0,0 +1,109 @@
+#include <micro/micro.h>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// Memfd page provider (MicroMemfdProvider): random allocations of all sizes
+// in a growing anonymous file, compared to the OS page provider. The file
+// descriptor is then used to map the pages a second time, and the physical
+// memory of the file must be released once all chunks are freed.
+
+static constexpr size_t kNumOperations = 500000;
+static constexpr size_t kMaxLive = 20000;
+
+static int bench(const char* name, micro_heap* h)
+{
+	std::mt19937 gen(42);
+	std::uniform_int_distribution<size_t> small_distribution(1, 256);
+	std::uniform_int_distribution<size_t> medium_distribution(1024, 64 * 1024);
+	std::uniform_int_distribution<size_t> big_distribution(1024 * 1024, 4 * 1024 * 1024);
+	std::vector<char*> ptrs;
+	int errors = 0;
+
+	const auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < kNumOperations; ++i) {
+		if (ptrs.size() == kMaxLive || (!ptrs.empty() && (gen() & 1))) {
+			size_t k = gen() % ptrs.size();
+			micro_free(ptrs[k]);
+			ptrs[k] = ptrs.back();
+			ptrs.pop_back();
+			continue;
+		}
+		size_t size = (i % 1000 == 0) ? big_distribution(gen) : ((i % 10 == 0) ? medium_distribution(gen) : small_distribution(gen));
+		char* p = static_cast<char*>(micro_heap_malloc(h, size));
+		if (!p) {
+			++errors;
+			break;
+		}
+		p[0] = p[size - 1] = static_cast<char>(size);
+		ptrs.push_back(p);
+	}
+	for (char* p : ptrs)
+		micro_free(p);
+	const auto end = std::chrono::steady_clock::now();
+
+	std::cout << name << ": " << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << "ms" << std::endl;
+	return errors;
+}
+
+int memfd(int, char** const)
+{
+	int errors = 0;
+
+	micro_heap* os = micro_heap_create();
+	errors += bench("OS provider", os);
+	micro_heap_destroy(os);
+
+#ifdef __linux__
+	micro_heap* h = micro_heap_create();
+	micro_heap_set_parameter(h, MicroProviderType, MicroMemfdProvider);
+	micro_heap_set_parameter(h, MicroPageFileFlags, MicroGrowing);
+	micro_heap_set_parameter(h, MicroPageMemorySize, 16u << 20u);
+	micro_heap_set_string_parameter(h, MicroPageFileProvider, "micro_memfd_bench");
+	errors += bench("memfd provider", h);
+
+	int fd = micro_heap_file_descriptor(h);
+	if (fd < 0) {
+		std::cout << "memfd provider not available" << std::endl;
+		micro_heap_destroy(h);
+		return 1;
+	}
+
+	// Released pages are given back by punching holes
+	micro_heap_trim(h, 0);
+	struct stat st = {};
+	if (fstat(fd, &st) != 0)
+		++errors;
+	else {
+		std::cout << "memfd file size: " << st.st_size / 1024 << "KB, physical: " << st.st_blocks * 512 / 1024 << "KB" << std::endl;
+		if (st.st_blocks * 512 > st.st_size / 2)
+			++errors;
+	}
+
+	// Map the file a second time and find a chunk content through this mapping
+	const char pattern[] = "micro memfd double mapping";
+	char* chunk = static_cast<char*>(micro_heap_malloc(h, 100000));
+	memcpy(chunk, pattern, sizeof(pattern));
+	size_t size = static_cast<size_t>(st.st_size);
+	void* view = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+	if (view == MAP_FAILED || !memmem(view, size, pattern, sizeof(pattern)))
+		++errors;
+	if (view != MAP_FAILED)
+		munmap(view, size);
+	micro_free(chunk);
+	micro_heap_destroy(h);
+#endif
+
+	if (errors)
+		std::cout << errors << " memfd provider errors" << std::endl;
+	return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,188 @@
+#include <micro/micro.h>
+#include <micro/micro.hpp>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <chrono>
+#include <random>
+#include <set>
+#include <vector>
+
+// Page run allocation from a fragmented buffer: compare MemoryPageProvider
+// (segregated free lists) to the previous best fit implementation based on
+// two std::set (free runs sorted by size and by address).
+// Allocated runs are checked for overlaps.
+
+static constexpr size_t kPageSize = 4096;
+static constexpr size_t kBufferPages = 65536;
+static constexpr size_t kNumOperations = 1000000;
+
+// Previous implementation, without the locking and the page grow fallback
+class SetPageProvider
+{
+	struct Run
+	{
+		size_t start;
+		size_t count;
+	};
+	struct LessSize
+	{
+		bool operator()(const Run& a, const Run& b) const { return a.count < b.count || (a.count == b.count && a.start < b.start); }
+	};
+	struct LessAddr
+	{
+		bool operator()(const Run& a, const Run& b) const { return a.start < b.start; }
+	};
+	std::set<Run, LessSize> by_size;
+	std::set<Run, LessAddr> by_addr;
+	char* pages;
+
+	void insert(Run r)
+	{
+		by_size.insert(r);
+		by_addr.insert(r);
+	}
+	void erase(Run r)
+	{
+		by_size.erase(r);
+		by_addr.erase(r);
+	}
+
+public:
+	SetPageProvider(char* p, size_t count)
+	  : pages(p)
+	{
+		insert(Run{ 0, count });
+	}
+	void* allocate_pages(size_t count)
+	{
+		auto it = by_size.lower_bound(Run{ 0, count });
+		if (it == by_size.end())
+			return nullptr;
+		Run r = *it;
+		erase(r);
+		if (r.count > count)
+			insert(Run{ r.start + count, r.count - count });
+		return pages + r.start * kPageSize;
+	}
+	void deallocate_pages(void* p, size_t count)
+	{
+		Run r{ static_cast<size_t>(static_cast<char*>(p) - pages) / kPageSize, count };
+		auto next = by_addr.lower_bound(r);
+		if (next != by_addr.end() && next->start == r.start + r.count) {
+			Run n = *next;
+			erase(n);
+			r.count += n.count;
+		}
+		next = by_addr.lower_bound(r);
+		if (next != by_addr.begin()) {
+			Run prev = *std::prev(next);
+			if (prev.start + prev.count == r.start) {
+				erase(prev);
+				r.start = prev.start;
+				r.count += prev.count;
+			}
+		}
+		insert(r);
+	}
+};
+
+struct Alloc
+{
+	char* p;
+	size_t count;
+};
+
+template<class Provider>
+static int bench(const char* name, Provider& provider, char* begin, char* end)
+{
+	std::mt19937 gen(42);
+	std::uniform_int_distribution<size_t> small_count(1, 8);
+	std::uniform_int_distribution<size_t> large_count(9, 256);
+	int errors = 0;
+
+	// Fragment the buffer: fill it, then free every other run
+	std::vector<Alloc> allocs;
+	for (;;) {
+		size_t count = (allocs.size() & 7) ? small_count(gen) : large_count(gen);
+		char* p = static_cast<char*>(provider.allocate_pages(count));
+		if (!p)
+			break;
+		allocs.push_back(Alloc{ p, count });
+	}
+	size_t kept = 0;
+	for (size_t i = 0; i < allocs.size(); ++i) {
+		if (i & 1)
+			provider.deallocate_pages(allocs[i].p, allocs[i].count);
+		else
+			allocs[kept++] = allocs[i];
+	}
+	allocs.resize(kept);
+
+	// Mixed allocations/deallocations on the fragmented buffer
+	size_t failed = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < kNumOperations; ++i) {
+		if (!allocs.empty() && (gen() & 1)) {
+			size_t k = gen() % allocs.size();
+			provider.deallocate_pages(allocs[k].p, allocs[k].count);
+			allocs[k] = allocs.back();
+			allocs.pop_back();
+		}
+		else {
+			size_t count = (i & 7) ? small_count(gen) : large_count(gen);
+			if (char* p = static_cast<char*>(provider.allocate_pages(count)))
+				allocs.push_back(Alloc{ p, count });
+			else
+				++failed;
+		}
+	}
+	const auto stop = std::chrono::steady_clock::now();
+
+	// Check that runs are inside the buffer and do not overlap
+	std::vector<bool> used((end - begin) / kPageSize, false);
+	for (const Alloc& a : allocs) {
+		if (a.p < begin || a.p + a.count * kPageSize > end) {
+			++errors;
+			continue;
+		}
+		size_t first = static_cast<size_t>(a.p - begin) / kPageSize;
+		for (size_t j = first; j < first + a.count; ++j) {
+			if (used[j])
+				++errors;
+			used[j] = true;
+		}
+	}
+	for (const Alloc& a : allocs)
+		provider.deallocate_pages(a.p, a.count);
+
+	const auto num_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+	std::cout << name << ": " << static_cast<double>(num_ns) / kNumOperations << "ns per operation, " << failed << " failed allocations" << std::endl;
+	return errors;
+}
+
+int page_provider(int, char** const)
+{
+	int errors = 0;
+	const size_t bytes = kBufferPages * kPageSize;
+	char* buffer = static_cast<char*>(micro::os_allocate_pages(bytes / micro::os_page_size()));
+	if (!buffer)
+		return 1;
+
+	{
+		SetPageProvider provider(buffer, kBufferPages);
+		errors += bench("std::set best fit", provider, buffer, buffer + bytes);
+	}
+	{
+		micro::parameters params;
+		micro::MemoryPageProvider provider(params, static_cast<unsigned>(kPageSize), false, buffer, bytes);
+		errors += bench("segregated free lists", provider, buffer, buffer + bytes);
+		if (!provider.empty())
+			++errors;
+	}
+
+	micro::os_free_pages(buffer, bytes / micro::os_page_size());
+	if (errors)
+		std::cout << errors << " page provider errors" << std::endl;
+	return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+#include <micro/micro.h>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+// Persistent heap (MicroFileProvider with MicroPersistent flag): build a linked
+// list of small, medium and big nodes, destroy the heap and reopen it from its
+// file. The list is checked after each reopening, and modified in between.
+// Reopening time is compared to the time required to build the list.
+
+static constexpr size_t kNumNodes = 20000;
+static const char* kFileName = "micro_persistent_bench.bin";
+
+struct Node
+{
+	Node* next;
+	std::uint32_t size;
+	std::uint32_t seed;
+};
+
+static micro_heap* open_heap()
+{
+	micro_heap* h = micro_heap_create();
+	micro_heap_set_parameter(h, MicroProviderType, MicroFileProvider);
+	micro_heap_set_parameter(h, MicroPageFileFlags, MicroGrowing | MicroPersistent);
+	micro_heap_set_parameter(h, MicroPageMemorySize, 16u << 20u);
+	micro_heap_set_string_parameter(h, MicroPageFileProvider, kFileName);
+	return h;
+}
+
+static Node* new_node(micro_heap* h, std::mt19937& gen, size_t i, Node* next)
+{
+	std::uniform_int_distribution<std::uint32_t> small_distribution(sizeof(Node) + 1, 256);
+	std::uniform_int_distribution<std::uint32_t> medium_distribution(1024, 64 * 1024);
+	std::uniform_int_distribution<std::uint32_t> big_distribution(1024 * 1024, 4 * 1024 * 1024);
+	std::uint32_t size = (i % 1000 == 0) ? big_distribution(gen) : ((i % 10 == 0) ? medium_distribution(gen) : small_distribution(gen));
+
+	Node* n = static_cast<Node*>(micro_heap_malloc(h, size));
+	if (!n)
+		return nullptr;
+	memset(n, static_cast<char>(i), size);
+	n->next = next;
+	n->size = size;
+	n->seed = static_cast<std::uint32_t>(i);
+	return n;
+}
+
+static size_t check_list(Node* head, size_t* count)
+{
+	size_t errors = 0;
+	*count = 0;
+	for (Node* n = head; n; n = n->next) {
+		const char c = static_cast<char>(n->seed);
+		if (reinterpret_cast<char*>(n)[sizeof(Node)] != c || reinterpret_cast<char*>(n)[n->size - 1] != c)
+			++errors;
+		++*count;
+	}
+	return errors;
+}
+
+int persistent(int, char** const)
+{
+	size_t errors = 0;
+	std::remove(kFileName);
+	std::mt19937 gen(42);
+
+	// Build the list
+	auto start = std::chrono::steady_clock::now();
+	micro_heap* h = open_heap();
+	Node* head = nullptr;
+	for (size_t i = 0; i < kNumNodes; ++i) {
+		Node* n = new_node(h, gen, i, head);
+		if (!n) {
+			micro_heap_destroy(h);
+			std::remove(kFileName);
+			return 1;
+		}
+		head = n;
+	}
+	micro_heap_set_root(h, head);
+	micro_heap_destroy(h);
+	auto end = std::chrono::steady_clock::now();
+	std::cout << "build " << kNumNodes << " nodes: " << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() << "us" << std::endl;
+
+	size_t expected = kNumNodes;
+	for (unsigned round = 0; round < 2; ++round) {
+		// Reopen and retrieve the list
+		start = std::chrono::steady_clock::now();
+		h = open_heap();
+		head = static_cast<Node*>(micro_heap_get_root(h));
+		end = std::chrono::steady_clock::now();
+
+		size_t count = 0;
+		errors += check_list(head, &count);
+		if (count != expected)
+			++errors;
+		std::cout << "reopen " << count << " nodes: " << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() << "us" << std::endl;
+
+		// Free every other node, and add new ones
+		Node* prev = head;
+		while (prev && prev->next) {
+			Node* n = prev->next;
+			prev->next = n->next;
+			micro_free(n);
+			--expected;
+			prev = prev->next;
+		}
+		for (size_t i = 0; i < kNumNodes / 4; ++i) {
+			Node* n = new_node(h, gen, i, head);
+			if (!n) {
+				++errors;
+				break;
+			}
+			head = n;
+			++expected;
+		}
+		micro_heap_set_root(h, head);
+		micro_heap_destroy(h);
+	}
+
+	// Last check, then release everything
+	h = open_heap();
+	size_t count = 0;
+	errors += check_list(static_cast<Node*>(micro_heap_get_root(h)), &count);
+	if (count != expected)
+		++errors;
+	micro_heap_destroy(h);
+	std::remove(kFileName);
+
+	if (errors)
+		std::cout << errors << " persistent heap errors" << std::endl;
+	return errors == 0 ? 0 : 1;
+}
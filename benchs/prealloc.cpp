@@ -0,0 +1,96 @@
+#include <micro/micro.h>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+// Preallocated page provider (MicroOSPreallocProvider) with the different
+// micro_prealloc_flags: time to create the heap, then time and page faults
+// to fill most of the preallocated memory. Populated pages must not fault
+// again on the allocation path.
+
+static constexpr size_t kPreallocSize = 256u << 20u;
+static constexpr size_t kChunkSize = 64u << 10u;
+static constexpr size_t kNumChunks = (192u << 20u) / kChunkSize;
+
+static long minor_faults()
+{
+#ifndef _WIN32
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_minflt;
+#else
+	return 0;
+#endif
+}
+
+static int bench(const char* name, unsigned flags, long* faults)
+{
+	micro_heap* h = micro_heap_create();
+	micro_heap_set_parameter(h, MicroProviderType, MicroOSPreallocProvider);
+	micro_heap_set_parameter(h, MicroPageMemorySize, kPreallocSize);
+	micro_heap_set_parameter(h, MicroAllowOsPageAlloc, 0);
+	micro_heap_set_parameter(h, MicroPreallocFlags, flags);
+
+	// The first allocation creates the heap and preallocates the pages
+	auto start = std::chrono::steady_clock::now();
+	micro_free(micro_heap_malloc(h, 16));
+	auto end = std::chrono::steady_clock::now();
+	const auto create_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+	int errors = 0;
+	std::vector<void*> ptrs(kNumChunks);
+	const long first_faults = minor_faults();
+	start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < kNumChunks; ++i) {
+		ptrs[i] = micro_heap_malloc(h, kChunkSize);
+		if (!ptrs[i]) {
+			++errors;
+			break;
+		}
+		memset(ptrs[i], static_cast<int>(i), kChunkSize);
+	}
+	end = std::chrono::steady_clock::now();
+	*faults = minor_faults() - first_faults;
+	const auto fill_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+	micro_statistics st;
+	memset(&st, 0, sizeof(st));
+	micro_heap_dump_stats(h, &st);
+	std::cout << name << ": creation " << create_us << "us (preallocation " << st.prealloc_time_ns / 1000u << "us), fill " << fill_us << "us, " << *faults
+		  << " page faults" << std::endl;
+
+	for (void* p : ptrs)
+		micro_free(p);
+	micro_heap_destroy(h);
+	return errors;
+}
+
+int prealloc(int, char** const)
+{
+	int errors = 0;
+	long lazy = 0, faults = 0;
+	errors += bench("lazy", MicroPreallocLazy, &lazy);
+
+	errors += bench("populate", MicroPreallocPopulate, &faults);
+	if (faults * 4 > lazy)
+		++errors;
+	errors += bench("parallel populate", MicroPreallocParallel, &faults);
+	if (faults * 4 > lazy)
+		++errors;
+	// Falls back to populate if the pages cannot be locked
+	errors += bench("lock", MicroPreallocLock, &faults);
+	if (faults * 4 > lazy)
+		++errors;
+	errors += bench("huge pages", MicroPreallocHugePages | MicroPreallocPopulate, &faults);
+
+	if (errors)
+		std::cout << errors << " preallocation errors" << std::endl;
+	return errors == 0 ? 0 : 1;
+}
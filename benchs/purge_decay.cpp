@@ -0,0 +1,86 @@
+#include <micro/micro.h>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Bursty medium allocations: each burst allocates then frees several MB,
+// with free page runs trimmed on deallocation or by the purge thread.
+
+static std::atomic<int> errors{ 0 };
+
+static constexpr int kNumBursts = 200;
+static constexpr size_t kBurstSize = 256;
+
+static void burst_thread(micro_heap* h, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<> size_distribution(16 * 1024, 96 * 1024);
+
+    std::vector<char*> ptrs(kBurstSize);
+    for (int i = 0; i < kNumBursts; ++i) {
+        for (size_t j = 0; j < kBurstSize; ++j) {
+            size_t size = static_cast<size_t>(size_distribution(gen));
+            char* p = static_cast<char*>(micro_heap_malloc(h, size));
+            if (!p) {
+                ++errors;
+                return;
+            }
+            p[0] = p[size - 1] = static_cast<char>(j);
+            ptrs[j] = p;
+        }
+        for (size_t j = 0; j < kBurstSize; ++j) {
+            if (ptrs[j][0] != static_cast<char>(j))
+                ++errors;
+            micro_free(ptrs[j]);
+        }
+    }
+}
+
+static int bench(const char* name, unsigned threads, unsigned decay_ms)
+{
+    micro_heap* h = micro_heap_create();
+    micro_heap_set_parameter(h, MicroPurgeDecayMs, decay_ms);
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> ths;
+    for (unsigned i = 0; i < threads; ++i)
+        ths.emplace_back(burst_thread, h, 42 + i);
+    for (auto& t : ths)
+        t.join();
+    const auto end = std::chrono::steady_clock::now();
+    const auto num_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    std::cout << name << ": " << threads << " threads, bursts done in " << num_ms << "ms." << std::endl;
+
+    if (decay_ms) {
+        // Free page runs must be returned within the decay time
+        std::this_thread::sleep_for(std::chrono::milliseconds(decay_ms * 3));
+        micro_statistics st;
+        memset(&st, 0, sizeof(st));
+        micro_heap_dump_stats(h, &st);
+        if (st.purged_bytes == 0)
+            ++errors;
+        std::cout << "purged " << st.purged_bytes << " bytes in " << st.purge_count << " passes, avg. latency "
+                  << (st.purge_count ? st.purge_time_ns / st.purge_count : 0) << "ns, current used memory " << st.current_used_memory << " bytes" << std::endl;
+    }
+    micro_heap_destroy(h);
+    return errors.load() == 0 ? 0 : 1;
+}
+
+int purge_decay(int, char** const)
+{
+    int res = 0;
+#ifdef MICRO_BENCH_MICROMALLOC
+    res |= bench("micro (synchronous trim)", 1, 0);
+    res |= bench("micro (100ms decay)", 1, 100);
+    res |= bench("micro (synchronous trim)", 4, 0);
+    res |= bench("micro (100ms decay)", 4, 100);
+    micro::print_process_infos();
+#endif
+    return res;
+}
@@ -0,0 +1,194 @@
+#include <micro/micro.h>
+#include <micro/testing.hpp>
+#include <iostream>
+
+typedef void* (*CUSTOM_MALLOC_P)(size_t);
+typedef void (*CUSTOM_FREE_P)(void*);
+typedef void* (*CUSTOM_REALLOC_P)(void*, size_t);
+static CUSTOM_MALLOC_P CUSTOM_MALLOC;
+static CUSTOM_FREE_P CUSTOM_FREE;
+static CUSTOM_REALLOC_P CUSTOM_REALLOC;
+
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Growing buffers (string builders like) in the 1KB-256KB range,
+// with occasional shrinks. Buffer content is checked after each realloc.
+
+static std::atomic<int> errors{ 0 };
+
+static void fill(char* p, size_t from, size_t to, char c)
+{
+    memset(p + from, c, to - from);
+}
+static bool check(const char* p, size_t size, char c)
+{
+    // Sparse check of the buffer content
+    for (size_t i = 0; i < size; i += 61)
+        if (p[i] != c)
+            return false;
+    return p[size - 1] == c;
+}
+
+static void realloc_thread(unsigned seed)
+{
+    static constexpr int kNumBuffers = 64;
+    static constexpr size_t kMinBufferSize = 1024;
+    static constexpr size_t kMaxBufferSize = 256 * 1024;
+    static constexpr int kNumIterations = 100000;
+
+    char* buffers[kNumBuffers];
+    size_t sizes[kNumBuffers];
+    for (int i = 0; i < kNumBuffers; ++i) {
+        sizes[i] = kMinBufferSize;
+        buffers[i] = (char*)CUSTOM_MALLOC(kMinBufferSize);
+        fill(buffers[i], 0, kMinBufferSize, (char)i);
+    }
+
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<> buf_number_distribution(0, kNumBuffers - 1);
+    std::uniform_int_distribution<> grow_distribution(16, 4096);
+    std::uniform_int_distribution<> shrink_distribution(0, 15);
+
+    for (int i = 0; i < kNumIterations; ++i) {
+        int idx = buf_number_distribution(gen);
+        size_t new_size = sizes[idx] + grow_distribution(gen);
+        if (new_size > kMaxBufferSize || shrink_distribution(gen) == 0)
+            new_size = kMinBufferSize + (new_size % 4096);
+
+        char* p = (char*)CUSTOM_REALLOC(buffers[idx], new_size);
+        if (!p || !check(p, std::min(sizes[idx], new_size), (char)idx)) {
+            ++errors;
+            return;
+        }
+        if (new_size > sizes[idx])
+            fill(p, sizes[idx], new_size, (char)idx);
+        buffers[idx] = p;
+        sizes[idx] = new_size;
+    }
+
+    for (int i = 0; i < kNumBuffers; ++i)
+        CUSTOM_FREE(buffers[i]);
+}
+
+static void big_realloc_thread()
+{
+    // Grow then shrink a single buffer in the big chunk range (1MB-64MB)
+    static constexpr size_t kMinBufferSize = 1024 * 1024;
+    static constexpr size_t kMaxBufferSize = 64 * 1024 * 1024;
+
+    size_t size = kMinBufferSize;
+    char* p = (char*)CUSTOM_MALLOC(size);
+    fill(p, 0, size, 'b');
+    for (size_t new_size = size + size / 2; new_size <= kMaxBufferSize; new_size += new_size / 2) {
+        char* tmp = (char*)CUSTOM_REALLOC(p, new_size);
+        if (!tmp || !check(tmp, size, 'b')) {
+            ++errors;
+            CUSTOM_FREE(tmp ? tmp : p);
+            return;
+        }
+        fill(tmp, size, new_size, 'b');
+        p = tmp;
+        size = new_size;
+    }
+    for (size_t new_size = size / 3; new_size >= kMinBufferSize; new_size /= 3) {
+        char* tmp = (char*)CUSTOM_REALLOC(p, new_size);
+        if (!tmp || !check(tmp, new_size, 'b')) {
+            ++errors;
+            CUSTOM_FREE(tmp ? tmp : p);
+            return;
+        }
+        p = tmp;
+        size = new_size;
+    }
+    CUSTOM_FREE(p);
+}
+
+static int bench(const char* name, unsigned threads)
+{
+    struct Deleter
+    {
+        const char* name;
+        ~Deleter() {
+            micro::allocator_trim(name);
+        }
+    };
+    Deleter d{ name };
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> ths;
+    for (unsigned i = 0; i < threads; ++i)
+        ths.emplace_back(realloc_thread, 42 + i);
+    ths.emplace_back(big_realloc_thread);
+    for (auto& t : ths)
+        t.join();
+    const auto end = std::chrono::steady_clock::now();
+
+    const auto num_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    std::cout << name << ": " << threads << " threads, growing reallocations done in " << num_ms << "ms." << std::endl;
+    micro::print_process_infos();
+    return errors.load() == 0 ? 0 : 1;
+}
+
+int realloc_growing(int, char** const)
+{
+    int res = 0;
+#ifdef MICRO_BENCH_MICROMALLOC
+    {
+        CUSTOM_MALLOC = micro_malloc;
+        CUSTOM_FREE = micro_free;
+        CUSTOM_REALLOC = micro_realloc;
+        res |= bench("micro", 1);
+        res |= bench("micro", 4);
+    }
+#endif
+
+#ifdef MICRO_BENCH_MALLOC
+    CUSTOM_MALLOC = malloc;
+    CUSTOM_FREE = free;
+    CUSTOM_REALLOC = realloc;
+    res |= bench("malloc", 1);
+    res |= bench("malloc", 4);
+#endif
+
+#ifdef MICRO_BENCH_JEMALLOC
+    CUSTOM_MALLOC = je_malloc;
+    CUSTOM_FREE = je_free;
+    CUSTOM_REALLOC = je_realloc;
+    res |= bench("jemalloc", 1);
+    res |= bench("jemalloc", 4);
+#endif
+
+#ifdef MICRO_BENCH_MIMALLOC
+    CUSTOM_MALLOC = mi_malloc;
+    CUSTOM_FREE = mi_free;
+    CUSTOM_REALLOC = mi_realloc;
+    res |= bench("mimalloc", 1);
+    res |= bench("mimalloc", 4);
+    mi_heap_collect(mi_heap_get_default(), true);
+#endif
+
+#ifdef MICRO_BENCH_SNMALLOC
+    CUSTOM_MALLOC = snmalloc::libc::malloc;
+    CUSTOM_FREE = snmalloc::libc::free;
+    CUSTOM_REALLOC = snmalloc::libc::realloc;
+    res |= bench("snmalloc", 1);
+    res |= bench("snmalloc", 4);
+#endif
+
+#ifdef USE_TBB
+    CUSTOM_MALLOC = scalable_malloc;
+    CUSTOM_FREE = scalable_free;
+    CUSTOM_REALLOC = scalable_realloc;
+    res |= bench("onetbb", 1);
+    res |= bench("onetbb", 4);
+#endif
+
+    return res;
+}
@@ -0,0 +1,113 @@
+#include <micro/micro.h>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Producer/consumer pipeline: producers allocate small objects that are
+// freed by consumer threads, with and without deferred remote frees.
+
+static std::atomic<int> errors{ 0 };
+
+static constexpr size_t kNumObjects = 1000000;
+static constexpr size_t kQueueSize = 1024;
+
+// Single producer single consumer ring buffer
+struct Queue
+{
+    std::atomic<size_t> head{ 0 };
+    std::atomic<size_t> tail{ 0 };
+    void* slots[kQueueSize];
+
+    void push(void* p)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        while (t - head.load(std::memory_order_acquire) == kQueueSize)
+            std::this_thread::yield();
+        slots[t % kQueueSize] = p;
+        tail.store(t + 1, std::memory_order_release);
+    }
+    void* pop()
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        while (tail.load(std::memory_order_acquire) == h)
+            std::this_thread::yield();
+        void* p = slots[h % kQueueSize];
+        head.store(h + 1, std::memory_order_release);
+        return p;
+    }
+};
+
+static void producer(micro_heap* h, Queue* q, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<> size_distribution(16, 256);
+    for (size_t i = 0; i < kNumObjects; ++i) {
+        size_t size = static_cast<size_t>(size_distribution(gen));
+        char* p = static_cast<char*>(micro_heap_malloc(h, size));
+        if (!p) {
+            ++errors;
+            q->push(nullptr);
+            return;
+        }
+        memset(p, static_cast<char>(size), size);
+        q->push(p);
+    }
+}
+
+static void consumer(Queue* q)
+{
+    for (size_t i = 0; i < kNumObjects; ++i) {
+        char* p = static_cast<char*>(q->pop());
+        if (!p)
+            return;
+        // First byte stores the size (modulo 256)
+        size_t size = static_cast<unsigned char>(p[0]);
+        if (size < 16)
+            size += 256;
+        if (p[size - 1] != p[0])
+            ++errors;
+        micro_free(p);
+    }
+}
+
+static int bench(const char* name, unsigned pairs, bool remote_free)
+{
+    micro_heap* h = micro_heap_create();
+    micro_heap_set_parameter(h, MicroRemoteFree, remote_free);
+
+    std::unique_ptr<Queue[]> queues(new Queue[pairs]);
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> ths;
+    for (unsigned i = 0; i < pairs; ++i) {
+        ths.emplace_back(producer, h, &queues[i], 42 + i);
+        ths.emplace_back(consumer, &queues[i]);
+    }
+    for (auto& t : ths)
+        t.join();
+    const auto end = std::chrono::steady_clock::now();
+
+    const auto num_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    std::cout << name << ": " << pairs << " producer/consumer pairs done in " << num_ms << "ms." << std::endl;
+    micro_heap_destroy(h);
+    return errors.load() == 0 ? 0 : 1;
+}
+
+int remote_free(int, char** const)
+{
+    int res = 0;
+#ifdef MICRO_BENCH_MICROMALLOC
+    res |= bench("micro (locked free)", 1, false);
+    res |= bench("micro (remote free)", 1, true);
+    res |= bench("micro (locked free)", 2, false);
+    res |= bench("micro (remote free)", 2, true);
+    micro::print_process_infos();
+#endif
+    return res;
+}
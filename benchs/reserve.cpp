@@ -0,0 +1,93 @@
+#include <micro/micro.h>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// Heap using a reserved address range (MicroOSReserveProvider) compared to
+// the default OS page provider: allocation/deallocation time, number of
+// memory mappings (Linux only) and heap destruction time.
+
+static constexpr size_t kNumObjects = 20000;
+
+static size_t count_mappings()
+{
+	size_t count = 0;
+#ifdef __linux__
+	if (FILE* f = fopen("/proc/self/maps", "r")) {
+		int c;
+		while ((c = fgetc(f)) != EOF)
+			count += c == '\n';
+		fclose(f);
+	}
+#endif
+	return count;
+}
+
+static int bench(const char* name, unsigned provider)
+{
+	int errors = 0;
+	micro_heap* h = micro_heap_create();
+	micro_heap_set_parameter(h, MicroProviderType, provider);
+
+	std::mt19937 gen(42);
+	std::uniform_int_distribution<size_t> medium_distribution(1024, 64 * 1024);
+	std::uniform_int_distribution<size_t> big_distribution(1024 * 1024, 4 * 1024 * 1024);
+
+	const size_t maps_before = count_mappings();
+	const auto start = std::chrono::steady_clock::now();
+
+	std::vector<char*> ptrs(kNumObjects);
+	std::vector<size_t> sizes(kNumObjects);
+	for (size_t i = 0; i < kNumObjects; ++i) {
+		size_t size = (i % 100) ? medium_distribution(gen) : big_distribution(gen);
+		char* p = static_cast<char*>(micro_heap_malloc(h, size));
+		if (!p)
+			return 1;
+		memset(p, static_cast<char>(i), size);
+		ptrs[i] = p;
+		sizes[i] = size;
+	}
+	const size_t maps_peak = count_mappings();
+
+	// Free every other chunk, and allocate again
+	for (size_t i = 0; i < kNumObjects; i += 2)
+		micro_free(ptrs[i]);
+	for (size_t i = 0; i < kNumObjects; i += 2) {
+		ptrs[i] = static_cast<char*>(micro_heap_malloc(h, sizes[i]));
+		if (!ptrs[i])
+			return 1;
+		memset(ptrs[i], static_cast<char>(i), sizes[i]);
+	}
+	for (size_t i = 0; i < kNumObjects; ++i)
+		if (ptrs[i][0] != static_cast<char>(i) || ptrs[i][sizes[i] - 1] != static_cast<char>(i))
+			++errors;
+	const auto mid = std::chrono::steady_clock::now();
+
+	micro_heap_destroy(h);
+	const auto end = std::chrono::steady_clock::now();
+
+	const auto alloc_us = std::chrono::duration_cast<std::chrono::microseconds>(mid - start).count();
+	const auto destroy_us = std::chrono::duration_cast<std::chrono::microseconds>(end - mid).count();
+	std::cout << name << ": alloc/free " << alloc_us << "us, destroy " << destroy_us << "us";
+	if (maps_before)
+		std::cout << ", " << (maps_peak - maps_before) << " new mappings";
+	std::cout << std::endl;
+	return errors;
+}
+
+int reserve(int, char** const)
+{
+	int errors = 0;
+#ifdef MICRO_BENCH_MICROMALLOC
+	errors += bench("micro (os provider)", MicroOSProvider);
+	errors += bench("micro (reserve provider)", MicroOSReserveProvider);
+	if (errors)
+		std::cout << errors << " reserve errors" << std::endl;
+#endif
+	return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,148 @@
+#include <micro/micro.h>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// Heap shared between processes (micro_heap_create_shared()): forked workers
+// allocate chunks of all sizes and publish them in a table stored in the heap.
+// Chunks are freed by whichever process replaces them, usually not their
+// allocating one. A last process detaches the inherited heap, attaches it
+// again by filename and releases all remaining chunks.
+
+static constexpr unsigned kNumWorkers = 4;
+static constexpr size_t kNumSlots = 4096;
+static constexpr size_t kNumOperations = 200000;
+static const char* kFileName = "micro_shared_heap_bench.bin";
+
+struct Table
+{
+	std::atomic<void*> slots[kNumSlots];
+};
+
+static void* new_chunk(micro_heap* h, std::mt19937& gen)
+{
+	std::uniform_int_distribution<size_t> small_distribution(sizeof(size_t) + 1, 256);
+	std::uniform_int_distribution<size_t> medium_distribution(1024, 64 * 1024);
+	std::uniform_int_distribution<size_t> big_distribution(512 * 1024, 1024 * 1024);
+	unsigned kind = gen() % 1000;
+	size_t size = kind == 0 ? big_distribution(gen) : (kind < 100 ? medium_distribution(gen) : small_distribution(gen));
+
+	char* p = static_cast<char*>(micro_heap_malloc(h, size));
+	if (!p)
+		return nullptr;
+	memset(p, static_cast<char>(size), size);
+	memcpy(p, &size, sizeof(size));
+	return p;
+}
+
+static int free_chunk(void* chunk)
+{
+	if (!chunk)
+		return 0;
+	char* p = static_cast<char*>(chunk);
+	size_t size;
+	memcpy(&size, p, sizeof(size));
+	int res = p[size - 1] == static_cast<char>(size) ? 0 : 1;
+	micro_free(p);
+	return res;
+}
+
+#ifndef _WIN32
+
+static int worker(micro_heap* h, Table* table, unsigned seed)
+{
+	std::mt19937 gen(seed);
+	int errors = 0;
+	for (size_t i = 0; i < kNumOperations; ++i) {
+		// Replace a random slot, or just empty it
+		void* p = (gen() & 3) ? new_chunk(h, gen) : nullptr;
+		errors += free_chunk(table->slots[gen() % kNumSlots].exchange(p));
+	}
+	return errors;
+}
+
+static int wait_child(pid_t pid)
+{
+	int status = 0;
+	if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status))
+		return 1;
+	return WEXITSTATUS(status);
+}
+
+int shared_heap(int, char** const)
+{
+	std::remove(kFileName);
+	micro_heap* h = micro_heap_create_shared(kFileName, 256u << 20u);
+	if (!h)
+		return 1;
+	Table* table = static_cast<Table*>(micro_heap_malloc(h, sizeof(Table)));
+	if (!table) {
+		micro_heap_destroy(h);
+		std::remove(kFileName);
+		return 1;
+	}
+	memset(static_cast<void*>(table), 0, sizeof(Table));
+	micro_heap_set_root(h, table);
+
+	int errors = 0;
+	const auto start = std::chrono::steady_clock::now();
+	pid_t pids[kNumWorkers];
+	for (unsigned i = 0; i < kNumWorkers; ++i) {
+		pids[i] = fork();
+		if (pids[i] == 0)
+			_exit(worker(h, table, i) == 0 ? 0 : 1);
+	}
+	for (unsigned i = 0; i < kNumWorkers; ++i)
+		errors += pids[i] > 0 ? wait_child(pids[i]) : 1;
+	const auto end = std::chrono::steady_clock::now();
+	const auto num_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+	std::cout << kNumWorkers << " processes, " << kNumWorkers * kNumOperations << " operations in " << num_ms << "ms" << std::endl;
+
+	// Detach the inherited heap, attach it again and release all chunks
+	pid_t pid = fork();
+	if (pid == 0) {
+		micro_heap_destroy(h);
+		micro_heap* attached = micro_heap_attach(kFileName);
+		if (!attached || attached != h)
+			_exit(1);
+		Table* t = static_cast<Table*>(micro_heap_get_root(attached));
+		int res = t == table ? 0 : 1;
+		for (size_t i = 0; i < kNumSlots && res == 0; ++i)
+			res += free_chunk(t->slots[i].exchange(nullptr));
+		micro_heap_destroy(attached);
+		_exit(res == 0 ? 0 : 1);
+	}
+	errors += pid > 0 ? wait_child(pid) : 1;
+
+	// All chunks were freed by the last process
+	for (size_t i = 0; i < kNumSlots; ++i)
+		if (table->slots[i].load() != nullptr)
+			++errors;
+	micro_free(table);
+
+	micro_heap_destroy(h);
+	std::remove(kFileName);
+	if (errors)
+		std::cout << errors << " shared heap errors" << std::endl;
+	return errors == 0 ? 0 : 1;
+}
+
+#else
+
+int shared_heap(int, char** const)
+{
+	// Requires fork()
+	return 0;
+}
+
+#endif
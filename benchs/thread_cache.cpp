@@ -0,0 +1,95 @@
+#include <micro/micro.h>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Small objects (16-256 bytes) allocated and freed by several threads
+// from the same heap, with and without per-thread magazines.
+
+static std::atomic<int> errors{ 0 };
+
+static constexpr int kNumIterations = 2000000;
+static constexpr size_t kNumSlots = 1024;
+static constexpr uint64_t kCacheBytes = 4 * 1024 * 1024;
+
+static void small_thread(micro_heap* h, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<> slot_distribution(0, kNumSlots - 1);
+    std::uniform_int_distribution<> size_distribution(16, 256);
+
+    std::vector<char*> slots(kNumSlots, nullptr);
+    std::vector<size_t> sizes(kNumSlots, 0);
+    for (int i = 0; i < kNumIterations; ++i) {
+        size_t idx = static_cast<size_t>(slot_distribution(gen));
+        if (slots[idx]) {
+            if (slots[idx][0] != static_cast<char>(idx) || slots[idx][sizes[idx] - 1] != static_cast<char>(idx)) {
+                ++errors;
+                return;
+            }
+            micro_free(slots[idx]);
+            slots[idx] = nullptr;
+        }
+        else {
+            size_t size = static_cast<size_t>(size_distribution(gen));
+            char* p = static_cast<char*>(micro_heap_malloc(h, size));
+            if (!p) {
+                ++errors;
+                return;
+            }
+            p[0] = p[size - 1] = static_cast<char>(idx);
+            slots[idx] = p;
+            sizes[idx] = size;
+        }
+    }
+    for (char* p : slots)
+        micro_free(p);
+}
+
+static int bench(const char* name, unsigned threads, uint64_t cache_bytes)
+{
+    micro_heap* h = micro_heap_create();
+    micro_heap_set_parameter(h, MicroThreadCacheBytes, cache_bytes);
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> ths;
+    for (unsigned i = 0; i < threads; ++i)
+        ths.emplace_back(small_thread, h, 42 + i);
+    for (auto& t : ths)
+        t.join();
+    const auto end = std::chrono::steady_clock::now();
+
+    // All magazines must have been flushed on thread exit
+    micro_statistics st;
+    memset(&st, 0, sizeof(st));
+    micro_heap_dump_stats(h, &st);
+    if (st.thread_cache_bytes != 0)
+        ++errors;
+
+    const auto num_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    std::cout << name << ": " << threads << " threads, small allocations done in " << num_ms << "ms." << std::endl;
+    micro_heap_destroy(h);
+    return errors.load() == 0 ? 0 : 1;
+}
+
+int thread_cache(int, char** const)
+{
+    int res = 0;
+#ifdef MICRO_BENCH_MICROMALLOC
+    res |= bench("micro (no cache)", 1, 0);
+    res |= bench("micro (thread cache)", 1, kCacheBytes);
+    res |= bench("micro (no cache)", 4, 0);
+    res |= bench("micro (thread cache)", 4, kCacheBytes);
+
+    // Tiny budget: most deallocations bypass the cache
+    res |= bench("micro (4KB thread cache)", 4, 4096);
+    micro::print_process_infos();
+#endif
+    return res;
+}
@@ -0,0 +1,78 @@
+#include <micro/micro.h>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// Load spike followed by a mostly empty heap: a few scattered chunks
+// keep their page runs alive, and micro_heap_trim() gives back the rest.
+
+static std::atomic<int> errors{ 0 };
+
+static constexpr size_t kNumObjects = 200000;
+static constexpr size_t kKeepEvery = 64;
+
+static int bench(const char* name, uint64_t cache_bytes, uint64_t decommit_threshold)
+{
+    micro_heap* h = micro_heap_create();
+    micro_heap_set_parameter(h, MicroThreadCacheBytes, cache_bytes);
+    micro_heap_set_parameter(h, MicroDecommitThreshold, decommit_threshold);
+
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<> small_distribution(16, 256);
+    std::uniform_int_distribution<> medium_distribution(1024, 64 * 1024);
+
+    std::vector<char*> ptrs(kNumObjects);
+    std::vector<size_t> sizes(kNumObjects);
+    for (size_t i = 0; i < kNumObjects; ++i) {
+        size_t size = static_cast<size_t>((i & 7) ? small_distribution(gen) : medium_distribution(gen));
+        char* p = static_cast<char*>(micro_heap_malloc(h, size));
+        if (!p) {
+            ++errors;
+            return 1;
+        }
+        memset(p, static_cast<char>(i), size);
+        ptrs[i] = p;
+        sizes[i] = size;
+    }
+    for (size_t i = 0; i < kNumObjects; ++i)
+        if (i % kKeepEvery) {
+            micro_free(ptrs[i]);
+            ptrs[i] = nullptr;
+        }
+
+    const auto start = std::chrono::steady_clock::now();
+    const size_t released = micro_heap_trim(h, 0);
+    const auto end = std::chrono::steady_clock::now();
+    if (released == 0)
+        ++errors;
+
+    // Remaining chunks must be left untouched
+    for (size_t i = 0; i < kNumObjects; ++i)
+        if (ptrs[i]) {
+            if (ptrs[i][0] != static_cast<char>(i) || ptrs[i][sizes[i] - 1] != static_cast<char>(i))
+                ++errors;
+            micro_free(ptrs[i]);
+        }
+
+    const auto num_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    std::cout << name << ": released " << released << " bytes in " << num_us << "us." << std::endl;
+    micro_heap_destroy(h);
+    return errors.load() == 0 ? 0 : 1;
+}
+
+int trim(int, char** const)
+{
+    int res = 0;
+#ifdef MICRO_BENCH_MICROMALLOC
+    res |= bench("micro", 0, 0);
+    res |= bench("micro (thread cache)", 1024 * 1024, 0);
+    res |= bench("micro (decommit threshold)", 0, 64 * 1024);
+    micro::print_process_infos();
+#endif
+    return res;
+}
@@ -87,15 +87,16 @@ typedef enum micro_parameter
 	MicroPageSize,
 	/// @brief Memory provider address, default to null
 	MicroPageMemoryProvider,
-	/// @brief Memory provider size, or file provider start size, or preallocated provider size, default to 0
+	/// @brief Memory provider size, or file/memfd provider start size, or preallocated provider size,
+	/// or reserved address range size (0 meaning MICRO_DEFAULT_RESERVE_SIZE), default to 0
 	MicroPageMemorySize,
 
-	/// @brief For MicroOSPreallocProvider, MicroMemProvider and MicroFileProvider,
+	/// @brief For MicroOSPreallocProvider, MicroOSReserveProvider, MicroMemProvider and MicroFileProvider,
 	/// Allow the use of OS page alloc/dealloc API when the page provider cannot allocate pages anymore.
 	/// Default to true.
 	MicroAllowOsPageAlloc,
 
-	/// @brief Grow factor for file page provider with the flag MicroGrowing.
+	/// @brief Grow factor for file and memfd page providers with the flag MicroGrowing.
 	/// This value is expressed in 1/10 and is added to 1 to get the final grow factor.
 	/// For instance, a value of 6 means a grow factor of 1.6
 	/// Default to 1.6
@@ -106,7 +107,8 @@ typedef enum micro_parameter
 	/// If not null, it must point to a valid directory. In such case, the MicroPageFileProvider
 	/// is interpreted as a file prefix.
 	MicroPageFileDirProvider,
-	/// @brief Flags for the file page provider, combination of MicroStaticSize, MicroGrowing and MicroRemoveOnClose.
+	/// @brief Flags for the file page provider, combination of MicroStaticSize, MicroGrowing and MicroPersistent.
+	/// The memfd page provider only uses MicroGrowing.
 	/// Default to MicroStaticSize.
 	MicroPageFileFlags,
 
@@ -122,7 +124,35 @@ typedef enum micro_parameter
 	/// @brief If MicroOnTime is set, print stats every MicroPrintStatsMs value.
 	MicroPrintStatsMs,
 	/// @brief If MicroOnBytes is set, print stats every MicroPrintStatsBytes allocations.
-	MicroPrintStatsBytes
+	MicroPrintStatsBytes,
+
+	/// @brief Maximum bytes cached by all per-thread magazines in front of the small object pools.
+	/// Trade memory for lock-free small allocations. Default to 0 (disabled).
+	MicroThreadCacheBytes,
+	/// @brief Select the arena based on the current CPU (restartable sequences or sched_getcpu()) instead of the thread id.
+	/// Default to 0.
+	MicroArenaPerCpu,
+	/// @brief Group arenas per NUMA node and bind their page runs to this node (Linux only).
+	/// Default to 0.
+	MicroNuma,
+	/// @brief Defer small object deallocations from threads using another arena than the owner one.
+	/// Default to 0.
+	MicroRemoteFree,
+	/// @brief Decay time in milliseconds of free page runs, gradually returned by a background thread.
+	/// Default to 0 (free page runs trimmed on deallocation).
+	MicroPurgeDecayMs,
+	/// @brief For MicroOSProvider, strategy used to give back released page runs to the OS.
+	/// See micro_decommit_type enum, default to MicroDecommitDontNeed.
+	MicroDecommit,
+	/// @brief Minimum size in bytes of the pages decommitted inside free medium chunks.
+	/// Default to 0 (disabled).
+	MicroDecommitThreshold,
+	/// @brief For MicroOSPreallocProvider, how the preallocated pages are committed,
+	/// combination of micro_prealloc_flags. Default to MicroPreallocLazy.
+	MicroPreallocFlags,
+	/// @brief For MicroOSProvider, huge pages backing page runs of whole huge pages, see micro_huge_pages_type enum.
+	/// Default to MicroHugePagesTransparent for memory level 4, MicroHugePagesNone otherwise.
+	MicroHugePages
 
 } micro_parameter;
 
@@ -137,9 +167,38 @@ typedef enum micro_provider_type
 	MicroMemProvider,
 	/// @brief Use a memory mapped file to carve pages from
 	MicroFileProvider,
+	/// @brief Reserve a large address range up front, and commit pages inside it on demand
+	MicroOSReserveProvider,
+	/// @brief Use an anonymous memory file (Linux memfd_create) to carve pages from
+	MicroMemfdProvider,
 
 } micro_provider_type;
 
+/// @brief Decommit strategy of the OS page provider.
+/// To be used with micro_set_parameter(MicroDecommit).
+typedef enum micro_decommit_type
+{
+	/// @brief Released page runs are decommitted (MADV_DONTNEED or MEM_DECOMMIT), big ones are unmapped
+	MicroDecommitDontNeed = 0,
+	/// @brief Released page runs are lazily decommitted (MADV_FREE or MEM_RESET) and kept for reuse
+	MicroDecommitFree = 1,
+	/// @brief Released page runs stay committed and are kept for reuse
+	MicroDecommitNone = 2
+} micro_decommit_type;
+
+/// @brief Huge pages used by the OS page provider.
+/// To be used with micro_set_parameter(MicroHugePages).
+typedef enum micro_huge_pages_type
+{
+	/// @brief Page runs use the default OS pages
+	MicroHugePagesNone = 0,
+	/// @brief Page runs of whole huge pages are aligned on the huge page size and backed by transparent huge pages (MADV_HUGEPAGE, Linux only)
+	MicroHugePagesTransparent = 1,
+	/// @brief Page runs of whole huge pages use explicit huge pages (MAP_HUGETLB or MEM_LARGE_PAGES),
+	/// or transparent huge pages if none is available
+	MicroHugePagesExplicit = 2
+} micro_huge_pages_type;
+
 /// @brief File flags used by the internal file page provider.
 /// To be used with micro_set_parameter(MicroPageFileFlags).
 typedef enum micro_file_flags
@@ -148,8 +207,27 @@ typedef enum micro_file_flags
 	MicroStaticSize = 0,
 	/// @brief Allow the file to grow on page demand
 	MicroGrowing = 1,
+	/// @brief Keep the heap content in the file when the heap is destroyed,
+	/// and restore it when a heap opens the same file again (see micro_heap_get_root()).
+	MicroPersistent = 2,
 } micro_file_flags;
 
+/// @brief Preallocation flags of the MicroOSPreallocProvider.
+/// To be used with micro_set_parameter(MicroPreallocFlags).
+typedef enum micro_prealloc_flags
+{
+	/// @brief Preallocated pages are faulted in on first access
+	MicroPreallocLazy = 0,
+	/// @brief Fault in all preallocated pages on heap creation
+	MicroPreallocPopulate = 1,
+	/// @brief Fault in preallocated pages using several threads (implies MicroPreallocPopulate)
+	MicroPreallocParallel = 2,
+	/// @brief Lock preallocated pages in physical memory (mlock or VirtualLock)
+	MicroPreallocLock = 4,
+	/// @brief Back preallocated pages with explicit huge pages if available, transparent huge pages otherwise
+	MicroPreallocHugePages = 8
+} micro_prealloc_flags;
+
 /// @brief Statistics printing trigger.
 /// To be used with micro_set_parameter(MicroPrintStatsTrigger).
 typedef enum micro_print_stats_trigger
@@ -199,6 +277,12 @@ typedef struct micro_statistics
 	micro_type_statistics small;
 	micro_type_statistics medium;
 	micro_type_statistics big;
+	uint64_t thread_cache_bytes; // bytes currently held by thread caches (cached objects and reserved budget)
+	uint64_t numa_cross_node_allocs; // NUMA mode: allocations served by an arena or a page run of another node
+	uint64_t purged_bytes;		 // bytes returned to the page provider by the background purge thread
+	uint64_t purge_count;		 // number of purge passes that returned pages
+	uint64_t purge_time_ns;		 // total time spent by the purge thread returning pages
+	uint64_t prealloc_time_ns;	 // time spent preallocating pages on heap creation (MicroOSPreallocProvider)
 } micro_statistics;
 
 /// @brief Process information retrieved with micro_get_process_infos()
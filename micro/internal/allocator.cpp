@@ -23,10 +23,13 @@
  */
 
 #include <atomic>
+#include <chrono>
 #include <cinttypes>
 #include <cstdlib>
+#include <cstring>
 #include <functional>
 #include <map>
+#include <thread>
 
 #include "../logger.hpp"
 #include "../os_page.hpp"
@@ -70,9 +73,11 @@ namespace micro
 		{
 			// Allocate a RadixLeaf using the internal memory pool
 			RadixLeaf* l = nullptr;
-			RadixLeaf* tmp = static_cast<RadixLeaf*>(arena->manager()->allocate_and_forget(sizeof(RadixLeaf)));
-			if (MICRO_UNLIKELY(!tmp))
+			// The memory pool only guarantees a 8 bytes alignment
+			void* p = arena->manager()->allocate_and_forget(sizeof(RadixLeaf) + alignof(RadixLeaf) - 1u);
+			if (MICRO_UNLIKELY(!p))
 				return nullptr;
+			RadixLeaf* tmp = RadixLeaf::align(p);
 			new (tmp) RadixLeaf;
 			tmp->parent_index = pos;
 			if (MICRO_LIKELY(data[pos].compare_exchange_strong(l, tmp)))
@@ -100,7 +105,7 @@ namespace micro
 			// Add a new MediumChunkHeader to the radix tree from
 			// a newly allocated PageRunHeader
 
-			PageRunHeader* block = this->arena->manager()->allocate_medium_block();
+			PageRunHeader* block = this->arena->manager()->allocate_medium_block(this->arena->numa_node);
 			if (MICRO_UNLIKELY(!block))
 				return false;
 
@@ -112,6 +117,7 @@ namespace micro
 			h->th.offset_bytes = sizeof(PageRunHeader) >> MICRO_ELEM_SHIFT;
 			h->th.status = MICRO_ALLOC_FREE;
 			h->offset_prev = 0;
+			h->set_decommitted(false);
 
 			// Set other_arenas_count to 0 (non empty) if it was to UINT_MAX (empty and unused)
 			Arena* a = static_cast<Arena*>(arena);
@@ -124,6 +130,85 @@ namespace micro
 			return true;
 		}
 
+		MICRO_EXPORT_CLASS_MEMBER std::uint64_t RadixTree::decommit_threshold() noexcept { return arena->manager()->params().decommit_threshold; }
+
+		MICRO_EXPORT_CLASS_MEMBER void RadixTree::decommit_interior(MediumChunkHeader* f, const char* begin, const char* end, bool partial, bool forced) noexcept
+		{
+			// Pages are recommitted by the OS on their next access,
+			// either by a chunk carved from f or by a new chunk header.
+			// The decommit tag is exact whatever the threshold: a chunk merged with a decommitted
+			// one is fully decommitted, so that trimming never counts the same pages twice.
+			const std::uint64_t threshold = decommit_threshold();
+
+			// Keep the page(s) holding the header, the links and the decommit tag
+			const uintptr_t psize = arena->manager()->page_size();
+			uintptr_t first = ((f + 3)->address() + psize - 1u) & ~(psize - 1u);
+			uintptr_t last = (f->address() + f->block_bytes()) & ~(psize - 1u);
+			if (last <= first || (!forced && (!threshold || last - first < threshold))) {
+				f->set_decommitted(false);
+				return;
+			}
+			if (partial) {
+				// The merged neighbors were already decommitted, except around their headers
+				uintptr_t b = reinterpret_cast<uintptr_t>(begin) & ~(psize - 1u);
+				uintptr_t e = (reinterpret_cast<uintptr_t>(end) + 3u * sizeof(MediumChunkHeader) + psize - 1u) & ~(psize - 1u);
+				first = b > first ? b : first;
+				last = e < last ? e : last;
+			}
+			bool res = true;
+			if (last > first)
+				res = arena->manager()->page_provider()->decommit_pages(reinterpret_cast<void*>(first), (last - first) / psize);
+			f->set_decommitted(res);
+		}
+
+		MICRO_EXPORT_CLASS_MEMBER std::uint64_t RadixTree::decommit_free_chunks() noexcept
+		{
+			// Walk all free chunks, holding their radix leaf position lock.
+			// Chunks that cannot be locked are being merged or allocated, just skip them.
+			const uintptr_t psize = arena->manager()->page_size();
+			std::uint64_t bytes = 0;
+
+			for (unsigned i0 = 0; i0 < l0_size; ++i0) {
+				RadixLeaf* ch = data[i0].load(std::memory_order_acquire);
+				if (!ch)
+					continue;
+				for (unsigned i1 = 0; i1 < RadixAccess::l1_size; ++i1) {
+					i1 = ch->mask.scan_forward(i1);
+					if (i1 == RadixAccess::l1_size)
+						break;
+					// Chunks smaller than 2 pages cannot hold a whole page after their header
+					if ((static_cast<uintptr_t>(RadixAccess::elems(Match{ static_cast<std::uint16_t>(i0), static_cast<std::uint16_t>(i1) })) << MICRO_ELEM_SHIFT) < 2u * psize)
+						continue;
+
+					std::lock_guard<lock_type> ll(ch->lock(i1));
+					for (MediumChunkHeader* f = ch->data[i1]; f; f = f->next()) {
+						if (f->decommitted())
+							continue;
+#if MICRO_USE_NODE_LOCK
+						if (!f->get_lock()->try_lock_fast())
+							continue;
+#else
+						PageRunHeader* parent = f->parent();
+						if (!parent->lock.try_lock())
+							continue;
+#endif
+						uintptr_t first = ((f + 3)->address() + psize - 1u) & ~(psize - 1u);
+						uintptr_t last = (f->address() + f->block_bytes()) & ~(psize - 1u);
+						if (last > first && arena->manager()->page_provider()->decommit_pages(reinterpret_cast<void*>(first), (last - first) / psize)) {
+							bytes += last - first;
+							f->set_decommitted(true);
+						}
+#if MICRO_USE_NODE_LOCK
+						f->get_lock()->unlock();
+#else
+						parent->lock.unlock();
+#endif
+					}
+				}
+			}
+			return bytes;
+		}
+
 		MICRO_EXPORT_CLASS_MEMBER MediumChunkHeader* RadixTree::align_header(MediumChunkHeader* h, unsigned align, PageRunHeader* parent) noexcept
 		{
 			uintptr_t addr = (h + 1)->address();
@@ -153,6 +238,7 @@ namespace micro
 						return nullptr;
 				}
 
+				const bool decommitted = h->decommitted();
 				MediumChunkHeader* new_free = h;
 				new_free->elems = new_free_elems;
 				new_free->th.status = MICRO_ALLOC_FREE;
@@ -160,6 +246,7 @@ namespace micro
 				// update h
 				h = new (new_h) MediumChunkHeader(
 				  new_free->elems + 1, h_elems - (new_free->elems + 1), MICRO_ALLOC_FREE, static_cast<unsigned>((new_h->as_char() - parent->as_char()) >> MICRO_ELEM_SHIFT));
+				h->set_decommitted(decommitted);
 
 #if MICRO_USE_NODE_LOCK
 				// lock h before updating next offset
@@ -204,8 +291,11 @@ namespace micro
 			if (MICRO_UNLIKELY(!ch))
 				return nullptr;
 
+			const bool decommitted = h->decommitted();
 			new_free = h + elems_1;
 			new (new_free) MediumChunkHeader(elems_1, h->elems - elems_1, MICRO_ALLOC_FREE, static_cast<unsigned>((new_free->as_char() - parent->as_char()) >> MICRO_ELEM_SHIFT));
+			// The tail interior stays decommitted
+			new_free->set_decommitted(decommitted);
 
 			// update h size
 			h->set_elems(elems_1 - 1u);
@@ -258,7 +348,7 @@ namespace micro
 				ch->mask.unset(m.index1);
 
 			// No need to hold the leaf lock anymore
-			ch->locks[m.index1].unlock();
+			ch->lock(m.index1).unlock();
 
 			// Keep around the found free chunk
 			MediumChunkHeader* h_saved = h;
@@ -329,7 +419,7 @@ namespace micro
 				if (data_p != aligned)
 					aligned += MICRO_ALIGNED_POOL;
 				if (aligned + reduced * 16 > data_p + ch->data[m.index1]->elems * 16) {
-					ch->locks[m.index1].unlock();
+					ch->lock(m.index1).unlock();
 					return nullptr;
 				}
 				return ch;
@@ -372,11 +462,11 @@ namespace micro
 			if (m.index1 == RadixAccess::l1_size)
 				return nullptr;
 			// Try to lock the leaf spinlock
-			if (MICRO_UNLIKELY(!first->locks[m.index1].try_lock()))
+			if (MICRO_UNLIKELY(!first->lock(m.index1).try_lock()))
 				return nullptr;
 			// Ensure the found chunk is still valid
 			if (MICRO_UNLIKELY(!first->data[m.index1])) {
-				first->locks[m.index1].unlock();
+				first->lock(m.index1).unlock();
 				return nullptr;
 			}
 			parent = first->data[m.index1]->parent();
@@ -387,13 +477,13 @@ namespace micro
 			const bool valid_end = n->as_char() < parent->end();
 			// Try to lock the chunks
 			if (MICRO_UNLIKELY(!lockForAlloc(parent, h, n, valid_end))) {
-				first->locks[m.index1].unlock();
+				first->lock(m.index1).unlock();
 				return nullptr;
 			}
 #else
 			// Try to lock the page run header
 			if (MICRO_UNLIKELY(!parent->lock.try_lock_shared())) {
-				first->locks[m.index1].unlock();
+				first->lock(m.index1).unlock();
 				return nullptr;
 			}
 #endif
@@ -438,11 +528,11 @@ namespace micro
 					m.from_uint(l);
 					if (RadixAccess::elems(m) >= search_for) {
 						ch = data[m.index0].load(std::memory_order_relaxed);
-						ch->locks[m.index1].lock();
+						ch->lock(m.index1).lock();
 						if (ch->data[m.index1])
 							// We found (and locked) a free chunk: directly go to the allocation step
 							goto found;
-						ch->locks[m.index1].unlock();
+						ch->lock(m.index1).unlock();
 					}
 				}
 			}
@@ -499,83 +589,11 @@ namespace micro
 				}
 #endif
 
-				ch->locks[m.index1].unlock();
+				ch->lock(m.index1).unlock();
 			}
 			MICRO_UNREACHABLE();
 		}
 
-		// Shrink block.
-		// We should use it at some point.
-
-		/*MICRO_EXPORT_CLASS_MEMBER void RadixTree::shrink(MediumChunkHeader* h, unsigned new_elems) noexcept
-		{
-			MICRO_ASSERT_DEBUG(h->th.guard == MICRO_BLOCK_GUARD, "");
-			MICRO_ASSERT_DEBUG(h->th.status == MICRO_ALLOC_MEDIUM, "");
-
-			if (h->elems < new_elems || new_elems == h->elems)
-				return;
-			if (new_elems == 0)
-				return;
-
-			PageRunHeader* parent = h->parent();
-			MediumChunkHeader* end = (MediumChunkHeader*)parent->end();
-
-			using lock_type = PageRunHeader::shared_lock_type;
-			std::lock_guard<lock_type> ll(parent->lock);
-
-			MediumChunkHeader* _new = h + 1 + new_elems;
-			unsigned remaining = h->elems - new_elems;
-			unsigned offset_run = (unsigned)(_new - (MediumChunkHeader*)parent);
-
-			MediumChunkHeader* next = h + h->elems + 1;
-
-			if (next >= end || next->th.status == MICRO_ALLOC_MEDIUM) {
-				// This is the last block, or next block is used: create a new free block after, if possible
-
-				if (remaining < 2)
-					return; // No room to create a new free block
-
-				new (_new) MediumChunkHeader(1 + new_elems, remaining - 1, MICRO_ALLOC_FREE, offset_run);
-				h->elems = new_elems;
-
-				if (next < end) {
-					// Update offset of next block
-					next->offset_prev = remaining;
-					MICRO_ASSERT_DEBUG(check_prev_next(next), "");
-				}
-				MICRO_ASSERT_DEBUG(check_prev_next(h), "");
-				MICRO_ASSERT_DEBUG(check_prev_next(_new), "");
-			}
-			else
-			{
-
-				MICRO_ASSERT_DEBUG(next->th.guard == MICRO_BLOCK_GUARD, "");
-				MICRO_ASSERT_DEBUG(next->th.status == MICRO_ALLOC_FREE, "");
-				// There is a free block after: resize it
-
-				// First, remove next from free list
-				remove_from_list(next);
-
-				MediumChunkHeader *next_next = next + next->elems + 1;
-				new (_new) MediumChunkHeader(1 + new_elems, next->elems + remaining, MICRO_ALLOC_FREE, offset_run);
-				h->elems = new_elems;
-				if (next_next < end) {
-					// Update offset of next block
-					next_next->offset_prev = (unsigned)(next_next - _new);
-					MICRO_ASSERT_DEBUG(check_prev_next(next_next), "");
-				}
-				MICRO_ASSERT_DEBUG(check_prev_next(h), "");
-				MICRO_ASSERT_DEBUG(check_prev_next(_new), "");
-
-				// Reset next header to reduce false positives in MemoryManager::type_of();
-				memset((void*)next, 0, sizeof(MediumChunkHeader));
-			}
-
-			// Insert new free chunk
-			Match m;
-			insert_free(_new, m);
-		}*/
-
 #define MICRO_CONTINUE_YIELD                                                                                                                                                                           \
 	{                                                                                                                                                                                              \
 		std::this_thread::yield();                                                                                                                                                             \
@@ -651,9 +669,16 @@ namespace micro
 			p = f->offset_prev ? f - f->offset_prev : nullptr;
 #endif
 
+			// Freed range, and decommit state of merged neighbors
+			const char* freed_begin = f->as_char();
+			const char* freed_end = n ? n->as_char() : parent->end();
+			bool neighbors_decommitted = true;
+			bool merged_decommitted = false;
+
 			if (p && p->th.status == MICRO_ALLOC_FREE) {
 				// Merge with previous
 				MICRO_ASSERT_DEBUG(p != f, "");
+				neighbors_decommitted = merged_decommitted = p->decommitted();
 				f = merge_previous(p, f, n, end);
 #if MICRO_USE_NODE_LOCK
 				// Remove p from the list of chunks to unlock
@@ -662,6 +687,8 @@ namespace micro
 			}
 			if (lock_next && n->th.status == MICRO_ALLOC_FREE) {
 				// Merge with next
+				neighbors_decommitted = neighbors_decommitted && n->decommitted();
+				merged_decommitted = merged_decommitted || n->decommitted();
 				merge_next(p, f, n, end);
 #if MICRO_USE_NODE_LOCK
 				// Remove n from the list of chunks to unlock
@@ -686,6 +713,10 @@ namespace micro
 			else {
 				f->th.status = MICRO_ALLOC_FREE;
 
+				// Release the whole pages of the new free chunk if big enough.
+				// Must be done before insertion as the chunk cannot be carved meanwhile.
+				decommit_interior(f, freed_begin, freed_end, neighbors_decommitted, merged_decommitted);
+
 #if MICRO_USE_NODE_LOCK
 				// With MICRO_USE_NODE_LOCK, we can at least release locks of left/right chunks
 				// before inserting the new free chunk
@@ -719,6 +750,149 @@ namespace micro
 			return bytes;
 		}
 
+		MICRO_EXPORT_CLASS_MEMBER bool RadixTree::resize(void* ptr, unsigned new_elems) noexcept
+		{
+			// Grow or shrink a chunk in place.
+			// Growing absorbs (part of) the next chunk if free,
+			// shrinking releases the chunk tail as a new free chunk
+			// (merged with the next one if free).
+
+			// Get the chunk header
+			MediumChunkHeader* f = MediumChunkHeader::from(ptr) - 1;
+
+			// Ensure it is valid
+			MICRO_ASSERT_DEBUG(f->th.guard == MICRO_BLOCK_GUARD, "");
+			MICRO_ASSERT_DEBUG(f->th.status == MICRO_ALLOC_MEDIUM, "");
+
+			const unsigned elems = f->elems;
+			if (new_elems == elems)
+				return true;
+
+			// Get parent page run, next chunk, and end of page run
+			PageRunHeader* parent = f->parent();
+			MediumChunkHeader* n = f + elems + 1;
+			MediumChunkHeader* end = MediumChunkHeader::from(parent->end());
+			if (n == end)
+				n = nullptr;
+
+			// Cannot grow without a free next chunk
+			if (new_elems > elems && (!n || n->th.status != MICRO_ALLOC_FREE))
+				return false;
+
+#if MICRO_USE_NODE_LOCK
+			// Lock chunk and next one (whatever its status) as we
+			// might modify its offset to previous.
+			for (;;) {
+				if (!f->get_lock()->try_lock_fast())
+					MICRO_CONTINUE_YIELD
+				if (n && MICRO_UNLIKELY(!n->get_lock()->try_lock_fast())) {
+					f->get_lock()->unlock();
+					MICRO_CONTINUE_YIELD
+				}
+				break;
+			}
+#else
+			// Just lock the parent page run
+			parent->lock.lock();
+#endif
+
+			// Check again the next chunk status now that we hold the locks
+			const bool next_free = n && n->th.status == MICRO_ALLOC_FREE;
+
+			// New free chunk, if any
+			MediumChunkHeader* t = nullptr;
+			RadixLeaf* ch = nullptr;
+			Match m;
+			bool res = false;
+			bool merged = false; // next chunk merged
+
+			if (new_elems > elems) {
+				unsigned total = next_free ? elems + 1u + n->elems : 0;
+				if (total > new_elems + 1u) {
+					// Carve the requested size out of next free chunk,
+					// and keep its tail as a new free chunk.
+					unsigned free_elems = total - new_elems - 1u;
+					// Ensure the radix leaf is available
+					if ((ch = get_free(free_elems, m))) {
+						MediumChunkHeader* nn = n + n->elems + 1;
+						const bool decommitted = n->decommitted();
+						if (MICRO_LIKELY(n->elems != 0))
+							remove_from_list(n);
+						t = f + new_elems + 1;
+						new (t) MediumChunkHeader(new_elems + 1u, free_elems, MICRO_ALLOC_FREE, static_cast<unsigned>((t->as_char() - parent->as_char()) >> MICRO_ELEM_SHIFT));
+						t->set_decommitted(decommitted);
+#if MICRO_USE_NODE_LOCK
+						// Lock the new free chunk until it is inserted in the tree
+						t->get_lock()->lock();
+#endif
+						f->set_elems(new_elems);
+						if (nn < end)
+							nn->offset_prev = static_cast<unsigned>(nn - t);
+						res = true;
+					}
+				}
+				else if (total >= new_elems) {
+					// Absorb the full next free chunk
+					merge_next(nullptr, f, n, end);
+					res = true;
+				}
+				merged = res;
+				MICRO_RESET_MEM(static_cast<char*>(ptr) + (elems << MICRO_ELEM_SHIFT), (f->elems - elems) << MICRO_ELEM_SHIFT);
+			}
+			else {
+				// Shrink: the released tail must at least hold a header and one element,
+				// except if it can be merged with the next free chunk.
+				unsigned free_elems = next_free ? elems - new_elems + n->elems : (elems - new_elems > 1u ? elems - new_elems - 1u : 0);
+				if (free_elems && (ch = get_free(free_elems, m))) {
+					MediumChunkHeader* nn = next_free ? n + n->elems + 1 : n;
+					const bool decommitted = !next_free || n->decommitted();
+					if (next_free && MICRO_LIKELY(n->elems != 0))
+						remove_from_list(n);
+					t = f + new_elems + 1;
+					new (t) MediumChunkHeader(new_elems + 1u, free_elems, MICRO_ALLOC_FREE, static_cast<unsigned>((t->as_char() - parent->as_char()) >> MICRO_ELEM_SHIFT));
+					// Release the whole pages of the released tail
+					decommit_interior(t, t->as_char(), n ? n->as_char() : parent->end(), decommitted, next_free && decommitted);
+#if MICRO_USE_NODE_LOCK
+					t->get_lock()->lock();
+#endif
+					f->set_elems(new_elems);
+					if (nn && nn < end)
+						nn->offset_prev = static_cast<unsigned>(nn - t);
+					merged = next_free;
+				}
+				// Shrinking always succeeds, even if the chunk size is unchanged
+				res = true;
+			}
+
+#if MICRO_USE_NODE_LOCK
+			// Release the next chunk lock, unless it was merged
+			if (n && !merged)
+				n->get_lock()->unlock();
+#else
+			(void)merged;
+#endif
+
+			if (t) {
+				// Add new free chunk to the radix tree
+#if MICRO_USE_NODE_LOCK == 0
+				MICRO_ASSERT_DEBUG(check_prev_next(f), "");
+				MICRO_ASSERT_DEBUG(check_prev_next(t), "");
+#endif
+				insert_free(t, ch, m);
+#if MICRO_USE_NODE_LOCK
+				t->get_lock()->unlock();
+#endif
+			}
+
+			// Unlock all
+#if MICRO_USE_NODE_LOCK
+			f->get_lock()->unlock();
+#else
+			parent->lock.unlock();
+#endif
+			return res;
+		}
+
 #undef MICRO_CONTINUE_YIELD
 
 		/// @brief Incrememnt counter on construction, decrement on destruction
@@ -736,19 +910,48 @@ namespace micro
 		MICRO_EXPORT_CLASS_MEMBER bool MemoryManager::initialize_arenas() noexcept
 		{
 			std::lock_guard<lock_type> ll(lock);
+			// Reopened persistent heap: reuse the arenas stored in the page provider
+			if (!arenas && !restore_state())
+				return false;
 			if (!arenas) {
 				// Initialize global memory pool that will be used to perform following allocations
 				new (&radix_pool) MemPool(this);
 
 				// Allocate arenas
-				size_t arenas_bytes = (sizeof(ArenaProxy) * params().max_arenas + sizeof(PageRunHeader));
+				size_t arenas_bytes = (sizeof(ArenaProxy) * params().max_arenas + sizeof(PageRunHeader) + alignof(ArenaProxy));
 				void* a = allocate_and_forget(static_cast<unsigned>(arenas_bytes));
 				if (!a)
 					return false;
-				// Initialize arenas
-				ArenaProxy* _arenas = static_cast<ArenaProxy*>(a);
+				// Initialize arenas, aligned for the padded TinyMemPool size classes
+				ArenaProxy* _arenas = reinterpret_cast<ArenaProxy*>((reinterpret_cast<uintptr_t>(a) + alignof(ArenaProxy) - 1u) & ~static_cast<uintptr_t>(alignof(ArenaProxy) - 1u));
+
+				// NUMA mode: split arenas among nodes, with a power of 2 arenas per node
+				numa_nodes = 1;
+				if (params().numa) {
+					numa_nodes = os_numa_node_count();
+					if (numa_nodes > MICRO_MAX_NUMA_NODES)
+						numa_nodes = MICRO_MAX_NUMA_NODES;
+					if (numa_nodes > params().max_arenas)
+						numa_nodes = params().max_arenas;
+				}
+				unsigned per_node = params().max_arenas / numa_nodes;
+				per_node = 1u << bit_scan_reverse_32(per_node);
+				numa_arena_mask = per_node - 1u;
+
 				for (unsigned i = 0; i < params().max_arenas; ++i)
-					new (_arenas[i].arena()) Arena(this);
+					new (_arenas[i].arena()) Arena(this, i / per_node < numa_nodes ? i / per_node : 0u);
+
+#ifndef MICRO_NO_LOCK
+				// Allocate thread caches
+				if (params().thread_cache_bytes) {
+					size_t caches_bytes = sizeof(ThreadCache*) * ThreadCounter::max_threads;
+					void* c = allocate_and_forget(static_cast<unsigned>(caches_bytes));
+					if (!c)
+						return false;
+					memset(c, 0, caches_bytes);
+					thread_caches = static_cast<ThreadCache**>(c);
+				}
+#endif
 
 				// Initialize arenas at the end to avoid other threads to go further
 				arenas = _arenas;
@@ -756,6 +959,140 @@ namespace micro
 			return true;
 		}
 
+		MICRO_EXPORT_CLASS_MEMBER void MemoryManager::persistent_layout(std::uint32_t* layout) const noexcept
+		{
+			layout[0] = static_cast<std::uint32_t>(sizeof(PersistentState));
+			layout[1] = static_cast<std::uint32_t>(sizeof(PageRunHeader));
+			layout[2] = static_cast<std::uint32_t>(sizeof(Arena));
+			layout[3] = os_psize;
+			layout[4] = params().max_arenas;
+			layout[5] = params().numa ? 1u : 0u;
+			layout[6] = MICRO_MAX_NUMA_NODES;
+#ifndef MICRO_NO_LOCK
+			layout[7] = params().thread_cache_bytes ? ThreadCounter::max_threads : 0u;
+#else
+			layout[7] = 0;
+#endif
+		}
+
+		MICRO_EXPORT_CLASS_MEMBER void MemoryManager::save_state() noexcept
+		{
+			static_assert(sizeof(PersistentState) <= MICRO_PERSISTENT_AREA_SIZE, "persistent area too small");
+			PersistentState* st = static_cast<PersistentState*>(page_provider()->persistent_area());
+			if (!st || !arenas)
+				return;
+
+#ifndef MICRO_NO_LOCK
+			// Cached objects would be lost: give them back to their blocks
+			if (thread_caches)
+				for (unsigned id = 0; id < ThreadCounter::max_threads; ++id)
+					flush_thread_cache(id);
+#endif
+
+			std::lock_guard<lock_type> ll(lock);
+			st->magic = 0;
+			persistent_layout(st->layout);
+			st->manager = this;
+
+			// Sentinels belong to this manager: only store the list ends
+			st->first = end.right != &end ? end.right : nullptr;
+			st->last = end.left != &end ? end.left : nullptr;
+			for (unsigned i = 0; i < MICRO_MAX_NUMA_NODES; ++i) {
+				st->first_free[i] = end_free[i].right_free != &end_free[i] ? end_free[i].right_free : nullptr;
+				st->last_free[i] = end_free[i].left_free != &end_free[i] ? end_free[i].left_free : nullptr;
+			}
+
+			st->arenas = arenas;
+			st->pool_last = radix_pool.as_mem_pool()->last_block();
+#ifndef MICRO_NO_LOCK
+			st->thread_caches = thread_caches;
+#else
+			st->thread_caches = nullptr;
+#endif
+			st->numa_nodes = numa_nodes;
+			st->numa_arena_mask = numa_arena_mask;
+			st->used_pages = used_pages.load();
+			st->used_spans = used_spans.load();
+			st->free_page_count = free_page_count.load();
+			st->max_pages = max_pages.load();
+			st->side_pages = side_pages.load();
+			st->root = root_ptr.load();
+
+			// The page map is process wide: remember which runs must be inserted back
+			for (PageRunHeader* p = end.right; p != &end; p = p->right)
+				p->indexed = pmap().find(p) == this ? 1 : 0;
+
+			// Written last, an interrupted save leaves an invalid state
+			st->magic = MICRO_PERSISTENT_MAGIC;
+		}
+
+		MICRO_EXPORT_CLASS_MEMBER bool MemoryManager::restore_state() noexcept
+		{
+			// Lock must be held
+			PersistentState* st = static_cast<PersistentState*>(page_provider()->persistent_area());
+			if (!st || st->magic != MICRO_PERSISTENT_MAGIC)
+				return true;
+
+			std::uint32_t layout[8];
+			persistent_layout(layout);
+			if (memcmp(layout, st->layout, sizeof(layout)) != 0) {
+				if (params().log_level >= MicroWarning)
+					print_stderr(MicroWarning, params().log_date_format.data(), "persistent heap saved with incompatible parameters\n");
+				return false;
+			}
+
+			// Link page runs to this manager sentinels
+			MemoryManager* old = st->manager;
+			if (st->first) {
+				end.right = st->first;
+				end.left = st->last;
+				st->first->left = st->last->right = &end;
+			}
+			for (unsigned i = 0; i < MICRO_MAX_NUMA_NODES; ++i) {
+				if (st->first_free[i]) {
+					end_free[i].right_free = st->first_free[i];
+					end_free[i].left_free = st->last_free[i];
+					st->first_free[i]->left_free = st->last_free[i]->right_free = &end_free[i];
+				}
+			}
+
+			// Attach page runs to this manager, and rebuild the page map
+			for (PageRunHeader* p = end.right; p != &end; p = p->right) {
+				if (p->arena == old)
+					p->arena = this;
+				if (p->indexed && !pmap().insert(p, this)) {
+					if (params().log_level >= MicroWarning)
+						print_stderr(MicroWarning, params().log_date_format.data(), "unable to restore persistent heap page map\n");
+					return false;
+				}
+				p->indexed = 0;
+			}
+
+			new (&radix_pool) MemPool(this, st->pool_last);
+			for (unsigned i = 0; i < params().max_arenas; ++i)
+				st->arenas[i].arena()->relocate(this);
+
+#ifndef MICRO_NO_LOCK
+			thread_caches = static_cast<ThreadCache**>(st->thread_caches);
+			thread_cache_reserved = 0;
+			if (thread_caches)
+				ThreadCounter::set_exit_callback(on_thread_exit);
+#endif
+			numa_nodes = st->numa_nodes;
+			numa_arena_mask = st->numa_arena_mask;
+			used_pages = st->used_pages;
+			used_spans = st->used_spans;
+			free_page_count = st->free_page_count;
+			max_pages = st->max_pages;
+			side_pages = st->side_pages;
+			root_ptr.store(st->root);
+
+			// The state now belongs to this manager until it is saved again
+			st->magic = 0;
+			arenas = st->arenas;
+			return true;
+		}
+
 		MICRO_EXPORT_CLASS_MEMBER unsigned MemoryManager::compute_max_medium_pages() const noexcept
 		{
 			// Maximum number of pages for the radix tree
@@ -782,12 +1119,15 @@ namespace micro
 			// Allocate big object
 
 			size_t requested = bytes + sizeof(PageRunHeader) + sizeof(BigChunkHeader) + (align > 16 ? align : 0);
+			// Use whole huge pages if the page provider backs them with huge pages
+			if (os_huge_psize && requested >= os_huge_psize)
+				requested = (requested + os_huge_psize - 1u) / os_huge_psize * os_huge_psize;
 			auto* block = allocate_pages_for_bytes(requested);
 			if (MICRO_UNLIKELY(!block))
 				return nullptr;
 
 			// Insert new pages into the page map
-			if (!page_map.insert(block, true)) {
+			if (!pmap_insert(block)) {
 				deallocate_pages(block);
 				return nullptr;
 			}
@@ -906,13 +1246,13 @@ namespace micro
 		  , os_psize(static_cast<unsigned>(page_provider()->page_size()))
 		  , os_psize_bits(static_cast<unsigned>(page_provider()->page_size_bits()))
 		  , os_alloc_granularity(static_cast<unsigned>(page_provider()->allocation_granularity()))
+		  , os_huge_psize(static_cast<unsigned>(page_provider()->huge_page_size()))
 		  , os_max_medium_pages(compute_max_medium_pages())
 		  , os_max_medium_size(compute_max_medium_size())
-		  , page_map(this)
 		{
 			end.left = end.right = &end;
-			end_free.left_free = end_free.right_free = &end_free;
-			get_main_manager() = this;
+			for (unsigned i = 0; i < MICRO_MAX_NUMA_NODES; ++i)
+				end_free[i].left_free = end_free[i].right_free = &end_free[i];
 			el_timer.tick();
 		}
 
@@ -936,6 +1276,17 @@ namespace micro
 			// print statistics on exit
 			perform_exit_operations();
 
+			if (shared)
+				unregister_shared(this);
+
+#ifndef MICRO_NO_LOCK
+			// Wait for the purge thread to leave this manager
+			{
+				std::lock_guard<shared_spinlock> ll(end_lock());
+				purge_stopped = true;
+			}
+#endif
+
 			// Do NOT free pages if this is the main manager
 #ifdef MICRO_OVERRIDE
 			if (get_main_manager() != this)
@@ -945,6 +1296,14 @@ namespace micro
 				// clear pages
 				if (page_provider()->own_pages())
 					clear();
+				else {
+					// Persistent heap: save the state required to reopen it
+					save_state();
+					// Pages are kept alive, but must not be attributed to this manager anymore
+					std::lock_guard<lock_type> ll(lock);
+					for (PageRunHeader* p = end.right; p != &end; p = p->right)
+						pmap_erase(p);
+				}
 			}
 #ifdef MICRO_OVERRIDE
 			if (get_main_manager() == this) {
@@ -972,22 +1331,78 @@ namespace micro
 				while (next != &end) {
 					PageRunHeader* p = next;
 					next = next->right;
+					pmap_erase(p);
 					p->~PageRunHeader();
-					page_provider()->deallocate_pages(p, static_cast<size_t>((p->run_size() >> os_psize_bits)));
+					// Page runs released at once by the provider reset() are skipped
+					if (!page_provider()->released_on_reset(p))
+						page_provider()->deallocate_pages(p, static_cast<size_t>((p->run_size() >> os_psize_bits)));
 				}
 
 				page_provider()->reset();
-				page_map.reset();
 				// Since all pages were deallocated, the radix tree and memory pools are fully invalidated
 				// They will be recreated in the next call to allocate()
 
 				end.left = end.right = &end;
-				end_free.left_free = end_free.right_free = &end_free;
+				for (unsigned i = 0; i < MICRO_MAX_NUMA_NODES; ++i)
+					end_free[i].left_free = end_free[i].right_free = &end_free[i];
+#ifndef MICRO_NO_LOCK
+				thread_caches = nullptr;
+				thread_cache_reserved = 0;
+				memset(purge_epoch_pages, 0, sizeof(purge_epoch_pages));
+#endif
 				arenas = nullptr;
+				root_ptr = nullptr;
 			}
 		}
 
-		MICRO_EXPORT_CLASS_MEMBER PageRunHeader* MemoryManager::allocate_pages(size_t page_count) noexcept
+		MICRO_EXPORT_CLASS_MEMBER void MemoryManager::set_root(void* p) noexcept
+		{
+			initialize_arenas();
+			root_ptr.store(p);
+		}
+
+		MICRO_EXPORT_CLASS_MEMBER void* MemoryManager::root() noexcept
+		{
+			initialize_arenas();
+			return root_ptr.load();
+		}
+
+		MICRO_EXPORT_CLASS_MEMBER std::uint64_t MemoryManager::trim(size_t pad) noexcept
+		{
+			{
+				std::lock_guard<lock_type> ll(lock);
+				if (!arenas)
+					return 0;
+			}
+
+#ifndef MICRO_NO_LOCK
+			// Objects cached by the current thread keep their blocks alive.
+			// Magazines of other threads cannot be touched.
+			unsigned id = static_cast<unsigned>(this_thread_id());
+			if (id < ThreadCounter::max_threads)
+				flush_thread_cache(id);
+#endif
+
+			// Give back empty tiny blocks first, as they might be merged with free chunks
+			for (unsigned i = 0; i < params().max_arenas; ++i)
+				get_arenas()[i].tiny_pool()->release_empty_blocks();
+
+			std::uint64_t bytes = 0;
+			for (unsigned i = 0; i < params().max_arenas; ++i)
+				bytes += get_arenas()[i].tree()->decommit_free_chunks();
+
+			// Release free page runs, including the ones just freed by the tiny pools
+			PageRunHeader* to_free = nullptr;
+			{
+				std::lock_guard<lock_type> ll(lock);
+				to_free = unlink_free_pages(pad);
+			}
+			return bytes + release_pages(to_free);
+		}
+
+		MICRO_EXPORT_CLASS_MEMBER PageRunHeader* MemoryManager::allocate_pages(size_t page_count) noexcept { return allocate_pages_on_node(page_count, select_numa_node()); }
+
+		MICRO_EXPORT_CLASS_MEMBER PageRunHeader* MemoryManager::allocate_pages_on_node(size_t page_count, unsigned numa_node) noexcept
 		{
 			size_t size_bytes = page_count << os_psize_bits;
 
@@ -1001,17 +1416,30 @@ namespace micro
 			bool allocated = false;
 			{
 				std::unique_lock<lock_type> ll(lock);
-				// Try to reuse free page run
-				if (page_count == max_medium_pages() && end_free.right_free != &end_free) {
-					res = end_free.right_free;
+				// Try to reuse free page run from the same NUMA node
+				if (page_count == max_medium_pages() && end_free[numa_node].right_free != &end_free[numa_node]) {
+					res = end_free[numa_node].right_free;
 					res->remove_free();
 					free_page_count -= max_medium_pages();
 				}
 				else {
 					// We are going to allocate pages, make sure it won't go over the limit
 					size_t current_pages = used_pages.load(std::memory_order_relaxed) + free_page_count;
-					if (MICRO_UNLIKELY(params().memory_limit && params().memory_limit < (current_pages + page_count) * os_psize))
-						return nullptr;
+					if (MICRO_UNLIKELY(params().memory_limit && params().memory_limit < (current_pages + page_count) * os_psize)) {
+						// Last chance: reuse a free page run from another NUMA node
+						if (page_count != max_medium_pages())
+							return nullptr;
+						for (unsigned i = 0; i < numa_nodes && !res; ++i) {
+							if (end_free[i].right_free != &end_free[i]) {
+								res = end_free[i].right_free;
+								res->remove_free();
+								free_page_count -= max_medium_pages();
+								++numa_cross_node_allocs;
+							}
+						}
+						if (!res)
+							return nullptr;
+					}
 				}
 			}
 			if (!res) {
@@ -1019,8 +1447,12 @@ namespace micro
 				res = PageRunHeader::from(page_provider()->allocate_pages(page_count));
 				if (MICRO_UNLIKELY(!res))
 					return nullptr;
+				// Bind pages before the first touch
+				if (params().numa)
+					page_provider()->bind_pages(res, page_count, numa_node);
 				new (res) PageRunHeader();
 				res->size_bytes = size_bytes;
+				res->numa_node = static_cast<std::uint16_t>(numa_node);
 				allocated = true;
 			}
 
@@ -1039,25 +1471,24 @@ namespace micro
 			return res;
 		}
 
-		MICRO_EXPORT_CLASS_MEMBER void MemoryManager::deallocate_pages(PageRunHeader* p) noexcept
+		MICRO_EXPORT_CLASS_MEMBER std::uint64_t MemoryManager::backend_limit() const noexcept
 		{
-			size_t page_count = static_cast<size_t>(p->size_bytes >> os_psize_bits);
-
-			std::uint64_t limit = 0;
-			if (params().backend_memory) {
-				if (params().backend_memory <= 100)
-					limit = (used_pages.load() * params().backend_memory / 100) << os_psize_bits;
-				else
-					limit = params().backend_memory;
-			}
+			// Returns the free page bytes to keep based on backend_memory
+			if (!params().backend_memory)
+				return 0;
+			if (params().backend_memory <= 100)
+				return (used_pages.load() * params().backend_memory / 100) << os_psize_bits;
+			return params().backend_memory;
+		}
 
+		MICRO_EXPORT_CLASS_MEMBER PageRunHeader* MemoryManager::unlink_free_pages(std::uint64_t limit) noexcept
+		{
+			// Remove the oldest free page runs until we reach limit bytes.
+			// Lock must be held, returns the list of page runs to deallocate.
 			PageRunHeader* to_free = nullptr;
-			{
-				std::unique_lock<lock_type> ll(lock);
-
-				// Deallocate free pages until we reach the target backend memory (if any)
-				PageRunHeader* r = end_free.right_free;
-				while (r != &end_free && (free_page_count << os_psize_bits) > limit) {
+			for (unsigned i = 0; i < numa_nodes; ++i) {
+				PageRunHeader* r = end_free[i].right_free;
+				while (r != &end_free[i] && (free_page_count << os_psize_bits) > limit) {
 					PageRunHeader* next = r->right_free;
 					r->remove();
 					r->remove_free();
@@ -1066,11 +1497,51 @@ namespace micro
 					r = next;
 					free_page_count -= max_medium_pages();
 				}
+			}
+			return to_free;
+		}
+
+		MICRO_EXPORT_CLASS_MEMBER std::uint64_t MemoryManager::release_pages(PageRunHeader* to_free) noexcept
+		{
+			// Actual page deallocation.
+			// No need to hold the manager lock.
+			std::uint64_t bytes = 0;
+			while (to_free) {
+				auto* next = to_free->right_free;
+				bytes += to_free->run_size();
+				page_provider()->deallocate_pages(to_free, to_free->run_size() >> os_psize_bits);
+				to_free = next;
+			}
+			return bytes;
+		}
+
+		MICRO_EXPORT_CLASS_MEMBER void MemoryManager::deallocate_pages(PageRunHeader* p) noexcept
+		{
+			size_t page_count = static_cast<size_t>(p->size_bytes >> os_psize_bits);
+			std::uint64_t limit = backend_limit();
+
+#ifndef MICRO_NO_LOCK
+			const bool decay = params().purge_decay_ms != 0;
+#else
+			const bool decay = false;
+#endif
+
+			PageRunHeader* to_free = nullptr;
+			{
+				std::unique_lock<lock_type> ll(lock);
+
+				// Deallocate free pages until we reach the target backend memory (if any).
+				// With a decay time, this is the job of the purge thread.
+				if (!decay)
+					to_free = unlink_free_pages(limit);
 
 				if (p->run_size() == (max_medium_pages() << os_psize_bits)) {
-					// Insert pages to deallocate to the free list (we always have at least one free page run)
-					p->insert_free(&end_free);
+					// Insert pages to deallocate to the free list of their NUMA node (we always have at least one free page run)
+					p->insert_free(&end_free[p->numa_node < numa_nodes ? p->numa_node : 0u]);
 					free_page_count += max_medium_pages();
+#ifndef MICRO_NO_LOCK
+					purge_epoch_pages[purge_epoch] += max_medium_pages();
+#endif
 
 #ifdef MICRO_DEBUG
 					// Ensure the page is free of chunks
@@ -1089,23 +1560,21 @@ namespace micro
 				--used_spans;
 
 				// Remove page run from the page map
-				page_map.erase(p);
+				pmap_erase(p);
 			}
 
-			// Actual page deallocation.
-			// No need to hold the manager lock.
-			while (to_free) {
-				auto* next = to_free->right_free;
-				page_provider()->deallocate_pages(to_free, to_free->run_size() >> os_psize_bits);
-				to_free = next;
-			}
+			release_pages(to_free);
+#ifndef MICRO_NO_LOCK
+			if (decay)
+				start_purge_thread();
+#endif
 		}
 
-		MICRO_EXPORT_CLASS_MEMBER PageRunHeader* MemoryManager::allocate_medium_block() noexcept
+		MICRO_EXPORT_CLASS_MEMBER PageRunHeader* MemoryManager::allocate_medium_block(unsigned numa_node) noexcept
 		{
 			// Allocate page run suitable for the radix tree
-			PageRunHeader* run = allocate_pages(max_medium_pages());
-			if (run && !page_map.insert(run, false)) {
+			PageRunHeader* run = allocate_pages_on_node(max_medium_pages(), numa_node);
+			if (run && !pmap_insert(run)) {
 				deallocate_pages(run);
 				return nullptr;
 			}
@@ -1158,11 +1627,14 @@ namespace micro
 			if (!params().deplete_arenas || params().max_arenas == 1)
 				return nullptr;
 
-			unsigned count = std::min(get_max_thread_count(), params().max_arenas);
+			unsigned count = params().arena_per_cpu || params().numa ? params().max_arenas : std::min(get_max_thread_count(), params().max_arenas);
 			unsigned inspect_count = count / MICRO_DEPLETE_ARENA_FACTOR;
 			if (inspect_count == 0)
 				inspect_count = 1;
 			unsigned start = random_uint32() % count;
+			if (params().numa)
+				// Start with the arenas of the same NUMA node
+				start = first->numa_node * (numa_arena_mask + 1u) + (start & numa_arena_mask);
 			bool is_small = bytes <= params().small_alloc_threshold && align <= MICRO_MINIMUM_ALIGNMENT;
 			for (unsigned i = 0; i < inspect_count; ++i, ++start) {
 				if (start >= count)
@@ -1172,6 +1644,8 @@ namespace micro
 					continue;
 				if (is_small) {
 					if (void* r = a->tiny_pool()->allocate(static_cast<unsigned>(bytes), false)) {
+						if (a->numa_node != first->numa_node)
+							++numa_cross_node_allocs;
 						return r;
 					}
 				}
@@ -1180,6 +1654,8 @@ namespace micro
 						continue;
 					if (void* r = a->tree()->allocate_elems(elems, align, false)) {
 						MICRO_ASSERT_DEBUG(!r || align == 0 || (reinterpret_cast<uintptr_t>(r) % align) == 0, "");
+						if (a->numa_node != first->numa_node)
+							++numa_cross_node_allocs;
 						return r;
 					}
 				}
@@ -1198,8 +1674,11 @@ namespace micro
 						start = 0;
 					auto* a = arenas[start].arena();
 					if (a != first)
-						if (void* r = a->tree()->allocate_small_fast(elems))
+						if (void* r = a->tree()->allocate_small_fast(elems)) {
+							if (a->numa_node != first->numa_node)
+								++numa_cross_node_allocs;
 							return r;
+						}
 				}
 			}
 			return nullptr;
@@ -1317,8 +1796,12 @@ namespace micro
 #endif
 
 			if (bytes <= params().small_alloc_threshold && align <= MICRO_MINIMUM_ALIGNMENT) {
-				// Allocate from the tiny memory pool for small objects
-				res = arena->tiny_pool()->allocate(static_cast<unsigned>(bytes), true);
+				// Allocate from the thread cache or the tiny memory pool for small objects
+#ifndef MICRO_NO_LOCK
+				res = thread_caches ? thread_cache_allocate(static_cast<unsigned>(bytes)) : nullptr;
+				if (!res)
+#endif
+					res = arena->tiny_pool()->allocate(static_cast<unsigned>(bytes), true);
 			}
 			else {
 				unsigned elems = RadixTree::bytes_to_elems(static_cast<unsigned>(bytes));
@@ -1350,6 +1833,50 @@ namespace micro
 			return res;
 		}
 
+		MICRO_EXPORT_CLASS_MEMBER size_t MemoryManager::allocate_batch(size_t bytes, size_t count, void** out) noexcept
+		{
+			if (MICRO_UNLIKELY(!arenas)) {
+				// Initialize arenas if necessary
+				if (!initialize_arenas())
+					return 0;
+			}
+
+			bytes += (bytes == 0);
+			size_t done = 0;
+			bool small = bytes <= params().small_alloc_threshold;
+#if MICRO_THREAD_LOCAL_NO_ALLOC == 0
+			// Let allocate() handle recursion detection
+			if (get_main_manager() == this)
+				small = false;
+#endif
+			if (small) {
+#ifdef MICRO_OVERRIDE
+				init();
+#endif
+				// Allocate from the tiny memory pool, by packets of at most max_objects
+				TinyMemPool* pool = select_arena()->tiny_pool();
+				while (done < count) {
+					unsigned to_alloc = static_cast<unsigned>(std::min(count - done, static_cast<size_t>(TinyBlockPool::max_objects)));
+					unsigned r = pool->allocate_batch(static_cast<unsigned>(bytes), out + done, to_alloc);
+#ifdef MICRO_ENABLE_STATISTICS_PARAMETERS
+					if (MICRO_UNLIKELY(params().print_stats_trigger))
+						for (unsigned i = 0; i < r; ++i)
+							record_stats(out[done + i]);
+#endif
+					done += r;
+					if (r != to_alloc)
+						break;
+				}
+			}
+
+			// Remaining chunks (medium/big chunks or tiny pool failure)
+			for (; done < count; ++done) {
+				if (!(out[done] = allocate(bytes)))
+					break;
+			}
+			return done;
+		}
+
 		MICRO_EXPORT_CLASS_MEMBER void MemoryManager::record_stats(void* p, int status) noexcept
 		{
 			// Record allocation statistics
@@ -1380,35 +1907,76 @@ namespace micro
 		{
 			// Find the MemoryManager that manages given page run.
 			// Returns null if the parent MemoryManager cannot be found (meaning that the page run wasn't created by the micro library)
-			end_lock().lock_shared();
-			BaseMemoryManagerIter* m = end_mgr()->right;
-			MemoryManager* found = nullptr;
-			while (m != end_mgr()) {
-				if (static_cast<MemoryManager*>(m)->page_map.find(run)) {
-					found = static_cast<MemoryManager*>(m);
-					break;
-				}
-				m = m->right;
-			}
-			end_lock().unlock_shared();
-			return found;
+			MemoryManager* m = static_cast<MemoryManager*>(pmap().find(run));
+			if (MICRO_UNLIKELY(!m))
+				m = find_shared(run);
+			return m;
 		}
 		MICRO_EXPORT_CLASS_MEMBER MemoryManager* MemoryManager::find_from_ptr(void* p) noexcept
 		{
 			// Find the MemoryManager that manages given address.
 			// Returns null if the parent MemoryManager cannot be found (meaning that the allocated chunk wasn't created by the micro library)
-			end_lock().lock_shared();
-			BaseMemoryManagerIter* m = end_mgr()->right;
-			MemoryManager* found = nullptr;
-			while (m != end_mgr()) {
-				if (static_cast<MemoryManager*>(m)->page_map.own(p)) {
-					found = static_cast<MemoryManager*>(m);
-					break;
-				}
-				m = m->right;
+			return static_cast<MemoryManager*>(pmap().owner(p));
+		}
+
+		MICRO_EXPORT_CLASS_MEMBER std::atomic<MemoryManager*>* MemoryManager::shared_managers() noexcept
+		{
+			static std::atomic<MemoryManager*> managers[MICRO_MAX_SHARED_HEAPS];
+			return managers;
+		}
+		MICRO_EXPORT_CLASS_MEMBER MemoryManager* MemoryManager::find_shared(PageRunHeader* run) noexcept
+		{
+			// Page runs of shared heaps might be allocated by another process, and are not in the page map.
+			// Use the page provider boundary tags instead.
+			std::atomic<MemoryManager*>* managers = shared_managers();
+			for (unsigned i = 0; i < MICRO_MAX_SHARED_HEAPS; ++i) {
+				MemoryManager* m = managers[i].load(std::memory_order_acquire);
+				if (!m || !m->page_provider()->allocated_run(run))
+					continue;
+				// Runs in the free lists are allocated from the provider, but not used
+				if (run->right_free == nullptr || run->right_free == run)
+					return m;
+				return nullptr;
 			}
-			end_lock().unlock_shared();
-			return found;
+			return nullptr;
+		}
+		MICRO_EXPORT_CLASS_MEMBER bool MemoryManager::register_shared(MemoryManager* m) noexcept
+		{
+			std::atomic<MemoryManager*>* managers = shared_managers();
+			for (unsigned i = 0; i < MICRO_MAX_SHARED_HEAPS; ++i)
+				if (managers[i].load() == m)
+					return true;
+			for (unsigned i = 0; i < MICRO_MAX_SHARED_HEAPS; ++i) {
+				MemoryManager* expected = nullptr;
+				if (managers[i].compare_exchange_strong(expected, m))
+					return true;
+			}
+			return false;
+		}
+		MICRO_EXPORT_CLASS_MEMBER void MemoryManager::unregister_shared(MemoryManager* m) noexcept
+		{
+			std::atomic<MemoryManager*>* managers = shared_managers();
+			for (unsigned i = 0; i < MICRO_MAX_SHARED_HEAPS; ++i) {
+				MemoryManager* expected = m;
+				managers[i].compare_exchange_strong(expected, nullptr);
+			}
+		}
+		MICRO_EXPORT_CLASS_MEMBER bool MemoryManager::set_shared() noexcept
+		{
+			if (shared)
+				return true;
+			if (!register_shared(this))
+				return false;
+			{
+				// Page runs are now found with find_shared()
+				std::lock_guard<lock_type> ll(lock);
+				for (PageRunHeader* p = end.right; p != &end; p = p->right)
+					pmap().erase(p, this);
+				shared = true;
+			}
+			// Other processes cannot access this process list
+			remove_manager(this);
+			return true;
 		}
 
 		MICRO_EXPORT_CLASS_MEMBER int MemoryManager::type_of_maybe_small(SmallChunkHeader* tiny, block_pool_type* pool, void* p) noexcept
@@ -1447,7 +2015,7 @@ namespace micro
 				return tiny->status;
 
 			// If this is not a small block, the pool run page should be invalid
-			if (!m->page_map.find(pool->get_parent_run()))
+			if (find_from_page_run(pool->get_parent_run()) != m)
 				return tiny->status;
 
 			// Final check : we know the parent PageRunHeader is valid, but does it contains a valid pool at this address ?
@@ -1464,6 +2032,14 @@ namespace micro
 			return main;
 		}
 
+		MICRO_EXPORT_CLASS_MEMBER PageMap& MemoryManager::pmap() noexcept
+		{
+			// Never destroyed, as chunks might be deallocated during static destruction
+			alignas(PageMap) static char storage[sizeof(PageMap)];
+			static PageMap* map = new (storage) PageMap();
+			return *map;
+		}
+
 		MICRO_EXPORT_CLASS_MEMBER bool MemoryManager::verify_block(int status, void* p) noexcept
 		{
 #ifdef MICRO_DEBUG
@@ -1493,7 +2069,7 @@ namespace micro
 				MemoryManager* m = static_cast<MemoryManager*>(static_cast<Arena*>(mem->arena)->manager());
 				h->parent()->lock.unlock();
 
-				MICRO_ASSERT_DEBUG(m->pmap().find(mem), "");
+				MICRO_ASSERT_DEBUG(find_from_page_run(mem) == m, "");
 				MICRO_ASSERT_DEBUG(from_small == nullptr || from_small == mem, "");
 			}
 			if (status == MICRO_ALLOC_BIG) {
@@ -1503,7 +2079,7 @@ namespace micro
 				PageRunHeader* mem = PageRunHeader::from(h->as_char() - h->th.offset_bytes);
 				MemoryManager* m = static_cast<MemoryManager*>(mem->arena);
 
-				MICRO_ASSERT_DEBUG(m->pmap().find(mem), "");
+				MICRO_ASSERT_DEBUG(find_from_page_run(mem) == m, "");
 			}
 #else
 			(void)status;
@@ -1568,6 +2144,263 @@ namespace micro
 			}
 		}
 
+		MICRO_EXPORT_CLASS_MEMBER void MemoryManager::deallocate_batch(void** ptrs, size_t count) noexcept
+		{
+			size_t i = 0;
+			while (i < count) {
+				void* p = ptrs[i];
+				if (!p) {
+					++i;
+					continue;
+				}
+
+				block_pool_type* pool = nullptr;
+				BaseMemoryManager* mgr = nullptr;
+				int status = type_of(p, &pool, &mgr);
+				MICRO_ASSERT_DEBUG(status != MICRO_ALLOC_SMALL_BLOCK || mgr, "");
+				MICRO_ASSERT_DEBUG(verify_block(status, p), "");
+
+				if (status != MICRO_ALLOC_SMALL_BLOCK) {
+					deallocate(p, status, pool, mgr, true);
+					++i;
+					continue;
+				}
+
+				// Group following chunks belonging to the same block.
+				// Any address inside the block is one of its objects.
+				size_t j = i + 1;
+				while (j < count && j - i < TinyBlockPool::max_objects && ptrs[j] && pool->is_inside(ptrs[j]))
+					++j;
+
+#ifdef MICRO_ENABLE_STATISTICS_PARAMETERS
+				MemoryManager* m = static_cast<MemoryManager*>(mgr);
+				if (MICRO_UNLIKELY(m->params().print_stats_trigger)) {
+					size_t bytes = usable_size(p, MICRO_ALLOC_SMALL_BLOCK);
+					for (size_t k = i; k < j; ++k)
+						m->mem_stats.deallocate_small(bytes);
+				}
+#endif
+				TinyMemPool::deallocate_batch(ptrs + i, static_cast<unsigned>(j - i), pool);
+				i = j;
+			}
+		}
+
+#ifndef MICRO_NO_LOCK
+
+		MICRO_EXPORT_CLASS_MEMBER ThreadCache* MemoryManager::create_thread_cache(unsigned id) noexcept
+		{
+			// Create the magazines for given thread id
+			void* p = allocate_and_forget(static_cast<unsigned>(sizeof(ThreadCache)));
+			if (MICRO_UNLIKELY(!p))
+				return nullptr;
+			ThreadCache* tc = new (p) ThreadCache();
+			// Flush the magazines on thread exit
+			ThreadCounter::set_exit_callback(on_thread_exit);
+			return thread_caches[id] = tc;
+		}
+
+		MICRO_EXPORT_CLASS_MEMBER bool MemoryManager::thread_cache_reserve(ThreadCache* tc, size_t bytes) noexcept
+		{
+			// Reserve at least bytes from the global thread cache budget.
+			// Reserve by chunks of MICRO_THREAD_CACHE_RESERVE bytes to limit contention on the global counter.
+			const size_t cap = static_cast<size_t>(params().thread_cache_bytes);
+			const size_t chunk = bytes > MICRO_THREAD_CACHE_RESERVE ? bytes : MICRO_THREAD_CACHE_RESERVE;
+			size_t cur = thread_cache_reserved.load(std::memory_order_relaxed);
+			for (;;) {
+				size_t take = cur + chunk <= cap ? chunk : (cur + bytes <= cap ? bytes : 0);
+				if (take == 0)
+					return false;
+				if (thread_cache_reserved.compare_exchange_weak(cur, cur + take, std::memory_order_relaxed)) {
+					tc->reserved += take;
+					tc->credit += take;
+					return true;
+				}
+			}
+		}
+
+		MICRO_EXPORT_CLASS_MEMBER void MemoryManager::thread_cache_release(ThreadCache* tc) noexcept
+		{
+			// Give back unused budget, but keep some for following deallocations
+			if (tc->credit > 2 * MICRO_THREAD_CACHE_RESERVE) {
+				size_t give = tc->credit - MICRO_THREAD_CACHE_RESERVE;
+				tc->credit -= give;
+				tc->reserved -= give;
+				thread_cache_reserved.fetch_sub(give, std::memory_order_relaxed);
+			}
+		}
+
+		MICRO_EXPORT_CLASS_MEMBER void MemoryManager::thread_cache_flush(ThreadCache* tc, unsigned idx, unsigned count) noexcept
+		{
+			// Give back the count oldest objects of given magazine to their TinyBlockPool
+			auto& mag = tc->mags[idx];
+			MICRO_ASSERT_DEBUG(count <= mag.count, "");
+			for (unsigned i = 0; i < count; ++i) {
+				block_pool_type* pool = nullptr;
+				BaseMemoryManager* mgr = nullptr;
+				int status = type_of(mag.objs[i], &pool, &mgr);
+				(void)status;
+				MICRO_ASSERT_DEBUG(status == MICRO_ALLOC_SMALL_BLOCK && mgr == this, "");
+				TinyMemPool::deallocate(mag.objs[i], pool);
+			}
+			mag.count -= count;
+			memmove(mag.objs, mag.objs + count, mag.count * sizeof(void*));
+			tc->credit += count * SmallAllocation::idx_to_size(idx);
+		}
+
+		MICRO_EXPORT_CLASS_MEMBER void* MemoryManager::thread_cache_refill(ThreadCache* tc, unsigned idx) noexcept
+		{
+			// Refill an empty magazine from the arena TinyMemPool.
+			// Only half of the magazine is filled to leave room for following deallocations.
+			// The last object might not be a small one (direct allocation from the radix tree), so it is never cached.
+			const unsigned size = SmallAllocation::idx_to_size(idx);
+			unsigned count = MICRO_THREAD_CACHE_OBJECTS / 2;
+			if (tc->credit < size * (count - 1) && !thread_cache_reserve(tc, size * (count - 1)))
+				count = 1;
+
+			auto& mag = tc->mags[idx];
+			unsigned r = select_arena()->tiny_pool()->allocate_batch(size, mag.objs, count);
+			if (r == 0)
+				return nullptr;
+			mag.count = r - 1;
+			tc->credit -= mag.count * size;
+			return mag.objs[r - 1];
+		}
+
+		MICRO_EXPORT_CLASS_MEMBER bool MemoryManager::thread_cache_push(ThreadCache* tc, void* p, unsigned idx) noexcept
+		{
+			// Slow path of thread_cache_deallocate(): the magazine is full or the budget is exhausted
+			const unsigned size = SmallAllocation::idx_to_size(idx);
+			auto& mag = tc->mags[idx];
+			if (mag.count == MICRO_THREAD_CACHE_OBJECTS) {
+				thread_cache_flush(tc, idx, MICRO_THREAD_CACHE_OBJECTS / 2);
+				thread_cache_release(tc);
+			}
+			if (tc->credit < size && !thread_cache_reserve(tc, size))
+				return false;
+			tc->credit -= size;
+			mag.objs[mag.count++] = p;
+			return true;
+		}
+
+		MICRO_EXPORT_CLASS_MEMBER void MemoryManager::flush_thread_cache(unsigned id) noexcept
+		{
+			// Flush all magazines of given thread id and give back its budget
+			std::lock_guard<lock_type> ll(lock);
+			if (!thread_caches || !arenas)
+				return;
+			ThreadCache* tc = thread_caches[id];
+			if (!tc)
+				return;
+			for (unsigned i = 0; i < SmallAllocation::class_count; ++i)
+				if (tc->mags[i].count)
+					thread_cache_flush(tc, i, tc->mags[i].count);
+			thread_cache_reserved.fetch_sub(tc->reserved, std::memory_order_relaxed);
+			tc->reserved = tc->credit = 0;
+		}
+
+		MICRO_EXPORT_CLASS_MEMBER void MemoryManager::on_thread_exit(unsigned id) noexcept
+		{
+			// Thread id is about to be recycled: flush its magazines in all managers
+			end_lock().lock_shared();
+			BaseMemoryManagerIter* m = end_mgr()->right;
+			while (m != end_mgr()) {
+				static_cast<MemoryManager*>(m)->flush_thread_cache(id);
+				m = m->right;
+			}
+			end_lock().unlock_shared();
+		}
+
+		MICRO_EXPORT_CLASS_MEMBER unsigned MemoryManager::purge_decayed() noexcept
+		{
+			// Return the free page runs that outlived the decay time.
+			// Returns the decay epoch duration in ms, or 0 if the decay is disabled.
+			// Only called from the purge thread, which owns purge_epoch_time
+			const unsigned decay_ms = params().purge_decay_ms;
+			if (!decay_ms) {
+				purge_epoch_time = 0;
+				return 0;
+			}
+			const unsigned epoch_ms = decay_ms < MICRO_PURGE_EPOCHS ? 1u : decay_ms / MICRO_PURGE_EPOCHS;
+			const std::uint64_t epoch_ns = epoch_ms * 1000000ull;
+
+			timer t;
+			t.tick();
+			PageRunHeader* to_free = nullptr;
+			{
+				std::unique_lock<lock_type> ll(lock);
+
+				const std::uint64_t now = el_timer.tock();
+				if (purge_epoch_time == 0) {
+					// First pass since the decay was enabled
+					purge_epoch_time = now;
+					return epoch_ms;
+				}
+				std::uint64_t elapsed = (now - purge_epoch_time) / epoch_ns;
+				if (elapsed == 0)
+					return epoch_ms;
+				purge_epoch_time += elapsed * epoch_ns;
+
+				// Start new epochs, forgetting the pages inserted more than decay_ms ago
+				for (std::uint64_t i = 0; i < elapsed && i < MICRO_PURGE_EPOCHS; ++i) {
+					purge_epoch = (purge_epoch + 1u) % MICRO_PURGE_EPOCHS;
+					purge_epoch_pages[purge_epoch] = 0;
+				}
+
+				// Pages inserted during the last epochs are kept with a weight decreasing linearly with their age
+				size_t keep = 0;
+				for (unsigned k = 0; k < MICRO_PURGE_EPOCHS; ++k)
+					keep += purge_epoch_pages[(purge_epoch + MICRO_PURGE_EPOCHS - k) % MICRO_PURGE_EPOCHS] * (MICRO_PURGE_EPOCHS - k) / MICRO_PURGE_EPOCHS;
+
+				std::uint64_t limit = static_cast<std::uint64_t>(keep) << os_psize_bits;
+				std::uint64_t backend = backend_limit();
+				to_free = unlink_free_pages(limit > backend ? limit : backend);
+			}
+
+			if (to_free) {
+				purged_bytes.fetch_add(release_pages(to_free), std::memory_order_relaxed);
+				purge_time_ns.fetch_add(t.tock(), std::memory_order_relaxed);
+				++purge_count;
+			}
+			return epoch_ms;
+		}
+
+		MICRO_EXPORT_CLASS_MEMBER void MemoryManager::purge_thread_loop() noexcept
+		{
+			// Background purge thread, lives until process exit
+			for (;;) {
+				unsigned sleep_ms = 100;
+				end_lock().lock_shared();
+				BaseMemoryManagerIter* m = end_mgr()->right;
+				while (m != end_mgr()) {
+					MemoryManager* mgr = static_cast<MemoryManager*>(m);
+					if (!mgr->purge_stopped) {
+						unsigned epoch_ms = mgr->purge_decayed();
+						if (epoch_ms && epoch_ms < sleep_ms)
+							sleep_ms = epoch_ms;
+					}
+					m = m->right;
+				}
+				end_lock().unlock_shared();
+				std::this_thread::sleep_for(std::chrono::milliseconds(sleep_ms));
+			}
+		}
+
+		MICRO_EXPORT_CLASS_MEMBER void MemoryManager::start_purge_thread() noexcept
+		{
+			// Start the purge thread on the first page run deallocation with a decay time
+			static std::atomic<bool> started{ false };
+			if (started.load(std::memory_order_relaxed) || started.exchange(true))
+				return;
+			try {
+				std::thread(purge_thread_loop).detach();
+			}
+			catch (...) {
+				started.store(false);
+			}
+		}
+
+#endif
+
 		MICRO_EXPORT_CLASS_MEMBER size_t MemoryManager::usable_size(void* p, int status) noexcept
 		{
 			// Get chunk full size in bytes
@@ -1598,6 +2431,162 @@ namespace micro
 			MICRO_UNREACHABLE();
 		}
 
+		MICRO_EXPORT_CLASS_MEMBER bool MemoryManager::resize_in_place(void* p, size_t bytes) noexcept
+		{
+			// Grow or shrink a chunk without moving it.
+			// Only medium chunks can be resized.
+
+			if (MICRO_UNLIKELY(!p))
+				return false;
+
+			int status = type_of(p);
+			if (status != MICRO_ALLOC_MEDIUM)
+				return bytes <= usable_size(p, status);
+
+			auto* parent = (MediumChunkHeader::from(p) - 1)->parent();
+			auto* arena = static_cast<Arena*>(parent->arena);
+			MemoryManager* m = static_cast<MemoryManager*>(arena->manager());
+
+			// Stay in the radix tree range
+			if (bytes > m->max_medium_size())
+				return false;
+
+#ifdef MICRO_ENABLE_STATISTICS_PARAMETERS
+			size_t old_bytes = usable_size(p, status);
+#endif
+			unsigned elems = RadixTree::bytes_to_elems(bytes ? static_cast<unsigned>(bytes) : 1u);
+			if (!arena->tree()->resize(p, elems))
+				return false;
+
+#ifdef MICRO_ENABLE_STATISTICS_PARAMETERS
+			if (MICRO_UNLIKELY(m->params().print_stats_trigger)) {
+				m->mem_stats.deallocate_medium(old_bytes);
+				m->mem_stats.allocate_medium(usable_size(p, status));
+			}
+#endif
+			return true;
+		}
+
+		MICRO_EXPORT_CLASS_MEMBER void* MemoryManager::reallocate_big(void* p, size_t bytes) noexcept
+		{
+			// Grow or shrink a big chunk using the page provider remapping facility (if any)
+
+			BigChunkHeader* h = BigChunkHeader::from(p) - 1;
+			MICRO_ASSERT_DEBUG(h->th.guard == MICRO_BLOCK_GUARD, "");
+			MICRO_ASSERT_DEBUG(h->th.status == MICRO_ALLOC_BIG, "");
+
+			PageRunHeader* run = PageRunHeader::from(h->as_char() - h->th.offset_bytes);
+			MemoryManager* m = static_cast<MemoryManager*>(run->arena);
+
+			// The chunk must remain a big one
+			if (bytes <= m->max_medium_size())
+				return nullptr;
+
+			// Compute new page count, aligned to os_alloc_granularity
+			const size_t offset = static_cast<size_t>(static_cast<char*>(p) - run->as_char());
+			size_t size_bytes = bytes + offset;
+			if (size_bytes % m->os_alloc_granularity)
+				size_bytes = (size_bytes / m->os_alloc_granularity + 1u) * m->os_alloc_granularity;
+			const size_t old_pages = static_cast<size_t>(run->size_bytes >> m->os_psize_bits);
+			const size_t new_pages = size_bytes >> m->os_psize_bits;
+			if (new_pages == old_pages) {
+				h->size = bytes;
+				return p;
+			}
+
+#ifdef MICRO_ENABLE_STATISTICS_PARAMETERS
+			size_t old_bytes = usable_size(p, MICRO_ALLOC_BIG);
+#endif
+			PageRunHeader* r = nullptr;
+			{
+				std::lock_guard<lock_type> ll(m->lock);
+
+				// We are going to allocate pages, make sure it won't go over the limit
+				if (new_pages > old_pages) {
+					size_t current_pages = m->used_pages.load(std::memory_order_relaxed) + m->free_page_count;
+					if (MICRO_UNLIKELY(m->params().memory_limit && m->params().memory_limit < (current_pages + new_pages - old_pages) * m->os_psize))
+						return nullptr;
+				}
+
+				// Remove the page run from the page map and the list of page runs
+				// as its address might change.
+				m->pmap_erase(run);
+				run->remove();
+
+				r = PageRunHeader::from(m->page_provider()->reallocate_pages(run, old_pages, new_pages));
+				if (r) {
+					r->size_bytes = new_pages << m->os_psize_bits;
+					if (new_pages > old_pages)
+						m->used_pages += new_pages - old_pages;
+					else
+						m->used_pages -= old_pages - new_pages;
+					if (m->used_pages.load(std::memory_order_relaxed) + m->free_page_count > m->max_pages.load(std::memory_order_relaxed))
+						m->max_pages.store(m->used_pages.load(std::memory_order_relaxed) + m->free_page_count);
+				}
+
+				// Insert back the (potentially new) page run.
+				// Page map nodes are never released, so the insertion only fails if the pages grew or moved.
+				PageRunHeader* back = r ? r : run;
+				if (MICRO_UNLIKELY(!m->pmap_insert(back))) {
+					MICRO_ASSERT_DEBUG(r != nullptr, "");
+					if (r == run) {
+						// Undo the remap: shrinking is done in place,
+						// and the previous range was already registered.
+						if (PageRunHeader::from(m->page_provider()->reallocate_pages(r, new_pages, old_pages)) == run) {
+							run->size_bytes = old_pages << m->os_psize_bits;
+							m->used_pages -= new_pages - old_pages;
+							m->pmap_insert(run);
+							r = nullptr;
+						}
+					}
+					else if (PageRunHeader* o = PageRunHeader::from(m->page_provider()->allocate_pages(new_pages))) {
+						// The previous pages are gone, copy the chunk to new registered pages
+						if (m->pmap_insert(o)) {
+							memcpy(o->as_char(), r->as_char(), (old_pages < new_pages ? old_pages : new_pages) << m->os_psize_bits);
+							m->page_provider()->deallocate_pages(r, new_pages);
+							back = r = o;
+						}
+						else
+							m->page_provider()->deallocate_pages(o, new_pages);
+					}
+					// Otherwise the chunk stays valid but is not registered in the page map
+				}
+				back->insert(&m->end);
+			}
+			if (MICRO_UNLIKELY(!r))
+				return nullptr;
+
+			// Update chunk header
+			void* res = r->as_char() + offset;
+			h = BigChunkHeader::from(res) - 1;
+			h->size = bytes;
+
+#ifdef MICRO_ENABLE_STATISTICS_PARAMETERS
+			if (MICRO_UNLIKELY(m->params().print_stats_trigger)) {
+				m->mem_stats.deallocate_big(old_bytes);
+				m->mem_stats.allocate_big(usable_size(res, MICRO_ALLOC_BIG));
+			}
+#endif
+			return res;
+		}
+
+		MICRO_EXPORT_CLASS_MEMBER void* MemoryManager::try_reallocate(void* p, size_t bytes) noexcept
+		{
+			// Reallocate without copying: resize medium chunks in place,
+			// remap big chunks.
+
+			if (MICRO_UNLIKELY(!p))
+				return nullptr;
+
+			int status = type_of(p);
+			if (status == MICRO_ALLOC_BIG) {
+				if (void* r = reallocate_big(p, bytes))
+					return r;
+				return bytes <= usable_size(p, status) ? p : nullptr;
+			}
+			return resize_in_place(p, bytes) ? p : nullptr;
+		}
+
 		MICRO_EXPORT_CLASS_MEMBER void MemoryManager::reset_statistics() noexcept
 		{
 			// Reset stats
@@ -1644,6 +2633,17 @@ namespace micro
 
 			st.total_alloc_time_ns = stats().total_alloc_time_ns;
 			st.total_dealloc_time_ns = stats().total_dealloc_time_ns;
+#ifndef MICRO_NO_LOCK
+			st.thread_cache_bytes = thread_cache_reserved.load(std::memory_order_relaxed);
+			st.purged_bytes = purged_bytes.load(std::memory_order_relaxed);
+			st.purge_count = purge_count.load(std::memory_order_relaxed);
+			st.purge_time_ns = purge_time_ns.load(std::memory_order_relaxed);
+#else
+			st.thread_cache_bytes = 0;
+			st.purged_bytes = st.purge_count = st.purge_time_ns = 0;
+#endif
+			st.numa_cross_node_allocs = numa_cross_node_allocs.load(std::memory_order_relaxed);
+			st.prealloc_time_ns = page_provider()->prealloc_time_ns();
 		}
 
 		static inline std::uint64_t div_bytes(std::uint64_t a, std::uint64_t b) noexcept { return b == 0 ? 0ull : static_cast<std::uint64_t>(static_cast<double>(a) / static_cast<double>(b)); }
@@ -196,8 +196,24 @@ namespace micro
 
 			mask_type mask;									// Mask of non null positions
 			uint32_t parent_index{ 0 };						// Index in parent tree
-			lock_type locks[RadixAccess::l1_size];			// One spinlock per position
+			MICRO_CACHE_ALIGNED lock_type locks[RadixAccess::l1_size];	// One spinlock per position, see lock()
 			MediumChunkHeader* data[RadixAccess::l1_size];	// Array of free MediumChunkHeader. Each entry is a linked list of MediumChunkHeader.
+
+#if MICRO_PAD_LOCKS
+			// Consecutive positions (close chunk sizes) use locks from different cache lines
+			static constexpr unsigned lock_lines = (RadixAccess::l1_size * sizeof(lock_type) + MICRO_CACHE_LINE_SIZE - 1u) / MICRO_CACHE_LINE_SIZE;
+			static ALLOCATOR_INLINE unsigned lock_index(unsigned pos) noexcept { return (pos % lock_lines) * (RadixAccess::l1_size / lock_lines) + pos / lock_lines; }
+#else
+			static ALLOCATOR_INLINE unsigned lock_index(unsigned pos) noexcept { return pos; }
+#endif
+			/// @brief Returns the spinlock of given position
+			ALLOCATOR_INLINE lock_type& lock(unsigned pos) noexcept { return locks[lock_index(pos)]; }
+
+			/// @brief Align raw memory for a RadixLeaf
+			static ALLOCATOR_INLINE RadixLeaf* align(void* p) noexcept
+			{
+				return reinterpret_cast<RadixLeaf*>((reinterpret_cast<uintptr_t>(p) + alignof(RadixLeaf) - 1u) & ~static_cast<uintptr_t>(alignof(RadixLeaf) - 1u));
+			}
 		};
 
 
@@ -301,14 +317,14 @@ namespace micro
 			ALLOCATOR_INLINE RadixLeaf* lower_bound_lock(unsigned elems, Match& m) noexcept
 			{
 				while (RadixLeaf* ch = lower_bound(elems, m)) {
-					ch->locks[m.index1].lock();
+					ch->lock(m.index1).lock();
 					if (MICRO_LIKELY(ch->data[m.index1])) {
 						MICRO_ASSERT_DEBUG(ch->data[m.index1]->elems >= elems, "");
 						MICRO_ASSERT_DEBUG(ch->data[m.index1]->th.guard == MICRO_BLOCK_GUARD, "");
 						MICRO_ASSERT_DEBUG(ch->data[m.index1]->th.status == MICRO_ALLOC_FREE, "");
 						return ch;
 					}
-					ch->locks[m.index1].unlock();
+					ch->lock(m.index1).unlock();
 				}
 				return nullptr;
 			}
@@ -367,7 +383,7 @@ namespace micro
 			ALLOCATOR_INLINE void insert_free(MediumChunkHeader* h, RadixLeaf* ch, Match& m) noexcept
 			{
 				h->set_prev(nullptr);
-				std::lock_guard<lock_type> ll(ch->locks[m.index1]);
+				std::lock_guard<lock_type> ll(ch->lock(m.index1));
 
 #if MICRO_USE_NODE_LOCK == 0
 				MICRO_ASSERT_DEBUG(check_prev_next(h), "");
@@ -395,6 +411,14 @@ namespace micro
 			/// @brief Add a new free chunk of size MICRO_BLOCK_SIZE bytes to the tree
 			bool add_new() noexcept;
 
+			/// @brief Returns parameters::decommit_threshold of the parent manager
+			std::uint64_t decommit_threshold() noexcept;
+
+			/// @brief Decommit the whole pages inside free chunk f (not yet inserted) if they reach the decommit threshold,
+			/// or if forced is true (f was merged with a decommitted chunk), and update the decommit tag of f.
+			/// If partial is true, only the pages overlapping [begin, end) might still be committed.
+			void decommit_interior(MediumChunkHeader* f, const char* begin, const char* end, bool partial, bool forced) noexcept;
+
 			/// @brief Split chunk
 			MediumChunkHeader* split_chunk(MediumChunkHeader*& h, PageRunHeader* parent, unsigned elems_1, Match& m, RadixLeaf*& ch) noexcept;
 
@@ -405,7 +429,7 @@ namespace micro
 				Match m;
 				RadixLeaf* ch = get_free_no_check(c->elems, m);
 
-				std::lock_guard<lock_type> ll(ch->locks[m.index1]);
+				std::lock_guard<lock_type> ll(ch->lock(m.index1));
 
 				// remove free chunk from tree
 
@@ -497,6 +521,15 @@ namespace micro
 			/// Returns the deallocated block size in bytes.
 			unsigned deallocate(void* ptr) noexcept;
 
+			/// @brief Grow or shrink in place a chunk previously allocated with allocate_elems().
+			/// Growing consumes the next chunk if free, shrinking releases the chunk tail.
+			/// Returns false if the chunk cannot be grown in place.
+			bool resize(void* ptr, unsigned elems) noexcept;
+
+			/// @brief Decommit the whole pages of all free chunks, whatever the decommit threshold.
+			/// Chunks already decommitted are skipped. Returns the number of bytes decommitted by this call.
+			std::uint64_t decommit_free_chunks() noexcept;
+
 			ALLOCATOR_INLINE bool has_small_free_chunks() const noexcept { return mask.has_first_bit(); }
 		};
 
@@ -519,19 +552,29 @@ namespace micro
 			RadixTree radix_tree; // radix tree
 			TinyMemPool pool;     // small object pool
 		public:
-			Arena(BaseMemoryManager* p) noexcept
+			Arena(BaseMemoryManager* p, unsigned node = 0) noexcept
 			  : pmanager(p)
 			  , radix_tree(this)
 			  , pool(p)
+			  , numa_node(node)
 			{
 			}
 			MICRO_DELETE_COPY(Arena)
 			ALLOCATOR_INLINE BaseMemoryManager* manager() noexcept { return pmanager; }
+			/// @brief Attach the arena to another manager, used when a persistent heap is reopened
+			void relocate(BaseMemoryManager* p) noexcept
+			{
+				pmanager = p;
+				pool.set_manager(p);
+			}
 			ALLOCATOR_INLINE RadixTree* tree() noexcept { return &radix_tree; }
 			ALLOCATOR_INLINE TinyMemPool* tiny_pool() noexcept { return &pool; }
 
 			// Number of current allocate_in_other_arenas() calls for this arena
 			std::atomic<unsigned> other_arenas_count{ UINT_MAX };
+
+			// NUMA node of this arena (NUMA mode only)
+			const unsigned numa_node;
 		};
 
 		/// @brief Memory block used by MemPool, uses bump allocation
@@ -597,8 +640,15 @@ namespace micro
 			  : pmanager(m)
 			{
 			}
+			/// @brief Construct from a parent arena and the last block of a previous pool
+			MemPool(BaseMemoryManager* m, MemBlock* l) noexcept
+			  : last(l)
+			  , pmanager(m)
+			{
+			}
 
 			BaseMemoryManager* manager() noexcept { return pmanager; }
+			MemBlock* last_block() noexcept { return last; }
 
 			/// @brief Allocate size bytes
 			void* allocate(unsigned size) noexcept
@@ -666,12 +716,13 @@ namespace micro
 
 			using lock_type = recursive_spinlock;
 			lock_type lock;		// Recursive lock used to protect pages manipulations
-			PageRunHeader end;	// Linked list of ALL page runs
-			PageRunHeader end_free; // Buffer of pages
+			PageRunHeader end;				  // Linked list of ALL page runs
+			PageRunHeader end_free[MICRO_MAX_NUMA_NODES]; // Buffer of pages, per NUMA node
 
 			const unsigned os_psize;	     // used page size (from page provider)
 			const unsigned os_psize_bits;	     // page size bits
 			const unsigned os_alloc_granularity; // allocation granularity (from page provider)
+			const unsigned os_huge_psize;	     // huge page size of big page runs (from page provider), 0 if not used
 			const unsigned os_max_medium_pages;  // maximum page count for the radix tree
 			const unsigned os_max_medium_size;   // maximum size before big allocations (direct calls to the page provider)
 			timer el_timer;			     // object start time (for statistics)
@@ -682,7 +733,6 @@ namespace micro
 			std::atomic<size_t> max_pages{ 0 };  // Maximum used pages (or memory peak)
 			std::atomic<size_t> side_pages{ 0 }; // Pages used by the internal memory pool (radix leaf, page map...)
 
-			PageMap page_map; // page map, sorted array of ALL PageRunHeader currently in use
 
 			// memory pools for radix tree
 			MemPoolProxy radix_pool; // memory pool mainly used for radix tree allocation
@@ -698,8 +748,71 @@ namespace micro
 
 			ArenaProxy* arenas{ nullptr }; // array of arenas
 
+			unsigned numa_nodes{ 1 };			    // number of NUMA nodes, 1 if NUMA mode is disabled
+			unsigned numa_arena_mask{ 0 };			    // arenas per NUMA node minus one
+			std::atomic<size_t> numa_cross_node_allocs{ 0 }; // allocations served by another NUMA node
+
+#ifndef MICRO_NO_LOCK
+			ThreadCache** thread_caches{ nullptr };		 // per thread id magazines, null if thread_cache_bytes is 0
+			std::atomic<size_t> thread_cache_reserved{ 0 }; // bytes reserved by all thread caches
+
+			size_t purge_epoch_pages[MICRO_PURGE_EPOCHS]{};	      // free list pages inserted during each decay epoch (protected by lock)
+			unsigned purge_epoch{ 0 };			      // current decay epoch
+			std::uint64_t purge_epoch_time{ 0 };		      // current decay epoch start time (ns)
+			bool purge_stopped{ false };			      // manager destruction started, protected by end_lock()
+			std::atomic<std::uint64_t> purged_bytes{ 0 };	      // bytes returned by the purge thread
+			std::atomic<std::uint64_t> purge_count{ 0 };	      // purge passes that returned pages
+			std::atomic<std::uint64_t> purge_time_ns{ 0 };	      // total purge time
+#endif
+
+			/// @brief Manager state stored in the persistent area of the page provider
+			struct PersistentState
+			{
+				std::uint64_t magic;				 // MICRO_PERSISTENT_MAGIC if the state is valid
+				std::uint32_t layout[8];			 // structure sizes and parameters the state depends on
+				MemoryManager* manager;				 // manager that saved the state
+				PageRunHeader* first;				 // first run of the list of page runs
+				PageRunHeader* last;				 // last run of the list of page runs
+				PageRunHeader* first_free[MICRO_MAX_NUMA_NODES]; // first run of each free list
+				PageRunHeader* last_free[MICRO_MAX_NUMA_NODES];	 // last run of each free list
+				ArenaProxy* arenas;				 // array of arenas
+				MemBlock* pool_last;				 // last block of the radix_pool
+				void* thread_caches;				 // per thread id magazines
+				unsigned numa_nodes;
+				unsigned numa_arena_mask;
+				size_t used_pages;
+				size_t used_spans;
+				size_t free_page_count;
+				size_t max_pages;
+				size_t side_pages;
+				void* root;					 // root object
+			};
+			std::atomic<void*> root_ptr{ nullptr }; // root object of a persistent heap
+			bool shared{ false };			 // heap shared between processes (see set_shared())
+
+			/// @brief Insert a page run into the page map.
+			/// The page map is process local: page runs of shared heaps are found with find_shared() instead.
+			MICRO_ALWAYS_INLINE bool pmap_insert(PageRunHeader* run) noexcept { return shared || pmap().insert(run, this); }
+			/// @brief Remove a page run from the page map
+			MICRO_ALWAYS_INLINE void pmap_erase(PageRunHeader* run) noexcept
+			{
+				if (!shared)
+					pmap().erase(run, this);
+			}
+			/// @brief Returns the process local list of shared heaps mapped by this process
+			static std::atomic<MemoryManager*>* shared_managers() noexcept;
+			/// @brief Returns the shared MemoryManager owning given page run, or null
+			static MemoryManager* find_shared(PageRunHeader* run) noexcept;
+
 			/// @brief Initialize the arenas
 			bool initialize_arenas() noexcept;
+			/// @brief Fill the layout values checked when restoring a persistent state
+			void persistent_layout(std::uint32_t* layout) const noexcept;
+			/// @brief Save the manager state to the persistent area of the page provider, if any
+			void save_state() noexcept;
+			/// @brief Restore the manager state from the persistent area of the page provider, if any.
+			/// Returns false on failure (incompatible layout or page map error), true otherwise, including when no state was saved.
+			bool restore_state() noexcept;
 			/// @brief Compute the maximum number of pages for the radix tree
 			unsigned compute_max_medium_pages() const noexcept;
 			/// @brief Compute the allocation size limit before big allocations
@@ -719,7 +832,20 @@ namespace micro
 				// return std::min(get_thread_max_mask(), this->params().max_arenas - 1u);
 				return get_thread_max_mask() & (this->params().max_arenas - 1u);
 			}
-			MICRO_ALWAYS_INLINE unsigned select_arena_id() const noexcept { return this_thread_id_for_arena() & get_mask(); }
+			/// @brief Returns the NUMA node used to allocate pages in current thread
+			MICRO_ALWAYS_INLINE unsigned select_numa_node() const noexcept { return this->params().numa ? os_current_numa_node() % numa_nodes : 0u; }
+			MICRO_ALWAYS_INLINE unsigned select_arena_id() const noexcept
+			{
+				// NUMA mode: use the arenas of the current node
+				if (MICRO_UNLIKELY(this->params().numa)) {
+					unsigned id = this->params().arena_per_cpu ? this_cpu_id() : static_cast<unsigned>(this_thread_id_for_arena());
+					return select_numa_node() * (numa_arena_mask + 1u) + (id & numa_arena_mask);
+				}
+				// Arena per CPU: locality follows the threads actually running
+				if (this->params().arena_per_cpu)
+					return this_cpu_id() & (this->params().max_arenas - 1u);
+				return this_thread_id_for_arena() & get_mask();
+			}
 			/// @brief Returns the arena used to allocate memory in current thread
 			MICRO_ALWAYS_INLINE Arena* select_arena() noexcept
 			{
@@ -738,6 +864,74 @@ namespace micro
 			void* allocate_big(size_t bytes, unsigned align) noexcept;
 			void* allocate_big_path(size_t bytes, unsigned align, bool stats) noexcept;
 			void* allocate_in_other_arenas(size_t bytes, unsigned elems, unsigned align, Arena* first, bool request_for_page = false) noexcept;
+			std::uint64_t backend_limit() const noexcept;
+			PageRunHeader* unlink_free_pages(std::uint64_t limit) noexcept;
+			std::uint64_t release_pages(PageRunHeader* to_free) noexcept;
+
+#ifndef MICRO_NO_LOCK
+			ThreadCache* create_thread_cache(unsigned id) noexcept;
+			bool thread_cache_reserve(ThreadCache* tc, size_t bytes) noexcept;
+			void thread_cache_release(ThreadCache* tc) noexcept;
+			void thread_cache_flush(ThreadCache* tc, unsigned idx, unsigned count) noexcept;
+			void* thread_cache_refill(ThreadCache* tc, unsigned idx) noexcept;
+			bool thread_cache_push(ThreadCache* tc, void* p, unsigned idx) noexcept;
+			void flush_thread_cache(unsigned id) noexcept;
+			static void on_thread_exit(unsigned id) noexcept;
+			unsigned purge_decayed() noexcept;
+			static void start_purge_thread() noexcept;
+			static void purge_thread_loop() noexcept;
+
+			MICRO_ALWAYS_INLINE ThreadCache* get_thread_cache() noexcept
+			{
+				// Returns the current thread cache, or null if the thread id is not recycled
+				unsigned id = static_cast<unsigned>(this_thread_id());
+				if (MICRO_UNLIKELY(id >= ThreadCounter::max_threads))
+					return nullptr;
+				ThreadCache* tc = thread_caches[id];
+				return MICRO_LIKELY(tc != nullptr) ? tc : create_thread_cache(id);
+			}
+			MICRO_ALWAYS_INLINE void* thread_cache_allocate(unsigned bytes) noexcept
+			{
+				// Pop an object from the current thread magazine
+				ThreadCache* tc = get_thread_cache();
+				if (MICRO_UNLIKELY(!tc))
+					return nullptr;
+				unsigned idx = SmallAllocation::size_to_idx(bytes);
+				auto& mag = tc->mags[idx];
+				if (MICRO_LIKELY(mag.count != 0)) {
+					tc->credit += SmallAllocation::idx_to_size(idx);
+					return mag.objs[--mag.count];
+				}
+				return thread_cache_refill(tc, idx);
+			}
+			MICRO_ALWAYS_INLINE bool thread_cache_deallocate(void* p, block_pool_type* pool) noexcept
+			{
+				// Push an object to the current thread magazine
+				ThreadCache* tc = get_thread_cache();
+				if (MICRO_UNLIKELY(!tc))
+					return false;
+				unsigned idx = static_cast<unsigned>(pool->header.pool_idx_plus_one) - 1u;
+				unsigned size = SmallAllocation::idx_to_size(idx);
+				auto& mag = tc->mags[idx];
+				if (MICRO_UNLIKELY(mag.count == MICRO_THREAD_CACHE_OBJECTS || tc->credit < size))
+					return thread_cache_push(tc, p, idx);
+				tc->credit -= size;
+				mag.objs[mag.count++] = p;
+				return true;
+			}
+			MICRO_ALWAYS_INLINE bool deallocate_deferred(void* p, block_pool_type* pool) noexcept
+			{
+				// Keep the object in the thread cache if possible
+				if (thread_caches && thread_cache_deallocate(p, pool))
+					return true;
+				// Block owned by another arena: let the owner give back the object without taking its lock
+				if (MICRO_UNLIKELY(params().remote_free) && get_max_thread_count() > 1 && pool->get_parent() != select_arena()->tiny_pool()) {
+					TinyMemPool::deallocate_remote(p, pool);
+					return true;
+				}
+				return false;
+			}
+#endif
 
 			static MICRO_ALWAYS_INLINE void deallocate_small(void* p, block_pool_type* pool, MemoryManager* m, bool stats) noexcept
 			{
@@ -751,7 +945,10 @@ namespace micro
 					bytes = usable_size(p, MICRO_ALLOC_SMALL_BLOCK);
 				}
 #endif
-				TinyMemPool::deallocate(p, pool);
+#ifndef MICRO_NO_LOCK
+				if (!m->deallocate_deferred(p, pool))
+#endif
+					TinyMemPool::deallocate(p, pool);
 #ifdef MICRO_ENABLE_STATISTICS_PARAMETERS
 				if (MICRO_UNLIKELY(stats && m->params().print_stats_trigger)) {
 					MICRO_TIME_STATS(m->mem_stats.update_dealloc_time(get_local_timer().tock()));
@@ -784,9 +981,6 @@ namespace micro
 
 			static int type_of_maybe_small(SmallChunkHeader* tiny, block_pool_type* pool, void* p) noexcept;
 			// static int type_of(void* p, block_pool_type** block_pool = nullptr, BaseMemoryManager** memory_mgr = nullptr) noexcept;
-			static MemoryManager* find_from_page_run(PageRunHeader*) noexcept;
-			static MemoryManager* find_from_ptr(void* p) noexcept;
-
 			static MICRO_ALWAYS_INLINE int type_of(void* p, block_pool_type** block_pool = nullptr, BaseMemoryManager** memory_mgr = nullptr) noexcept
 			{
 				// Returns the pointer type, considering it is already a valid block allocated by a MemoryManager object.
@@ -835,7 +1029,7 @@ namespace micro
 			/// @brief Construct from parameters and initialize
 			MemoryManager(const parameters& p) noexcept;
 			/// @brief destructor, deallocate all remainign memory
-			~MemoryManager() noexcept override;
+			~MemoryManager() noexcept;
 
 			/// @brief Initialize the memory manager
 			MICRO_ALWAYS_INLINE void init() noexcept
@@ -845,19 +1039,48 @@ namespace micro
 						init_internal();
 			}
 
-			MICRO_ALWAYS_INLINE PageMap& pmap() noexcept { return page_map; }
-
-			/// @brief Clear the memory manager
-			virtual void clear() noexcept override;
+			/// @brief Returns the process wide page map shared by all MemoryManager objects
+			static PageMap& pmap() noexcept;
+			/// @brief Returns the MemoryManager owning given page run, or null. Lock free, O(1).
+			static MemoryManager* find_from_page_run(PageRunHeader*) noexcept;
+			/// @brief Returns the MemoryManager owning given address, or null. Lock free, O(1).
+			static MemoryManager* find_from_ptr(void* p) noexcept;
 
-			virtual PageRunHeader* allocate_pages(size_t page_count) noexcept override;
-			virtual PageRunHeader* allocate_medium_block() noexcept override;
-			virtual PageRunHeader* allocate_pages_for_bytes(size_t bytes) noexcept override;
-			virtual void deallocate_pages(PageRunHeader* p) noexcept override;
+			/// @brief Make this manager usable by several processes mapping it at the same address.
+			/// The manager is removed from the process page map and from the list of managers,
+			/// and registered as a shared heap of the current process.
+			/// Returns false if too many shared heaps are mapped by the current process.
+			bool set_shared() noexcept;
+			/// @brief Tells if this manager is shared between processes
+			MICRO_ALWAYS_INLINE bool is_shared() const noexcept { return shared; }
+			/// @brief Register a shared manager mapped by the current process.
+			/// Returns false if MICRO_MAX_SHARED_HEAPS shared heaps are already registered.
+			static bool register_shared(MemoryManager* m) noexcept;
+			/// @brief Unregister a shared manager before unmapping it
+			static void unregister_shared(MemoryManager* m) noexcept;
 
-			virtual void* allocate_no_tiny_pool(size_t bytes, unsigned obj_size, unsigned align, bool* is_small) noexcept override;
-			virtual void deallocate_no_tiny_pool(void*) noexcept override;
-			virtual void* allocate_and_forget(unsigned size) noexcept override
+			/// @brief Clear the memory manager
+			void clear() noexcept;
+
+			/// @brief Set the root object of a persistent heap, retrieved with root() once the heap is reopened
+			void set_root(void* p) noexcept;
+			/// @brief Returns the root object of a persistent heap
+			void* root() noexcept;
+
+			/// @brief Return as much memory as possible to the OS, keeping at most pad bytes of free page runs.
+			/// Empty tiny blocks are given back to the radix trees, whose free chunks are decommitted.
+			/// Returns the number of released bytes.
+			std::uint64_t trim(size_t pad) noexcept;
+
+			PageRunHeader* allocate_pages(size_t page_count) noexcept;
+			PageRunHeader* allocate_medium_block(unsigned numa_node) noexcept;
+			PageRunHeader* allocate_pages_on_node(size_t page_count, unsigned numa_node) noexcept;
+			PageRunHeader* allocate_pages_for_bytes(size_t bytes) noexcept;
+			void deallocate_pages(PageRunHeader* p) noexcept;
+
+			void* allocate_no_tiny_pool(size_t bytes, unsigned obj_size, unsigned align, bool* is_small) noexcept;
+			void deallocate_no_tiny_pool(void*) noexcept;
+			void* allocate_and_forget(unsigned size) noexcept
 			{
 				// Allocate using the memory pool
 				return radix_pool.as_mem_pool()->allocate(size);
@@ -866,8 +1089,34 @@ namespace micro
 			unsigned maximum_medium_size() const noexcept { return max_medium_size(); }
 			void* allocate(size_t bytes, unsigned align = 0) noexcept;
 			MICRO_ALWAYS_INLINE void* aligned_allocate(size_t alignment, size_t bytes) noexcept { return allocate(bytes, static_cast<unsigned>(alignment)); }
+			/// @brief Allocate count chunks of bytes each and store them in out.
+			/// Small chunks are carved from the tiny pool with a single lock per batch.
+			/// Returns the number of allocated chunks (lower than count on failure).
+			size_t allocate_batch(size_t bytes, size_t count, void** out) noexcept;
 			static void deallocate(void* p, int status, block_pool_type* pool, BaseMemoryManager* mgr, bool stats) noexcept;
 			static MICRO_ALWAYS_INLINE void deallocate(void* p) noexcept { deallocate(p, true); }
+			/// @brief Deallocate count chunks (null pointers are ignored).
+			/// Consecutive small chunks belonging to the same block are deallocated with a single lock.
+			static void deallocate_batch(void** ptrs, size_t count) noexcept;
+			/// @brief Deallocate a chunk whose requested size is known.
+			/// bytes must be lower or equal to the chunk usable size.
+			static MICRO_ALWAYS_INLINE void deallocate_sized(void* p, size_t bytes) noexcept
+			{
+				// Chunks bigger than MICRO_MAX_SMALL_ALLOC_THRESHOLD never belong to a TinyBlockPool:
+				// skip the block pool lookup and directly read the chunk header.
+				if (MICRO_UNLIKELY(!p))
+					return;
+				if (bytes <= MICRO_MAX_SMALL_ALLOC_THRESHOLD) {
+					deallocate(p, true);
+					return;
+				}
+
+				int status = (SmallChunkHeader::from(p) - 1)->status;
+				MICRO_ASSERT_DEBUG(status == type_of(p), "invalid chunk size");
+				MICRO_ASSERT_DEBUG(bytes <= usable_size(p, status), "invalid chunk size");
+				MICRO_ASSERT_DEBUG(verify_block(status, p), "");
+				deallocate(p, status, nullptr, nullptr, true);
+			}
 			static MICRO_ALWAYS_INLINE size_t usable_size(void* p) noexcept
 			{
 				if (MICRO_UNLIKELY(!p))
@@ -875,6 +1124,18 @@ namespace micro
 				return usable_size(p, type_of(p));
 			}
 			static size_t usable_size(void* p, int status) noexcept;
+			/// @brief Resize in place a chunk previously allocated with allocate().
+			/// Only medium chunks can be grown or shrunk, other chunks are left untouched.
+			/// Returns true if the chunk can hold at least bytes after the call.
+			static bool resize_in_place(void* p, size_t bytes) noexcept;
+			/// @brief Grow or shrink a big chunk by remapping its pages, if supported by the page provider.
+			/// The chunk might be moved, and its alignment is only preserved up to the page size.
+			/// Returns the new chunk address, or null on failure (in which case p is still valid).
+			static void* reallocate_big(void* p, size_t bytes) noexcept;
+			/// @brief Try to reallocate a chunk without copying its content.
+			/// Medium chunks are resized in place, big chunks are remapped if possible.
+			/// Returns the new chunk address, or null on failure (in which case p is still valid).
+			static void* try_reallocate(void* p, size_t bytes) noexcept;
 			static MICRO_ALWAYS_INLINE int type_of_safe(void* p, block_pool_type** block_pool = nullptr, BaseMemoryManager** memory_mgr = nullptr) noexcept
 			{
 				// Returns the type of the memory block, or 0 if i wasn't allocated with the micro library
@@ -892,10 +1153,12 @@ namespace micro
 			}
 			static MICRO_ALWAYS_INLINE int type_of_safe_for_proxy(void* p, block_pool_type** block_pool = nullptr, BaseMemoryManager** memory_mgr = nullptr) noexcept
 			{
-				// MemoryManager* main = get_main_manager();
-				// if (main && !main->page_map.is_inside(p))
-				//	return 0;
-				return type_of_safe(p, block_pool, memory_mgr);
+				// The proxy only handles chunks of the main manager, any other pointer is a foreign one.
+				// Relying on the page map avoids reading a chunk header that might not exist.
+				MemoryManager* main = get_main_manager();
+				if (main && pmap().owner(p) != main)
+					return 0;
+				return type_of(p, block_pool, memory_mgr);
 			}
 
 			void reset_statistics() noexcept;
@@ -918,6 +1181,20 @@ namespace micro
 
 			static MemoryManager*& get_main_manager() noexcept;
 		};
+
+		// BaseMemoryManager members, forwarded to MemoryManager without virtual dispatch
+
+		ALLOCATOR_INLINE void BaseMemoryManager::clear() noexcept { static_cast<MemoryManager*>(this)->clear(); }
+		ALLOCATOR_INLINE PageRunHeader* BaseMemoryManager::allocate_pages(size_t page_count) noexcept { return static_cast<MemoryManager*>(this)->allocate_pages(page_count); }
+		ALLOCATOR_INLINE PageRunHeader* BaseMemoryManager::allocate_pages_for_bytes(size_t bytes) noexcept { return static_cast<MemoryManager*>(this)->allocate_pages_for_bytes(bytes); }
+		ALLOCATOR_INLINE PageRunHeader* BaseMemoryManager::allocate_medium_block(unsigned numa_node) noexcept { return static_cast<MemoryManager*>(this)->allocate_medium_block(numa_node); }
+		ALLOCATOR_INLINE void BaseMemoryManager::deallocate_pages(PageRunHeader* p) noexcept { static_cast<MemoryManager*>(this)->deallocate_pages(p); }
+		ALLOCATOR_INLINE void* BaseMemoryManager::allocate_and_forget(unsigned size) noexcept { return static_cast<MemoryManager*>(this)->allocate_and_forget(size); }
+		ALLOCATOR_INLINE void* BaseMemoryManager::allocate_no_tiny_pool(size_t bytes, unsigned obj_size, unsigned align, bool* is_small) noexcept
+		{
+			return static_cast<MemoryManager*>(this)->allocate_no_tiny_pool(bytes, obj_size, align, is_small);
+		}
+		ALLOCATOR_INLINE void BaseMemoryManager::deallocate_no_tiny_pool(void* p) noexcept { static_cast<MemoryManager*>(this)->deallocate_no_tiny_pool(p); }
 	}
 }
 
@@ -48,6 +48,7 @@
 #define MICRO_MAX_ARENAS 128u
 #define MICRO_TINY_POOL_CACHE 2
 #define MICRO_DEPLETE_ARENA_FACTOR 4
+#define MICRO_DEFAULT_PAD_LOCKS 1
 
 #elif MICRO_MEMORY_LEVEL == 3
 
@@ -58,6 +59,7 @@
 #define MICRO_MAX_ARENAS 64u
 #define MICRO_TINY_POOL_CACHE 0
 #define MICRO_DEPLETE_ARENA_FACTOR 2
+#define MICRO_DEFAULT_PAD_LOCKS 1
 
 #elif MICRO_MEMORY_LEVEL == 2
 
@@ -68,6 +70,7 @@
 #define MICRO_MAX_ARENAS 32u
 #define MICRO_TINY_POOL_CACHE 0
 #define MICRO_DEPLETE_ARENA_FACTOR 1
+#define MICRO_DEFAULT_PAD_LOCKS 1
 
 #elif MICRO_MEMORY_LEVEL == 1
 
@@ -78,6 +81,7 @@
 #define MICRO_MAX_ARENAS 16u
 #define MICRO_TINY_POOL_CACHE 0
 #define MICRO_DEPLETE_ARENA_FACTOR 1
+#define MICRO_DEFAULT_PAD_LOCKS 0
 
 #elif MICRO_MEMORY_LEVEL == 0
 
@@ -89,11 +93,30 @@
 #define MICRO_MAX_ARENAS 4u
 #define MICRO_TINY_POOL_CACHE 0
 #define MICRO_DEPLETE_ARENA_FACTOR 1
+#define MICRO_DEFAULT_PAD_LOCKS 0
 
 #endif
 
 #define MICRO_MAX_SMALL_ALLOC_THRESHOLD MICRO_MAX_SMALL_SIZE
 
+// Cache line size, used to avoid false sharing
+#ifndef MICRO_CACHE_LINE_SIZE
+#define MICRO_CACHE_LINE_SIZE 64
+#endif
+
+// Cache line aware layout of the locks accessed concurrently by different size classes:
+// radix tree leaf locks are striped across cache lines, and TinyMemPool size classes
+// are padded to a cache line. Enabled by default for memory levels >= 2.
+#ifndef MICRO_PAD_LOCKS
+#define MICRO_PAD_LOCKS MICRO_DEFAULT_PAD_LOCKS
+#endif
+
+#if MICRO_PAD_LOCKS
+#define MICRO_CACHE_ALIGNED alignas(MICRO_CACHE_LINE_SIZE)
+#else
+#define MICRO_CACHE_ALIGNED
+#endif
+
 // Minimum/maximum supported page size
 #define MICRO_MINIMUM_PAGE_SIZE MICRO_DEFAULT_PAGE_SIZE
 #define MICRO_MAXIMUM_PAGE_SIZE 65536
@@ -123,6 +146,88 @@
 // Minimum alignment for small allocations (and for the micro library in general)
 #define MICRO_MINIMUM_ALIGNMENT 16
 
+// Maximum number of NUMA nodes handled by the NUMA mode (see parameters::numa)
+#ifndef MICRO_MAX_NUMA_NODES
+#define MICRO_MAX_NUMA_NODES 8
+#endif
+
+// Background purge (if enabled with purge_decay_ms): number of epochs of the decay time
+#ifndef MICRO_PURGE_EPOCHS
+#define MICRO_PURGE_EPOCHS 10
+#endif
+
+// OS page provider: maximum number of released page runs kept for reuse (if decommit is not MicroDecommitDontNeed)
+#ifndef MICRO_DECOMMIT_CACHE_RUNS
+#define MICRO_DECOMMIT_CACHE_RUNS 32
+#endif
+
+// OS page provider: huge pages backing page runs of whole huge pages (see micro_huge_pages_type).
+// Transparent huge pages by default for memory level 4, as all page runs are 2MB.
+#ifndef MICRO_DEFAULT_HUGE_PAGES
+#if MICRO_MEMORY_LEVEL == 4
+#define MICRO_DEFAULT_HUGE_PAGES 1
+#else
+#define MICRO_DEFAULT_HUGE_PAGES 0
+#endif
+#endif
+
+// OS reserve page provider: default size of the reserved address range (if page_memory_size is 0)
+#ifndef MICRO_DEFAULT_RESERVE_SIZE
+#ifdef MICRO_ARCH_64
+#define MICRO_DEFAULT_RESERVE_SIZE (1ull << 36)
+#else
+#define MICRO_DEFAULT_RESERVE_SIZE (1ull << 28)
+#endif
+#endif
+
+// Persistent file heaps (MicroPersistent): bytes reserved in the file header to save the memory manager state
+#ifndef MICRO_PERSISTENT_AREA_SIZE
+#define MICRO_PERSISTENT_AREA_SIZE 2048
+#endif
+
+// Persistent file heaps: maximum number of file extensions (each one is mapped at its own address)
+#ifndef MICRO_MAX_PERSISTENT_VIEWS
+#define MICRO_MAX_PERSISTENT_VIEWS 64
+#endif
+
+// Persistent file heaps: tag identifying a valid file header or memory manager state
+#define MICRO_PERSISTENT_MAGIC 0x6D6963726F506572ull
+
+// Shared heaps (see micro_heap_create_shared()): maximum number of shared heaps mapped by a process
+#ifndef MICRO_MAX_SHARED_HEAPS
+#define MICRO_MAX_SHARED_HEAPS 16
+#endif
+
+// Shared heaps: tag identifying a valid shared heap file
+#define MICRO_SHARED_MAGIC 0x6D6963726F536861ull
+
+// Shared heaps: version of the shared heap layout, combined with the structure sizes to check
+// that the attaching process uses a compatible build
+#define MICRO_SHARED_VERSION 1u
+
+// Preallocated pages (MicroPreallocParallel): maximum number of threads faulting in the pages
+#ifndef MICRO_MAX_POPULATE_THREADS
+#define MICRO_MAX_POPULATE_THREADS 16
+#endif
+
+// Preallocated pages (MicroPreallocParallel): minimum bytes faulted in by each thread
+#ifndef MICRO_POPULATE_THREAD_BYTES
+#define MICRO_POPULATE_THREAD_BYTES (64ull * 1024ull * 1024ull)
+#endif
+
+// Tag stored in free medium chunks whose interior pages were decommitted (see parameters::decommit_threshold)
+#define MICRO_DECOMMIT_TAG 0x6D6963726F446563ull
+
+// Thread cache (if enabled with thread_cache_bytes): objects per size class magazine
+#ifndef MICRO_THREAD_CACHE_OBJECTS
+#define MICRO_THREAD_CACHE_OBJECTS 16
+#endif
+
+// Thread cache: bytes reserved at once from the global thread cache budget
+#ifndef MICRO_THREAD_CACHE_RESERVE
+#define MICRO_THREAD_CACHE_RESERVE 16384
+#endif
+
 // Disable lock
 #ifdef MICRO_NO_LOCK
 #undef MICRO_MAX_ARENAS
@@ -218,6 +218,15 @@ namespace micro
 			MICRO_ALWAYS_INLINE MediumChunkHeader* next() noexcept { return links()->next; }
 			MICRO_ALWAYS_INLINE void set_prev(MediumChunkHeader* p) noexcept { links()->prev = p; }
 			MICRO_ALWAYS_INLINE void set_next(MediumChunkHeader* n) noexcept { links()->next = n; }
+
+			// For free chunks of at least 2 elements, a tag stored after the Links
+			// tells if the whole pages of the chunk interior were decommitted.
+			MICRO_ALWAYS_INLINE bool decommitted() noexcept { return elems >= 2u && *reinterpret_cast<std::uint64_t*>(links() + 1) == MICRO_DECOMMIT_TAG; }
+			MICRO_ALWAYS_INLINE void set_decommitted(bool d) noexcept
+			{
+				if (elems >= 2u)
+					*reinterpret_cast<std::uint64_t*>(links() + 1) = d ? MICRO_DECOMMIT_TAG : 0ull;
+			}
 		};
 
 		/// @brief Header structure for page runs (multiple contiguous pages)
@@ -242,6 +251,12 @@ namespace micro
 
 			shared_spinlock lock;
 
+			// NUMA node the pages were bound to (NUMA mode only)
+			std::uint16_t numa_node;
+
+			// Non zero if the run was registered in the page map when its persistent heap was closed
+			std::uint16_t indexed;
+
 			// Location of tiny pools,
 			// Use to remove ambiguities on deallocation
 
@@ -326,6 +341,11 @@ namespace micro
 		/// @brief Base memory manager class, inherited by MemoryManager.
 		/// Used to pass BaseMemoryManager pointers to classes that do
 		/// not need to know the full MemoryManager implementation.
+		///
+		/// BaseMemoryManager is not polymorphic: its members forward to the MemoryManager
+		/// ones (see allocator.hpp). A shared heap (see micro_heap_create_shared()) lives in
+		/// a mapping used by several processes, where a virtual table pointer would only be
+		/// valid in the process that created the heap.
 		class MICRO_EXPORT_HEADER BaseMemoryManager : public BaseMemoryManagerIter
 		{
 		protected:
@@ -404,15 +424,22 @@ namespace micro
 				if (parms.provider_type == MicroFileProvider)
 					provider.setFileProvider(parms.page_size, parms.grow_factor, parms.page_file_provider.data(), parms.page_memory_size, parms.page_file_flags);
 				else
+#endif
+#ifdef MICRO_HAS_MEMFD
+				  if (parms.provider_type == MicroMemfdProvider)
+					provider.setMemfdProvider(parms.page_size, parms.grow_factor, parms.page_memory_size, parms.page_file_flags);
+				else
 #endif
 				  if (parms.provider_type == MicroMemProvider)
 					provider.setMemoryProvider(parms.page_size, parms.allow_os_page_alloc, parms.page_memory_provider, static_cast<std::uintptr_t>(parms.page_memory_size));
 				else if (parms.provider_type == MicroOSPreallocProvider)
 					provider.setPreallocatedPageProvider(static_cast<size_t>(parms.page_memory_size), parms.allow_os_page_alloc);
+				else if (parms.provider_type == MicroOSReserveProvider)
+					provider.setReservePageProvider(static_cast<size_t>(parms.page_memory_size), parms.allow_os_page_alloc);
 
 				insert_manager(this);
 			}
-			virtual ~BaseMemoryManager() noexcept { remove_manager(this); }
+			~BaseMemoryManager() noexcept { remove_manager(this); }
 
 			MICRO_DELETE_COPY(BaseMemoryManager)
 
@@ -420,8 +447,8 @@ namespace micro
 			MICRO_ALWAYS_INLINE const parameters& params() const noexcept { return parms; }
 
 			/// @brief Returns the internal page provider
-			MICRO_ALWAYS_INLINE BasePageProvider* page_provider() noexcept { return &provider; }
-			MICRO_ALWAYS_INLINE const BasePageProvider* page_provider() const noexcept { return &provider; }
+			MICRO_ALWAYS_INLINE GenericPageProvider* page_provider() noexcept { return &provider; }
+			MICRO_ALWAYS_INLINE const GenericPageProvider* page_provider() const noexcept { return &provider; }
 
 			/// @brief Returns provider page size
 			MICRO_ALWAYS_INLINE size_t page_size() const noexcept { return provider.page_size(); }
@@ -435,27 +462,27 @@ namespace micro
 
 			/// @brief Clear the manager.
 			/// Deallocate all pages and reset the manager state.
-			virtual void clear() noexcept = 0;
+			void clear() noexcept;
 
 			/// @brief Allocate page_count pages.
 			/// The amount of allocated page might be greater than page_count depending on the allocation granularity.
-			virtual PageRunHeader* allocate_pages(size_t page_count) noexcept = 0;
+			PageRunHeader* allocate_pages(size_t page_count) noexcept;
 			/// @brief Allocate enough pages to hold given amount of bytes
-			virtual PageRunHeader* allocate_pages_for_bytes(size_t bytes) noexcept = 0;
-			/// @brief Allocate a page run suitable for the radix tree (size MICRO_BLOCK_SIZE)
-			virtual PageRunHeader* allocate_medium_block() noexcept = 0;
+			PageRunHeader* allocate_pages_for_bytes(size_t bytes) noexcept;
+			/// @brief Allocate a page run suitable for the radix tree (size MICRO_BLOCK_SIZE) for an arena of given NUMA node
+			PageRunHeader* allocate_medium_block(unsigned numa_node) noexcept;
 			/// @brief Deallocate page run
-			virtual void deallocate_pages(PageRunHeader* p) noexcept = 0;
+			void deallocate_pages(PageRunHeader* p) noexcept;
 
 			/// @brief Allocate size bytes using internal memory pool.
 			/// This allocation will never be deallocated except in clear() and destructor.
-			virtual void* allocate_and_forget(unsigned size) noexcept = 0;
+			void* allocate_and_forget(unsigned size) noexcept;
 
 			/// @brief Allocate given amount of bytes with provided alignment.
 			/// Must use the radix tree ONLY. This function is used by TinyMemPool to allocate
 			/// blocks dedicated to small objects.
-			virtual void* allocate_no_tiny_pool(size_t bytes, unsigned obj_size, unsigned align, bool* is_small) noexcept = 0;
-			virtual void deallocate_no_tiny_pool(void*) noexcept = 0;
+			void* allocate_no_tiny_pool(size_t bytes, unsigned obj_size, unsigned align, bool* is_small) noexcept;
+			void deallocate_no_tiny_pool(void*) noexcept;
 		};
 
 	}
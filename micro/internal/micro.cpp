@@ -109,6 +109,8 @@ namespace micro
 			static heap _h{ get_process_parameters() };
 			heap* h = &_h;
 #endif
+			// Only the process heap is the main manager (recursion detection, proxy ownership)
+			h->set_main();
 			MICRO_POP_DISABLE_EXIT_TIME_DESTRUCTOR
 			return h;
 
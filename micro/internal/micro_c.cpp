@@ -66,6 +66,21 @@ MICRO_HEADER_ONLY_EXPORT_FUNCTION void micro_free(void* p) MICRO_THROW
 	micro::detail::MemoryManager::deallocate(p);
 }
 
+MICRO_HEADER_ONLY_EXPORT_FUNCTION void micro_free_sized(void* p, size_t size) MICRO_THROW
+{
+	micro::detail::MemoryManager::deallocate_sized(p, size);
+}
+
+MICRO_HEADER_ONLY_EXPORT_FUNCTION size_t micro_malloc_batch(size_t size, size_t count, void** out) MICRO_THROW
+{
+	return micro::get_process_heap().allocate_batch(size, count, out);
+}
+
+MICRO_HEADER_ONLY_EXPORT_FUNCTION void micro_free_batch(void** ptrs, size_t count) MICRO_THROW
+{
+	micro::detail::MemoryManager::deallocate_batch(ptrs, count);
+}
+
 MICRO_HEADER_ONLY_EXPORT_FUNCTION void* micro_memalign(size_t alignment, size_t size) MICRO_THROW
 {
 	return micro::get_process_heap().aligned_allocate(alignment, size);
@@ -76,10 +91,15 @@ MICRO_HEADER_ONLY_EXPORT_FUNCTION void* micro_realloc(void* ptr, size_t size) MI
 	if (!ptr)
 		return micro_malloc(size);
 
+	// Do not shrink by less than half
 	size_t usable = micro_usable_size(ptr);
-	if (size <= usable)
+	if (size <= usable && size > usable / 2)
 		return ptr;
 
+	// Try to grow/shrink in place (or remap big chunks)
+	if (void* r = micro::heap::try_reallocate(ptr, size))
+		return r;
+
 	void* _new = micro_malloc(size);
 	if (!_new)
 		return nullptr;
@@ -97,7 +117,7 @@ MICRO_HEADER_ONLY_EXPORT_FUNCTION void* micro_aligned_realloc(void* ptr, size_t
 		return nullptr;
 	MICRO_ASSERT_DEBUG((static_cast<uintptr_t>(alignment - 1) & reinterpret_cast<uintptr_t> (ptr)) == 0, "");
 	size_t usable = micro_usable_size(ptr);
-	if (size <= usable)
+	if ((size <= usable && size > usable / 2) || micro::heap::resize_in_place(ptr, size))
 		return ptr;
 
 	void* _new = micro_memalign(alignment, size);
@@ -115,8 +135,10 @@ MICRO_HEADER_ONLY_EXPORT_FUNCTION void* micro_reallocf(void* ptr, size_t size) M
 		return micro_malloc(size);
 
 	size_t usable = micro_usable_size(ptr);
-	if (size <= usable)
+	if (size <= usable && size > usable / 2)
 		return ptr;
+	if (void* r = micro::heap::try_reallocate(ptr, size))
+		return r;
 
 	void* _new = micro_malloc(size);
 	if (!_new) {
@@ -168,8 +190,8 @@ MICRO_HEADER_ONLY_EXPORT_FUNCTION void* micro_expand(void* ptr, size_t size) MIC
 	if (!ptr)
 		return nullptr;
 
-	size_t usable = micro_usable_size(ptr);
-	if (size <= usable)
+	// Grow or shrink without moving the chunk
+	if (micro::heap::resize_in_place(ptr, size))
 		return ptr;
 	return nullptr;
 }
@@ -258,6 +280,11 @@ MICRO_HEADER_ONLY_EXPORT_FUNCTION void micro_clear() MICRO_THROW
 	micro::get_process_heap().clear();
 }
 
+MICRO_HEADER_ONLY_EXPORT_FUNCTION size_t micro_trim(size_t pad) MICRO_THROW
+{
+	return micro::get_process_heap().trim(pad);
+}
+
 namespace micro
 {
 	namespace detail
@@ -293,6 +320,33 @@ namespace micro
 				case MicroBackendMemory:
 					h.backend_memory = (value);
 					break;
+				case MicroThreadCacheBytes:
+					h.thread_cache_bytes = (value);
+					break;
+				case MicroArenaPerCpu:
+					h.arena_per_cpu = bool(value);
+					break;
+				case MicroNuma:
+					h.numa = bool(value);
+					break;
+				case MicroRemoteFree:
+					h.remote_free = bool(value);
+					break;
+				case MicroPurgeDecayMs:
+					h.purge_decay_ms = unsigned(value);
+					break;
+				case MicroDecommit:
+					h.decommit = unsigned(value);
+					break;
+				case MicroDecommitThreshold:
+					h.decommit_threshold = (value);
+					break;
+				case MicroPreallocFlags:
+					h.prealloc_flags = unsigned(value);
+					break;
+				case MicroHugePages:
+					h.huge_pages = unsigned(value);
+					break;
 				case MicroLogLevel:
 					h.log_level = unsigned(value);
 					break;
@@ -349,6 +403,24 @@ namespace micro
 					return h.memory_limit;
 				case MicroBackendMemory:
 					return h.backend_memory;
+				case MicroThreadCacheBytes:
+					return h.thread_cache_bytes;
+				case MicroArenaPerCpu:
+					return h.arena_per_cpu;
+				case MicroNuma:
+					return h.numa;
+				case MicroRemoteFree:
+					return h.remote_free;
+				case MicroPurgeDecayMs:
+					return h.purge_decay_ms;
+				case MicroDecommit:
+					return h.decommit;
+				case MicroDecommitThreshold:
+					return h.decommit_threshold;
+				case MicroPreallocFlags:
+					return h.prealloc_flags;
+				case MicroHugePages:
+					return h.huge_pages;
 				case MicroLogLevel:
 					return h.log_level;
 				case MicroPageSize:
@@ -417,6 +489,15 @@ namespace micro
 				case MicroPrintStatsMs:
 				case MicroPrintStatsBytes:
 				case MicroDepleteArenas:
+				case MicroThreadCacheBytes:
+				case MicroArenaPerCpu:
+				case MicroNuma:
+				case MicroRemoteFree:
+				case MicroPurgeDecayMs:
+				case MicroDecommit:
+				case MicroDecommitThreshold:
+				case MicroPreallocFlags:
+				case MicroHugePages:
 					MICRO_ASSERT(false, "wrong parameter type");
 					break;
 			}
@@ -451,6 +532,15 @@ namespace micro
 				case MicroPrintStatsMs:
 				case MicroPrintStatsBytes:
 				case MicroDepleteArenas:
+				case MicroThreadCacheBytes:
+				case MicroArenaPerCpu:
+				case MicroNuma:
+				case MicroRemoteFree:
+				case MicroPurgeDecayMs:
+				case MicroDecommit:
+				case MicroDecommitThreshold:
+				case MicroPreallocFlags:
+				case MicroHugePages:
 					MICRO_ASSERT(false, "wrong parameter type");
 					return nullptr;
 			}
@@ -478,17 +568,199 @@ MICRO_HEADER_ONLY_EXPORT_FUNCTION const char* micro_get_string_parameter(micro_p
 	return micro::detail::get_string_parameter(micro::get_process_parameters(), p);
 }
 
+#ifndef MICRO_NO_FILE_MAPPING
 namespace micro
 {
+	namespace detail
+	{
+		/// @brief Header of a shared heap file, followed by the heap_t object and the pages.
+		/// Only stores offsets from the mapping base, and the address the file must be mapped at.
+		struct alignas(64) SharedHeapHeader
+		{
+			std::uint64_t magic;	    // MICRO_SHARED_MAGIC once the heap is initialized
+			std::uint64_t abi;	    // shared_heap_abi() of the creating process
+			std::uint64_t size;	    // file size
+			std::uint64_t address;	    // mapping address, identical in all processes
+			std::uint64_t heap_offset;  // offset of the heap_t object
+			std::uint64_t pages_offset; // offset of the pages
+		};
+		static constexpr size_t shared_heap_offset = (sizeof(SharedHeapHeader) + alignof(heap_t) - 1u) / alignof(heap_t) * alignof(heap_t);
+
+		// Objects of a shared heap are used by several processes: no virtual table pointer allowed
+		static_assert(!std::is_polymorphic<heap>::value && !std::is_polymorphic<MemoryManager>::value && !std::is_polymorphic<GenericPageProvider>::value,
+			      "shared heap objects must not be polymorphic");
+
+		/// @brief Returns the ABI tag of shared heaps, identical for all processes using a compatible build:
+		/// the layout version combined with the size of the structures stored in the mapping.
+		static inline std::uint64_t shared_heap_abi() noexcept
+		{
+			const std::uint64_t sizes[] = { sizeof(void*), sizeof(SharedHeapHeader), sizeof(heap_t), sizeof(parameters), sizeof(PageRunHeader), sizeof(Arena), os_page_size() };
+			std::uint64_t abi = MICRO_SHARED_VERSION;
+			for (std::uint64_t s : sizes)
+				abi = (abi ^ s) * 0x100000001B3ull; // FNV-1a step
+			return abi;
+		}
 
+		/// @brief Shared heap file mapped by the current process
+		struct SharedMapping
+		{
+			heap_t* heap{ nullptr };
+			memory_map_file file;
+			memory_map_file_view view;
+		};
+
+		/// @brief Returns the shared heaps mapped by the current process.
+		/// Never destroyed, as chunks might be deallocated during static destruction.
+		MICRO_HEADER_ONLY_EXPORT_FUNCTION SharedMapping* shared_mappings() noexcept
+		{
+			alignas(SharedMapping) static char storage[sizeof(SharedMapping) * MICRO_MAX_SHARED_HEAPS];
+			static SharedMapping* mappings = []() {
+				SharedMapping* m = reinterpret_cast<SharedMapping*>(storage);
+				for (unsigned i = 0; i < MICRO_MAX_SHARED_HEAPS; ++i)
+					new (m + i) SharedMapping();
+				return m;
+			}();
+			return mappings;
+		}
+		MICRO_HEADER_ONLY_EXPORT_FUNCTION spinlock& shared_mappings_lock() noexcept
+		{
+			static spinlock lock;
+			return lock;
+		}
+		static inline SharedMapping* find_mapping(heap_t* h) noexcept
+		{
+			SharedMapping* m = shared_mappings();
+			for (unsigned i = 0; i < MICRO_MAX_SHARED_HEAPS; ++i)
+				if (m[i].heap == h)
+					return m + i;
+			return nullptr;
+		}
+		static inline void release_mapping(SharedMapping* m) noexcept
+		{
+			m->heap = nullptr;
+			m->view = memory_map_file_view{};
+			m->file.init(nullptr, 0);
+		}
+	}
 }
+#endif
+
+MICRO_HEADER_ONLY_EXPORT_FUNCTION micro_heap* micro_heap_create_shared(const char* filename, uint64_t bytes) MICRO_THROW
+{
+#ifndef MICRO_NO_FILE_MAPPING
+	using namespace micro;
+	using namespace micro::detail;
+	const size_t pages_offset = (shared_heap_offset + sizeof(heap_t) + os_page_size() - 1u) / os_page_size() * os_page_size();
+	if (!filename || bytes <= pages_offset)
+		return nullptr;
+
+	std::lock_guard<spinlock> ll(shared_mappings_lock());
+	SharedMapping* m = find_mapping(nullptr);
+	if (!m)
+		return nullptr;
+	m->view = m->file.init(filename, bytes);
+	if (m->view.null()) {
+		release_mapping(m);
+		return nullptr;
+	}
+
+	char* base = static_cast<char*>(m->view.view_ptr());
+	SharedHeapHeader* header = reinterpret_cast<SharedHeapHeader*>(base);
+	heap_t* h = heap_t::from(base + shared_heap_offset);
+	new (&h->init) std::atomic<bool>{ false };
+	new (&h->p) parameters(parameters::from_env());
+
+	// All pages come from the file, and process local features are disabled
+	h->p.provider_type = MicroMemProvider;
+	h->p.page_memory_provider = base + pages_offset;
+	h->p.page_memory_size = m->view.view_size() - pages_offset;
+	h->p.allow_os_page_alloc = false;
+	h->p.thread_cache_bytes = 0;
+	h->p.purge_decay_ms = 0;
+	h->p.numa = false;
+	h->p.print_stats[0] = 0;
+	h->p.print_stats_trigger = 0;
+
+	init_heap(h);
+	if (!h->h.set_shared()) {
+		h->h.~heap();
+		release_mapping(m);
+		return nullptr;
+	}
+
+	header->abi = shared_heap_abi();
+	header->size = m->file.file_size();
+	header->address = reinterpret_cast<std::uintptr_t>(base);
+	header->heap_offset = shared_heap_offset;
+	header->pages_offset = pages_offset;
+	std::atomic_thread_fence(std::memory_order_release);
+	header->magic = MICRO_SHARED_MAGIC;
+
+	m->heap = h;
+	return reinterpret_cast<micro_heap*>(h);
+#else
+	(void)filename;
+	(void)bytes;
+	return nullptr;
+#endif
+}
+
+MICRO_HEADER_ONLY_EXPORT_FUNCTION micro_heap* micro_heap_attach(const char* filename) MICRO_THROW
+{
+#ifndef MICRO_NO_FILE_MAPPING
+	using namespace micro;
+	using namespace micro::detail;
+	if (!filename)
+		return nullptr;
+
+	std::lock_guard<spinlock> ll(shared_mappings_lock());
+	SharedMapping* m = find_mapping(nullptr);
+	if (!m)
+		return nullptr;
+
+	std::uint64_t size = 0;
+	SharedHeapHeader header;
+	if (!m->file.open(filename, &size) || size < sizeof(header) || !m->file.read(&header, sizeof(header)) || header.magic != MICRO_SHARED_MAGIC ||
+	    header.abi != shared_heap_abi() || header.size != size || header.heap_offset + sizeof(heap_t) > header.pages_offset || header.pages_offset >= size) {
+		release_mapping(m);
+		return nullptr;
+	}
+	void* address = reinterpret_cast<void*>(static_cast<std::uintptr_t>(header.address));
+
+	// Already mapped by this process, for instance inherited from the parent process
+	SharedMapping* all = shared_mappings();
+	for (unsigned i = 0; i < MICRO_MAX_SHARED_HEAPS; ++i) {
+		if (all[i].heap && all[i].view.view_ptr() == address) {
+			release_mapping(m);
+			return reinterpret_cast<micro_heap*>(all[i].heap);
+		}
+	}
+
+	// Page runs and internal links are absolute addresses: the file is mapped at the same address
+	// as in the creating process, and attaching fails if this address range is already in use
+	m->view = m->file.extend(size, address);
+	if (m->view.null()) {
+		release_mapping(m);
+		return nullptr;
+	}
+	heap_t* h = heap_t::from(static_cast<char*>(address) + header.heap_offset);
+	if (!h->h.attach_shared()) {
+		release_mapping(m);
+		return nullptr;
+	}
+	m->heap = h;
+	return reinterpret_cast<micro_heap*>(h);
+#else
+	(void)filename;
+	return nullptr;
+#endif
+}
+
 MICRO_HEADER_ONLY_EXPORT_FUNCTION micro_heap* micro_heap_create() MICRO_THROW
 {
 	using namespace micro;
 	unsigned s = sizeof(detail::heap_t);
-	unsigned pcount = s / static_cast<unsigned>(os_page_size());
-	if (pcount == 0)
-		pcount = 1;
+	unsigned pcount = (s + static_cast<unsigned>(os_page_size()) - 1u) / static_cast<unsigned>(os_page_size());
 	detail::heap_t* h = detail::heap_t::from(os_allocate_pages(pcount));
 	if (!h)
 		return nullptr;
@@ -500,12 +772,21 @@ MICRO_HEADER_ONLY_EXPORT_FUNCTION void micro_heap_destroy(micro_heap* h) MICRO_T
 {
 	using namespace micro;
 	auto* heap = detail::heap_t::from(h);
+#ifndef MICRO_NO_FILE_MAPPING
+	if (heap->init.load() && heap->h.is_shared()) {
+		// Only detach the shared heap from this process
+		std::lock_guard<spinlock> ll(detail::shared_mappings_lock());
+		if (detail::SharedMapping* m = detail::find_mapping(heap)) {
+			heap->h.detach_shared();
+			detail::release_mapping(m);
+		}
+		return;
+	}
+#endif
 	if (heap->init.load()) {
 		heap->h.~heap();
 	}
-	unsigned pcount = sizeof(detail::heap_t) / static_cast<unsigned>(micro::os_page_size());
-	if (pcount == 0)
-		pcount = 1;
+	unsigned pcount = (static_cast<unsigned>(sizeof(detail::heap_t)) + static_cast<unsigned>(micro::os_page_size()) - 1u) / static_cast<unsigned>(micro::os_page_size());
 	os_free_pages(h, pcount);
 }
 
@@ -517,6 +798,36 @@ MICRO_HEADER_ONLY_EXPORT_FUNCTION void micro_heap_clear(micro_heap* h) MICRO_THR
 		heap->h.clear();
 }
 
+MICRO_HEADER_ONLY_EXPORT_FUNCTION size_t micro_heap_trim(micro_heap* h, size_t pad) MICRO_THROW
+{
+	using namespace micro;
+	auto* heap = detail::heap_t::from(h);
+	if (heap->init.load())
+		return heap->h.trim(pad);
+	return 0;
+}
+
+MICRO_HEADER_ONLY_EXPORT_FUNCTION int micro_heap_file_descriptor(micro_heap* h) MICRO_THROW
+{
+	using namespace micro;
+	auto* heap = detail::init_heap(h);
+	return heap->h.file_descriptor();
+}
+
+MICRO_HEADER_ONLY_EXPORT_FUNCTION void micro_heap_set_root(micro_heap* h, void* root) MICRO_THROW
+{
+	using namespace micro;
+	auto* heap = detail::init_heap(h);
+	heap->h.set_root(root);
+}
+
+MICRO_HEADER_ONLY_EXPORT_FUNCTION void* micro_heap_get_root(micro_heap* h) MICRO_THROW
+{
+	using namespace micro;
+	auto* heap = detail::init_heap(h);
+	return heap->h.root();
+}
+
 MICRO_HEADER_ONLY_EXPORT_FUNCTION void micro_heap_set_parameter(micro_heap* h, micro_parameter p, uint64_t value) MICRO_THROW
 {
 	using namespace micro;
@@ -558,8 +869,10 @@ MICRO_HEADER_ONLY_EXPORT_FUNCTION void* micro_heap_realloc(micro_heap* h, void*
 		return heap->h.allocate(size);
 
 	size_t usable = heap->h.usable_size(ptr);
-	if (size < usable)
+	if (size <= usable && size > usable / 2)
 		return ptr;
+	if (void* r = heap->h.try_reallocate(ptr, size))
+		return r;
 
 	void* _new = heap->h.allocate(size);
 	if (!_new)
@@ -579,6 +892,24 @@ MICRO_HEADER_ONLY_EXPORT_FUNCTION void* micro_heap_calloc(micro_heap* h, size_t
 	return p;
 }
 
+MICRO_HEADER_ONLY_EXPORT_FUNCTION void micro_heap_free_sized(micro_heap* h, void* ptr, size_t size) MICRO_THROW
+{
+	(void)h;
+	micro::heap::deallocate_sized(ptr, size);
+}
+
+MICRO_HEADER_ONLY_EXPORT_FUNCTION size_t micro_heap_malloc_batch(micro_heap* h, size_t size, size_t count, void** out) MICRO_THROW
+{
+	using namespace micro;
+	auto* heap = detail::init_heap(h);
+	return heap->h.allocate_batch(size, count, out);
+}
+MICRO_HEADER_ONLY_EXPORT_FUNCTION void micro_heap_free_batch(micro_heap* h, void** ptrs, size_t count) MICRO_THROW
+{
+	(void)h;
+	micro::heap::deallocate_batch(ptrs, count);
+}
+
 MICRO_HEADER_ONLY_EXPORT_FUNCTION void micro_heap_dump_stats(micro_heap* h, micro_statistics* stats) MICRO_THROW
 {
 	using namespace micro;
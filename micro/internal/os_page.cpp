@@ -37,6 +37,20 @@ extern "C" {
 
 MICRO_PUSH_DISABLE_OLD_STYLE_CAST
 
+namespace micro
+{
+	namespace detail
+	{
+		/// @brief Fault in len bytes by writing back the first byte of each page
+		static inline void touch_pages(void* p, size_t len, size_t psize) noexcept
+		{
+			volatile char* c = static_cast<char*>(p);
+			for (size_t i = 0; i < len; i += psize)
+				c[i] = c[i];
+		}
+	}
+}
+
 #if defined(_WIN32)
 
 namespace micro
@@ -75,6 +89,104 @@ namespace micro
 		return r != 0;
 	}
 
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION bool os_reset_pages(void* p, size_t pages) noexcept
+	{
+		return VirtualAlloc(p, pages * os_page_size(), MEM_RESET, PAGE_READWRITE) != nullptr;
+	}
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION bool os_decommit_pages(void* p, size_t pages) noexcept
+	{
+		// MEM_DECOMMIT would require an explicit commit before the next access
+		return os_reset_pages(p, pages);
+	}
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION void* os_reserve_pages(size_t pages) noexcept
+	{
+		// Only aligned on the allocation granularity
+		return VirtualAlloc(nullptr, pages * os_page_size(), MEM_RESERVE, PAGE_NOACCESS);
+	}
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION bool os_commit_pages(void* p, size_t pages) noexcept
+	{
+		return VirtualAlloc(p, pages * os_page_size(), MEM_COMMIT, PAGE_READWRITE) != nullptr;
+	}
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION bool os_uncommit_pages(void* p, size_t pages) noexcept
+	{
+		return VirtualFree(p, pages * os_page_size(), MEM_DECOMMIT) != 0;
+	}
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION bool os_release_pages(void* p, size_t) noexcept { return VirtualFree(p, 0, MEM_RELEASE) != 0; }
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION void* os_remap_pages(void*, size_t, size_t) noexcept
+	{
+		// Not supported
+		return nullptr;
+	}
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION size_t os_huge_page_size() noexcept { return GetLargePageMinimum(); }
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION void* os_allocate_huge_pages(size_t pages) noexcept
+	{
+		// Requires the SeLockMemoryPrivilege
+		size_t len = pages * os_page_size();
+		size_t hsize = os_huge_page_size();
+		if (hsize == 0 || len % hsize)
+			return nullptr;
+		return VirtualAlloc(nullptr, len, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+	}
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION void* os_allocate_aligned_pages(size_t pages, size_t alignment) noexcept
+	{
+		size_t len = pages * os_page_size();
+		if (alignment <= os_allocation_granularity())
+			return os_allocate_pages(pages);
+		// Reserve a larger range to find an aligned address, release it and allocate at this address.
+		// Another thread might grab the address in between, so retry a few times.
+		for (int i = 0; i < 4; ++i) {
+			void* m = VirtualAlloc(nullptr, len + alignment, MEM_RESERVE, PAGE_NOACCESS);
+			if (!m)
+				return nullptr;
+			void* p = (void*)(((uintptr_t)m + alignment - 1) & ~(uintptr_t)(alignment - 1));
+			VirtualFree(m, 0, MEM_RELEASE);
+			if (void* r = VirtualAlloc(p, len, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE))
+				return r;
+		}
+		return nullptr;
+	}
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION bool os_advise_huge_pages(void*, size_t) noexcept
+	{
+		// Not supported
+		return false;
+	}
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION void os_populate_pages(void* p, size_t pages) noexcept { detail::touch_pages(p, pages * os_page_size(), os_page_size()); }
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION bool os_lock_pages(void* p, size_t pages) noexcept { return VirtualLock(p, pages * os_page_size()) != 0; }
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION unsigned os_numa_node_count() noexcept
+	{
+		ULONG highest = 0;
+		if (!GetNumaHighestNodeNumber(&highest))
+			return 1;
+		return static_cast<unsigned>(highest) + 1u;
+	}
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION unsigned os_current_numa_node() noexcept
+	{
+		UCHAR node = 0;
+		if (!GetNumaProcessorNode(static_cast<UCHAR>(GetCurrentProcessorNumber()), &node) || node == 0xFF)
+			return 0;
+		return node;
+	}
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION bool os_bind_pages(void*, size_t, unsigned) noexcept
+	{
+		// Not supported: the node must be given to VirtualAllocExNuma() on allocation
+		return false;
+	}
+
 	MICRO_HEADER_ONLY_EXPORT_FUNCTION bool os_process_infos(micro_process_infos& infos) noexcept
 	{
 		struct Init
@@ -133,6 +245,7 @@ extern "C" {
 #if defined(__linux__)
 #include <fcntl.h>
 #include <features.h>
+#include <sched.h> // getcpu
 #if defined(__GLIBC__)
 #include <linux/mman.h> // linux mmap flags
 #else
@@ -206,6 +319,223 @@ namespace micro
 		return (munmap(p, pages * os_page_size()) != -1);
 	}
 
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION bool os_reset_pages(void* p, size_t pages) noexcept
+	{
+#ifdef MADV_FREE
+		// MADV_FREE is not supported before Linux 4.5
+		if (unix_madvise(p, pages * os_page_size(), MADV_FREE) == 0)
+			return true;
+#endif
+		return unix_madvise(p, pages * os_page_size(), MADV_DONTNEED) == 0;
+	}
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION bool os_decommit_pages(void* p, size_t pages) noexcept { return unix_madvise(p, pages * os_page_size(), MADV_DONTNEED) == 0; }
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION void* os_reserve_pages(size_t pages) noexcept
+	{
+		// Reserve more than requested, and trim both sides to align the range on MICRO_BLOCK_SIZE
+		size_t len = pages * os_page_size();
+		size_t extra = MICRO_BLOCK_SIZE > os_page_size() ? MICRO_BLOCK_SIZE - os_page_size() : 0;
+		int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_NORESERVE
+		flags |= MAP_NORESERVE;
+#endif
+		void* m = mmap(0, len + extra, PROT_NONE, flags, -1, 0);
+		if (m == MAP_FAILED)
+			return nullptr;
+		uintptr_t start = extra ? ((uintptr_t)m + extra) & ~(uintptr_t)(MICRO_BLOCK_SIZE - 1) : (uintptr_t)m;
+		if (start > (uintptr_t)m)
+			munmap(m, start - (uintptr_t)m);
+		uintptr_t end = (uintptr_t)m + len + extra;
+		if (end > start + len)
+			munmap((void*)(start + len), end - (start + len));
+		return (void*)start;
+	}
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION bool os_commit_pages(void* p, size_t pages) noexcept { return mprotect(p, pages * os_page_size(), PROT_READ | PROT_WRITE) == 0; }
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION bool os_uncommit_pages(void* p, size_t pages) noexcept
+	{
+		// Release physical memory first, then remove access
+		size_t len = pages * os_page_size();
+		if (unix_madvise(p, len, MADV_DONTNEED) != 0)
+			return false;
+		return mprotect(p, len, PROT_NONE) == 0;
+	}
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION bool os_release_pages(void* p, size_t pages) noexcept { return munmap(p, pages * os_page_size()) == 0; }
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION void* os_remap_pages(void* p, size_t old_pages, size_t new_pages) noexcept
+	{
+#if defined(__linux__) && defined(MREMAP_MAYMOVE)
+		// The remapped address is only aligned on the OS page size
+		if (MICRO_DEFAULT_PAGE_SIZE > os_page_size())
+			return nullptr;
+		void* r = mremap(p, old_pages * os_page_size(), new_pages * os_page_size(), MREMAP_MAYMOVE);
+		return r == MAP_FAILED ? nullptr : r;
+#else
+		(void)p;
+		(void)old_pages;
+		(void)new_pages;
+		return nullptr;
+#endif
+	}
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION size_t os_huge_page_size() noexcept
+	{
+#if defined(__linux__) && defined(MAP_HUGETLB)
+		// Parse the "Hugepagesize:  2048 kB" line of /proc/meminfo
+		static size_t hsize = []() {
+			int fd = open("/proc/meminfo", O_RDONLY);
+			if (fd < 0)
+				return static_cast<size_t>(0);
+			char buf[4096];
+			ssize_t len = read(fd, buf, sizeof(buf) - 1);
+			close(fd);
+			if (len <= 0)
+				return static_cast<size_t>(0);
+			buf[len] = 0;
+			const char* c = strstr(buf, "Hugepagesize:");
+			if (!c)
+				return static_cast<size_t>(0);
+			size_t kb = 0;
+			for (c += 13; *c == ' ' || *c == '\t'; ++c)
+				;
+			for (; *c >= '0' && *c <= '9'; ++c)
+				kb = kb * 10u + static_cast<size_t>(*c - '0');
+			return kb * 1024u;
+		}();
+		return hsize;
+#else
+		return 0;
+#endif
+	}
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION void* os_allocate_huge_pages(size_t pages) noexcept
+	{
+#if defined(__linux__) && defined(MAP_HUGETLB)
+		// Fails if the huge page pool (/proc/sys/vm/nr_hugepages) is too small
+		size_t len = pages * os_page_size();
+		size_t hsize = os_huge_page_size();
+		if (hsize == 0 || len % hsize)
+			return nullptr;
+		void* p = mmap(0, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		return p == MAP_FAILED ? nullptr : p;
+#else
+		(void)pages;
+		return nullptr;
+#endif
+	}
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION void* os_allocate_aligned_pages(size_t pages, size_t alignment) noexcept
+	{
+		// Allocate more than requested, and trim both sides
+		size_t len = pages * os_page_size();
+		size_t extra = alignment > os_page_size() ? alignment - os_page_size() : 0;
+		void* m = mmap(0, len + extra, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (m == MAP_FAILED)
+			return nullptr;
+		uintptr_t start = extra ? ((uintptr_t)m + extra) & ~(uintptr_t)(alignment - 1) : (uintptr_t)m;
+		if (start > (uintptr_t)m)
+			munmap(m, start - (uintptr_t)m);
+		uintptr_t end = (uintptr_t)m + len + extra;
+		if (end > start + len)
+			munmap((void*)(start + len), end - (start + len));
+		return (void*)start;
+	}
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION bool os_advise_huge_pages(void* p, size_t pages) noexcept
+	{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+		return unix_madvise(p, pages * os_page_size(), MADV_HUGEPAGE) == 0;
+#else
+		(void)p;
+		(void)pages;
+		return false;
+#endif
+	}
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION void os_populate_pages(void* p, size_t pages) noexcept
+	{
+		size_t len = pages * os_page_size();
+#if defined(__linux__)
+		// MADV_POPULATE_WRITE (Linux 5.14) faults in the whole range in one call
+		static constexpr int madv_populate_write = 23;
+		if (unix_madvise(p, len, madv_populate_write) == 0)
+			return;
+#endif
+		detail::touch_pages(p, len, os_page_size());
+	}
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION bool os_lock_pages(void* p, size_t pages) noexcept { return mlock(p, pages * os_page_size()) == 0; }
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION unsigned os_numa_node_count() noexcept
+	{
+#if defined(__linux__)
+		// Parse the list of online nodes (like "0-1" or "0,2") and keep the highest id
+		static unsigned count = []() {
+			int fd = open("/sys/devices/system/node/online", O_RDONLY);
+			if (fd < 0)
+				return 1u;
+			char buf[256];
+			ssize_t len = read(fd, buf, sizeof(buf) - 1);
+			close(fd);
+			if (len <= 0)
+				return 1u;
+			buf[len] = 0;
+			unsigned highest = 0, val = 0;
+			for (const char* c = buf; *c; ++c) {
+				if (*c >= '0' && *c <= '9')
+					val = val * 10u + static_cast<unsigned>(*c - '0');
+				else {
+					highest = val > highest ? val : highest;
+					val = 0;
+				}
+			}
+			highest = val > highest ? val : highest;
+			return highest + 1u;
+		}();
+		return count;
+#else
+		return 1;
+#endif
+	}
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION unsigned os_current_numa_node() noexcept
+	{
+#if defined(__linux__) && defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+		// glibc getcpu() uses the vDSO, much faster than the raw syscall
+		unsigned cpu = 0, node = 0;
+		if (getcpu(&cpu, &node) != 0)
+			return 0;
+		return node;
+#elif defined(__linux__) && defined(MICRO_HAS_SYSCALL_H) && defined(SYS_getcpu)
+		unsigned cpu = 0, node = 0;
+		if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0)
+			return 0;
+		return node;
+#else
+		return 0;
+#endif
+	}
+
+	MICRO_HEADER_ONLY_EXPORT_FUNCTION bool os_bind_pages(void* p, size_t pages, unsigned node) noexcept
+	{
+#if defined(__linux__) && defined(MICRO_HAS_SYSCALL_H) && defined(SYS_mbind)
+		// MPOL_PREFERRED: allocate on node if possible, fallback to other nodes otherwise
+		static constexpr int mpol_preferred = 1;
+		if (node >= 63)
+			return false;
+		unsigned long mask = 1ul << node;
+		return syscall(SYS_mbind, p, pages * os_page_size(), mpol_preferred, &mask, 64ul, 0u) == 0;
+#else
+		(void)p;
+		(void)pages;
+		(void)node;
+		return false;
+#endif
+	}
+
 	MICRO_HEADER_ONLY_EXPORT_FUNCTION size_t os_allocation_granularity() noexcept { return os_page_size(); }
 
 	MICRO_HEADER_ONLY_EXPORT_FUNCTION bool os_process_infos(micro_process_infos& infos) noexcept
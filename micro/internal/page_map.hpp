@@ -26,7 +26,6 @@
 #define MICRO_PAGE_MAP_HPP
 
 #include "headers.hpp"
-#include <algorithm>
 
 #if defined(MICRO_DEBUG) && !defined(MICRO_OVERRIDE)
 #define DEBUG_PAGE_MAP
@@ -42,232 +41,165 @@ namespace micro
 {
 	namespace detail
 	{
+		static constexpr unsigned static_log2(std::uint64_t v) noexcept { return v <= 1 ? 0 : 1 + static_log2(v >> 1u); }
 
-		/// @brief Sorted map of PageRunHeader handling consecutive runs to reduce its size.
+		/// @brief Process wide radix page table of all PageRunHeader in use, mapping addresses to their BaseMemoryManager.
 		///
-		/// PageMap is a sorted array of Key objects, where Key represents one or more PageRunHeader.
-		/// PageMap class provides an easy way to tell if a given PageRunHeader belongs to its parent BaseMemoryManager.
+		/// PageMap provides an easy way to find the BaseMemoryManager owning a given PageRunHeader (or any address),
+		/// whatever the number of BaseMemoryManager objects alive. A single instance is shared by all managers.
 		///
-		/// Each PageRunHeader have a size of at least MICRO_BLOCK_SIZE bytes. Consecutive PageRunHeader of
-		/// size MICRO_BLOCK_SIZE (medium allocations) are merged to reduce the number of entries.
+		/// The address space is split in granules of MICRO_BLOCK_SIZE bytes, indexed by a 3 levels
+		/// radix tree (root, middle nodes and leaves). Each PageRunHeader have a size of at least
+		/// MICRO_BLOCK_SIZE bytes, so at most one page run starts within a granule, and at most one
+		/// page run covers the beginning of a granule. Each leaf entry stores both with their owner.
 		///
-		/// A sorted array is preffered over a hash table as its number of entries is very low compared to
-		/// a hash table thanks to the merge mechanism.
+		/// Lookups (find() and owner()) are O(1) and lock free: tree nodes are allocated
+		/// straight from the OS, zero initialized, published atomically and never freed.
+		/// Insertions and removals are serialized by a spinlock.
 		///
-		/// Finding a PageRunHeader is (almost) as simple as a straight std::lower_bound.
+		/// Only the low 48 bits of addresses are indexed on 64 bits platforms.
 		///
 		class PageMap
 		{
-			// Key representing 1 or more consecutive PageRunHeader,
-			// contains the page address, the number of concsecutive runs (upto page_size -2) of size MICRO_BLOCK_SIZE,
-			// and tells if the run corresponds to a big allocation (size above MICRO_BLOCK_SIZE)
-			struct Key
+			static constexpr unsigned address_bits = sizeof(void*) == 8 ? 48 : 32;
+			static constexpr unsigned granule_bits = static_log2(MICRO_BLOCK_SIZE);
+			static constexpr unsigned index_bits = address_bits - granule_bits;
+			static constexpr unsigned leaf_bits = (index_bits + 2) / 3;
+			static constexpr unsigned mid_bits = (index_bits - leaf_bits + 1) / 2;
+			static constexpr unsigned root_bits = index_bits - leaf_bits - mid_bits;
+
+			// Leaf entry for one granule
+			struct Entry
 			{
-				uintptr_t value;
-				MICRO_ALWAYS_INLINE PageRunHeader* page(uintptr_t psize) const noexcept { return PageRunHeader::from(reinterpret_cast<void*>(value & ~(psize - 1u))); }
-				MICRO_ALWAYS_INLINE uintptr_t count(uintptr_t psize) const noexcept { return value & (psize - 1u); }
-				MICRO_ALWAYS_INLINE bool is_big(uintptr_t psize) const noexcept { return count(psize) == (psize - 1u); }
-
-				static MICRO_ALWAYS_INLINE Key from_page(void* p, uintptr_t count) noexcept { return Key{ reinterpret_cast<uintptr_t>(p) | count }; }
-				static MICRO_ALWAYS_INLINE Key from_big_page(void* p, uintptr_t psize) noexcept { return Key{ reinterpret_cast<uintptr_t>(p) | (psize - 1u) }; }
-				MICRO_ADD_CASTS(Key)
-			};
-			struct Less
-			{
-				PageMap* map;
-				MICRO_ALWAYS_INLINE bool operator()(const Key& left, const Key& right) const noexcept { return left.page(map->page_size) < right.page(map->page_size); }
+				std::atomic<uintptr_t> start;			 // page run starting within this granule
+				std::atomic<uintptr_t> start_end;		 // end address of this page run
+				std::atomic<BaseMemoryManager*> start_owner; // owner of this page run
+				std::atomic<uintptr_t> cover_end;		 // end address of the page run covering the beginning of this granule
+				std::atomic<BaseMemoryManager*> cover_owner; // owner of the covering page run
 			};
+			using Leaf = Entry;
+			using Mid = std::atomic<Leaf*>;
+			using Root = std::atomic<Mid*>;
 
-			// Find the key that contains given PageRunHeader
-			Key* find_internal(PageRunHeader* p) noexcept
+			template<class T>
+			static T* allocate_node(size_t count) noexcept
 			{
-				if (!count)
-					return nullptr;
+				// OS pages are zero initialized, which is a valid state for atomics
+				return static_cast<T*>(os_allocate_pages(node_pages(count * sizeof(T))));
+			}
+			static size_t node_pages(size_t bytes) noexcept { return (bytes + os_page_size() - 1u) / os_page_size(); }
 
-				Key* key = nullptr;
-				Key k = Key::from_page(p, 1);
-				auto* it = std::lower_bound(begin(), end(), k, Less{ this });
-				if (it == begin()) {
-					// check if start of it is equal to p
-					key = it->page(page_size) == p ? it : nullptr;
-				}
-				else if (it == end()) {
-					// check if p is in the range [start,start + count),
-					// and that p is located at a multiple of MICRO_BLOCK_SIZE
-					--it;
-					PageRunHeader* start = it->page(page_size);
-					if (!it->is_big(page_size)) {
-						auto pcount = it->count(page_size);
-						char* pend = start->as_char() + MICRO_BLOCK_SIZE * pcount;
-						if (p->as_char() < pend)
-							if (static_cast<uintptr_t>(p->as_char() - start->as_char()) % MICRO_BLOCK_SIZE == 0)
-								key = it;
-					}
-				}
-				else {
-					if (it->page(page_size) == p)
-						// Exact match
-						key = it;
-					else {
-						// Check if p belongs to previous entry
-						--it;
-						PageRunHeader* start = it->page(page_size);
-						auto pcount = it->count(page_size);
-						if (!it->is_big(page_size) && p->as_char() < (start->as_char() + MICRO_BLOCK_SIZE * pcount) &&
-						    static_cast<uintptr_t>(p->as_char() - start->as_char()) % MICRO_BLOCK_SIZE == 0)
-							key = it;
-					}
-				}
+			static MICRO_ALWAYS_INLINE uintptr_t granule(const void* p) noexcept { return reinterpret_cast<uintptr_t>(p) >> granule_bits; }
+			static MICRO_ALWAYS_INLINE bool in_range(uintptr_t g) noexcept { return (g >> index_bits) == 0; }
 
-				return key;
+			// Lock free access to the leaf entry of given granule, or null if missing
+			MICRO_ALWAYS_INLINE Entry* get(uintptr_t g) const noexcept
+			{
+				if (MICRO_UNLIKELY(!in_range(g)))
+					return nullptr;
+				Root* r = root.load(std::memory_order_acquire);
+				if (!r)
+					return nullptr;
+				Mid* m = r[g >> (leaf_bits + mid_bits)].load(std::memory_order_acquire);
+				if (!m)
+					return nullptr;
+				Leaf* l = m[(g >> leaf_bits) & ((1u << mid_bits) - 1u)].load(std::memory_order_acquire);
+				if (!l)
+					return nullptr;
+				return l + (g & ((1u << leaf_bits) - 1u));
 			}
 
-			bool grow() noexcept
+			// Access to the leaf entry of given granule, creating missing nodes.
+			// Must be called with the lock held.
+			Entry* get_or_create(uintptr_t g) noexcept
 			{
-				// move to new area
-				uintptr_t _new_cap = (capacity ? capacity * 2u : 64u);
-				Key* _new = Key::from(mgr->allocate_and_forget(static_cast<unsigned>(_new_cap * sizeof(Key))));
-				if (!_new)
-					return false;
-				if (block) {
-					memcpy(_new, block, count * sizeof(Key));
+				if (MICRO_UNLIKELY(!in_range(g)))
+					return nullptr;
+				Root* r = root.load(std::memory_order_relaxed);
+				if (!r) {
+					if (!(r = allocate_node<Root>(1u << root_bits)))
+						return nullptr;
+					root.store(r, std::memory_order_release);
 				}
-				block = _new;
-				capacity = _new_cap;
-				return true;
+				Root& rslot = r[g >> (leaf_bits + mid_bits)];
+				Mid* m = rslot.load(std::memory_order_relaxed);
+				if (!m) {
+					if (!(m = allocate_node<Mid>(1u << mid_bits)))
+						return nullptr;
+					rslot.store(m, std::memory_order_release);
+				}
+				Mid& mslot = m[(g >> leaf_bits) & ((1u << mid_bits) - 1u)];
+				Leaf* l = mslot.load(std::memory_order_relaxed);
+				if (!l) {
+					if (!(l = allocate_node<Leaf>(1u << leaf_bits)))
+						return nullptr;
+					mslot.store(l, std::memory_order_release);
+				}
+				return l + (g & ((1u << leaf_bits) - 1u));
 			}
 
-			Key* begin() noexcept { return Key::from(block); }
-			Key* end() noexcept { return begin() + count; }
+			using lock_type = spinlock;
 
-			using lock_type = shared_spinlock;
-
-			lock_type lock;		  // shared lock
-			uintptr_t page_size{ 0 }; // page size (usually os_allocation_granularity())
-			uintptr_t count{ 0 };	  // number of entries
-			uintptr_t capacity{ 0 };
-			Key* block{ nullptr };		   // current block where the map is stored
-			BaseMemoryManager* mgr{ nullptr }; // parent BaseMemoryManager
+			lock_type lock;			// writer lock
+			std::atomic<Root*> root{ nullptr }; // radix tree root
 
 #ifdef DEBUG_PAGE_MAP
 			std::set<PageRunHeader*> set;
 #endif
 
 		public:
-			PageMap(BaseMemoryManager* m) noexcept
-			  : page_size(m->page_provider()->allocation_granularity())
-			  , mgr(m)
-			{
-			}
-
-			void reset() noexcept
-			{
-				// Reset the page map.
-				// No need to deallocate pages as this is done by the parent BaseMemoryManager
-				lock.lock();
-				count = 0;
-				capacity = 0;
-				block = nullptr;
-
-#ifdef DEBUG_PAGE_MAP
-				set.clear();
-#endif
-
-				lock.unlock();
-			}
-
-			PageRunHeader* first() noexcept
-			{
-				if (!count)
-					return nullptr;
-				return block[0].page(page_size);
-			}
-
-			// Maximum number of consecutive PageRunHeader of size MICRO_BLOCK_SIZE.
-			// The value (page_size-1) is used to tell if an entry corresponds to a big PageRunHeader or not.
-			uintptr_t max_page_count() const noexcept { return page_size - 2; }
+			PageMap() noexcept {}
+			PageMap(const PageMap&) = delete;
+			PageMap& operator=(const PageMap&) = delete;
 
-			bool insert(PageRunHeader* p, bool big) noexcept
+			bool insert(PageRunHeader* p, BaseMemoryManager* owner) noexcept
 			{
+				MICRO_ASSERT_DEBUG(p->run_size() >= MICRO_BLOCK_SIZE, "");
 
 				std::lock_guard<lock_type> ll(lock);
 
-				bool found = find_internal(p) != nullptr;
+				const uintptr_t first = granule(p);
+				const uintptr_t end = reinterpret_cast<uintptr_t>(p->end());
+				const uintptr_t last = (end - 1u) >> granule_bits;
+
+				Entry* e = get_or_create(first);
+				if (!e)
+					return false;
+				bool found = e->start.load(std::memory_order_relaxed) == p->address();
+				MICRO_ASSERT_DEBUG(!found || e->start_owner.load(std::memory_order_relaxed) == owner, "");
 #ifdef DEBUG_PAGE_MAP
 				MICRO_ASSERT_DEBUG((set.find(p) != set.end()) == found, "");
 #endif
 				if (found)
 					return true;
 
-#ifdef DEBUG_PAGE_MAP
-				set.insert(p);
-#endif
-
-				if (capacity == 0 && !grow())
-					return false;
-
-				// Create key
-				Key k = big ? Key::from_big_page(p, page_size) : Key::from_page(p, 1);
-				auto* it = std::lower_bound(begin(), end(), k, Less{ this });
-
-				if (!big && count) {
-					// try to merge
-					if (it == end()) {
-						auto* prev = it - 1;
-						if (!prev->is_big(page_size) && prev->page(page_size)->as_char() + prev->count(page_size) * MICRO_BLOCK_SIZE == p->as_char()) {
-							if (prev->count(page_size) != max_page_count()) {
-								*prev = Key::from_page(prev->page(page_size), prev->count(page_size) + 1);
-								return true;
-							}
-						}
-					}
-					else {
-						MICRO_ASSERT_DEBUG(p < it->page(page_size), "");
-						if (!it->is_big(page_size) && p->as_char() + p->run_size() == it->page(page_size)->as_char() && it->count(page_size) != max_page_count()) {
-							*it = Key::from_page(p, it->count(page_size) + 1);
-							return true;
-						}
-						else if (it != begin()) {
-							auto* prev = it - 1;
-							if (!prev->is_big(page_size) && prev->page(page_size)->as_char() + prev->count(page_size) * MICRO_BLOCK_SIZE == p->as_char()) {
-								if (prev->count(page_size) != max_page_count()) {
-									*prev = Key::from_page(prev->page(page_size), prev->count(page_size) + 1);
-									return true;
-								}
-							}
-						}
-					}
-				}
-
-				uintptr_t diff = static_cast<uintptr_t>(end() - it);
-
-				if (count == capacity) {
-					if (!grow())
+				// Create all entries first, so that a failure leaves the map untouched
+				for (uintptr_t g = first + 1u; g <= last; ++g)
+					if (!get_or_create(g))
 						return false;
-					it = end() - diff;
-				}
-
-				// insert
-				if (diff)
-					memmove(it + 1, it, diff * sizeof(Key));
 
-				if (big)
-					*it = Key::from_big_page(p, page_size);
-				else
-					*it = Key::from_page(p, 1);
-				++count;
+				for (uintptr_t g = first + 1u; g <= last; ++g) {
+					Entry* c = get(g);
+					c->cover_owner.store(owner, std::memory_order_relaxed);
+					c->cover_end.store(end, std::memory_order_release);
+				}
+				e->start_end.store(end, std::memory_order_relaxed);
+				e->start_owner.store(owner, std::memory_order_relaxed);
+				e->start.store(p->address(), std::memory_order_release);
 
+#ifdef DEBUG_PAGE_MAP
+				set.insert(p);
+#endif
 				return true;
 			}
 
-			void erase(PageRunHeader* p) noexcept
+			void erase(PageRunHeader* p, BaseMemoryManager* owner) noexcept
 			{
-				MICRO_ASSERT_DEBUG(p->address() % page_size == 0, "");
-
 				std::lock_guard<lock_type> ll(lock);
 
-				Key* k = find_internal(p);
-				if (!k) {
+				const uintptr_t first = granule(p);
+				Entry* e = get(first);
+				if (!e || e->start.load(std::memory_order_relaxed) != p->address() || e->start_owner.load(std::memory_order_relaxed) != owner) {
 					// This page run does not belong to the map
 #ifdef DEBUG_PAGE_MAP
 					MICRO_ASSERT_DEBUG(set.find(p) == set.end(), "");
@@ -279,94 +211,41 @@ namespace micro
 				MICRO_ASSERT_DEBUG(set.erase(p) == 1, "");
 #endif
 
-				if (k->is_big(page_size) || k->count(page_size) == 1) {
-					// erase entry
-					size_t diff = static_cast<size_t>(end() - k - 1);
-					if (diff)
-						memmove(k, k + 1, diff * sizeof(Key));
-					--count;
-				}
-				else {
-					PageRunHeader* start = k->page(page_size);
-					auto pcount = k->count(page_size);
-					if (p == start) {
-						start = PageRunHeader::from(p->as_char() + MICRO_BLOCK_SIZE);
-						*k = Key::from_page(start, pcount - 1);
-					}
-					else if (p->as_char() == start->as_char() + (pcount - 1) * MICRO_BLOCK_SIZE)
-						*k = Key::from_page(start, pcount - 1);
-					else {
-						// split entry
-						uintptr_t diff_bytes = static_cast<uintptr_t>(p->as_char() - start->as_char());
-						MICRO_ASSERT_DEBUG(diff_bytes % MICRO_BLOCK_SIZE == 0, "");
-						auto left_count = diff_bytes / MICRO_BLOCK_SIZE;
-						auto right_count = pcount - left_count - 1;
-
-						if (count == capacity) {
-							size_t idx = static_cast<size_t>(k - begin());
-							// move to new page run
-							Key* _new = Key::from(mgr->allocate_and_forget(static_cast<unsigned>(capacity * 2u * sizeof(Key))));
-							if (!_new)
-								return; // TODO: error handling
-							memcpy(_new, block, static_cast<size_t>(count * sizeof(uintptr_t)));
-							block = _new;
-							capacity *= 2u;
-							k = begin() + idx;
-						}
-
-						// move toward the right
-						size_t diff = static_cast<size_t>(end() - k - 1);
-						if (diff)
-							memmove(k + 2, k + 1, diff * sizeof(Key));
-
-						*k = Key::from_page(start, left_count);
-						*(k + 1) = Key::from_page(p->as_char() + MICRO_BLOCK_SIZE, right_count);
-						++count;
-					}
+				const uintptr_t end = e->start_end.load(std::memory_order_relaxed);
+				const uintptr_t last = (end - 1u) >> granule_bits;
+				e->start.store(0, std::memory_order_release);
+				e->start_end.store(0, std::memory_order_relaxed);
+				e->start_owner.store(nullptr, std::memory_order_relaxed);
+				for (uintptr_t g = first + 1u; g <= last; ++g) {
+					Entry* c = get(g);
+					MICRO_ASSERT_DEBUG(c->cover_end.load(std::memory_order_relaxed) == end, "");
+					c->cover_end.store(0, std::memory_order_release);
+					c->cover_owner.store(nullptr, std::memory_order_relaxed);
 				}
-
-#ifdef DEBUG_PAGE_MAP
-				MICRO_ASSERT_DEBUG(set.find(p) == set.end(), "");
-#endif
-				MICRO_ASSERT_DEBUG(find_internal(p) == nullptr, "");
 			}
 
-			Key* find(PageRunHeader* p) noexcept
+			/// @brief Returns the owner of given PageRunHeader, or null if not in the map. Lock free.
+			BaseMemoryManager* find(PageRunHeader* p) const noexcept
 			{
-				lock.lock_shared();
-				Key* res = find_internal(p);
-#ifdef DEBUG_PAGE_MAP
-				auto it = set.find(p);
-				bool found_in_map = res != nullptr;
-				bool found_in_hash_table = it != set.end();
-				MICRO_ASSERT_DEBUG(found_in_map == found_in_hash_table, "");
-#endif
-				lock.unlock_shared();
-				return res;
+				const Entry* e = get(granule(p));
+				if (!e || e->start.load(std::memory_order_acquire) != p->address())
+					return nullptr;
+				return e->start_owner.load(std::memory_order_relaxed);
 			}
 
-			bool own(void* p) noexcept 
-			{ 
-				lock.lock_shared();
-				for (auto* k = begin(); k != end(); ++k) {
-					bool is_big = k->is_big(page_size);
-					PageRunHeader* r;
-					size_t bytes;
-					if (is_big) {
-						r = k->page(page_size);
-						bytes = r->size_bytes;
-					}
-					else {
-						r = k->page(page_size);
-						bytes = k->count(page_size) * MICRO_BLOCK_SIZE;
-					}
-					if (p >= r && p < (r->as_char() + bytes)) {
-						lock.unlock_shared();
-						return true;
-					}
-				}
-				lock.unlock_shared();
-				return false;
+			/// @brief Returns the owner of the PageRunHeader containing given address, or null if none. Lock free.
+			BaseMemoryManager* owner(const void* p) const noexcept
+			{
+				const Entry* e = get(granule(p));
+				if (!e)
+					return nullptr;
+				const uintptr_t addr = reinterpret_cast<uintptr_t>(p);
+				const uintptr_t start = e->start.load(std::memory_order_acquire);
+				if (start && addr >= start && addr < e->start_end.load(std::memory_order_relaxed))
+					return e->start_owner.load(std::memory_order_relaxed);
+				if (addr < e->cover_end.load(std::memory_order_acquire))
+					return e->cover_owner.load(std::memory_order_relaxed);
+				return nullptr;
 			}
 		};
 
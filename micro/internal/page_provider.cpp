@@ -25,20 +25,111 @@
 #include "page_provider.hpp"
 #include "../enums.h"
 #include "../logger.hpp"
+#include "../os_timer.hpp"
 #include "defines.hpp"
 
 #include <cstdio>
 #include <ctime>
 #include <cstring>
+#ifndef MICRO_NO_LOCK
+#include <thread>
+#endif
 
 MICRO_PUSH_DISABLE_OLD_STYLE_CAST
 
 namespace micro
 {
 
-	MICRO_EXPORT_CLASS_MEMBER MemoryPageProvider::MemoryPageProvider(const parameters& params, unsigned psize, bool allow_grow) noexcept
+	MICRO_EXPORT_CLASS_MEMBER void* OsPageProvider::allocate_pages(size_t pcount) noexcept
+	{
+		// Reuse a released page run of the same size if possible
+		if (d_cache_count.load(std::memory_order_relaxed)) {
+			std::lock_guard<spinlock> ll(d_lock);
+			unsigned count = d_cache_count.load(std::memory_order_relaxed);
+			for (unsigned i = 0; i < count; ++i) {
+				if (d_cache[i].pcount == pcount) {
+					void* res = d_cache[i].pages;
+					d_cache[i] = d_cache[count - 1];
+					d_cache_count.store(count - 1, std::memory_order_relaxed);
+					return res;
+				}
+			}
+		}
+		if (is_huge_run(pcount))
+			return allocate_huge_pages(pcount);
+		return os_allocate_pages(pcount);
+	}
+
+	MICRO_EXPORT_CLASS_MEMBER void* OsPageProvider::allocate_huge_pages(size_t pcount) noexcept
+	{
+		if (params().huge_pages == MicroHugePagesExplicit) {
+			if (void* p = os_allocate_huge_pages(pcount))
+				return p;
+			if (!d_huge_warned.exchange(true) && log_enabled(MicroWarning))
+				print_stderr(MicroWarning, params().log_date_format.data(), "OsPageProvider: no explicit huge page available, use transparent huge pages\n");
+		}
+		// Align the run so that the OS can back it with transparent huge pages
+		void* p = os_allocate_aligned_pages(pcount, d_huge_size);
+		if (p)
+			os_advise_huge_pages(p, pcount);
+		return p;
+	}
+
+	MICRO_EXPORT_CLASS_MEMBER bool OsPageProvider::free_pages(void* p, size_t pcount) noexcept
+	{
+		// Runs of huge pages are always unmapped, explicit huge pages cannot be decommitted
+		if (is_huge_run(pcount))
+			return os_release_pages(p, pcount);
+		return os_free_pages(p, pcount);
+	}
+
+	MICRO_EXPORT_CLASS_MEMBER bool OsPageProvider::deallocate_pages(void* p, size_t pcount) noexcept
+	{
+		const unsigned mode = params().decommit;
+		if (mode == MicroDecommitDontNeed || pcount * os_page_size() > MICRO_BLOCK_SIZE)
+			return free_pages(p, pcount);
+
+		// Keep the page run for reuse, lazily decommitted or still committed
+		if (mode == MicroDecommitFree)
+			os_reset_pages(p, pcount);
+		{
+			std::lock_guard<spinlock> ll(d_lock);
+			unsigned count = d_cache_count.load(std::memory_order_relaxed);
+			if (count < MICRO_DECOMMIT_CACHE_RUNS) {
+				d_cache[count] = CachedRun{ p, pcount };
+				d_cache_count.store(count + 1, std::memory_order_relaxed);
+				return true;
+			}
+		}
+		return free_pages(p, pcount);
+	}
+
+	MICRO_EXPORT_CLASS_MEMBER bool OsPageProvider::decommit_pages(void* p, size_t pcount) noexcept
+	{
+		switch (params().decommit) {
+			case MicroDecommitFree:
+				return os_reset_pages(p, pcount);
+			case MicroDecommitNone:
+				return false;
+			default:
+				return os_decommit_pages(p, pcount);
+		}
+	}
+
+	MICRO_EXPORT_CLASS_MEMBER void OsPageProvider::reset() noexcept
+	{
+		// Give back all kept page runs
+		std::lock_guard<spinlock> ll(d_lock);
+		unsigned count = d_cache_count.load(std::memory_order_relaxed);
+		for (unsigned i = 0; i < count; ++i)
+			free_pages(d_cache[i].pages, d_cache[i].pcount);
+		d_cache_count.store(0, std::memory_order_relaxed);
+	}
+
+	MICRO_EXPORT_CLASS_MEMBER MemoryPageProvider::MemoryPageProvider(const parameters& params, unsigned psize, bool allow_grow, bool commit_on_demand) noexcept
 	  : BasePageProvider(params)
 	  , grow(allow_grow)
+	  , commit(commit_on_demand)
 	  , p_size(psize)
 	  , p_size_bits(bit_scan_reverse_64(psize ? psize : 1))
 	{
@@ -49,17 +140,98 @@ namespace micro
 			     "page size must be a power of 2 in between 2048 and 65536");
 	}
 
-	// Insert a PageEntry into by_size and by_addr
-	MICRO_EXPORT_CLASS_MEMBER void MemoryPageProvider::insert_entry(const PageEntry& e)
+	// Commit the metadata area of given entry
+	MICRO_EXPORT_CLASS_MEMBER bool MemoryPageProvider::commit_entry(index_type idx) noexcept
 	{
-		by_addr.set()->insert(e);
-		by_size.set()->insert(e);
+		const size_t psize = os_page_size();
+		const size_t offset = static_cast<size_t>(reinterpret_cast<char*>(entries + idx) - buffer);
+		const size_t last = (offset + sizeof(PageEntry) - 1u) / psize;
+		for (size_t pg = offset / psize; pg <= last; ++pg) {
+			std::uint64_t bit = 1ull << (pg & 63u);
+			if (meta_committed[pg >> 6u] & bit)
+				continue;
+			if (!os_commit_pages(buffer + pg * psize, 1))
+				return false;
+			meta_committed[pg >> 6u] |= bit;
+		}
+		return true;
 	}
 
-	MICRO_EXPORT_CLASS_MEMBER void MemoryPageProvider::init(char* b, size_type size) noexcept
+	// Set the boundary tags of a run
+	MICRO_EXPORT_CLASS_MEMBER void MemoryPageProvider::tag(index_type idx, index_type count, index_type flag) noexcept
 	{
-		std::unique_lock<lock_type> ll(lock);
+		entries[idx].count = count | flag;
+		entries[idx + count - 1u].count = count | flag;
+	}
+
+	// Insert a free run into its list
+	MICRO_EXPORT_CLASS_MEMBER void MemoryPageProvider::insert_free(index_type idx, index_type count) noexcept
+	{
+		unsigned fl, sl;
+		mapping(count, fl, sl);
+		index_type head = heads[fl][sl];
+		entries[idx].next = head;
+		entries[idx].prev = nil;
+		if (head != nil)
+			entries[head].prev = idx;
+		heads[fl][sl] = idx;
+		fl_bitmap |= 1u << fl;
+		sl_bitmap[fl] |= 1u << sl;
+	}
+
+	// Remove a free run from its list
+	MICRO_EXPORT_CLASS_MEMBER void MemoryPageProvider::remove_free(index_type idx, index_type count) noexcept
+	{
+		unsigned fl, sl;
+		mapping(count, fl, sl);
+		index_type next = entries[idx].next;
+		index_type prev = entries[idx].prev;
+		if (next != nil)
+			entries[next].prev = prev;
+		if (prev != nil)
+			entries[prev].next = next;
+		else {
+			MICRO_ASSERT_DEBUG(heads[fl][sl] == idx, "");
+			heads[fl][sl] = next;
+			if (next == nil) {
+				sl_bitmap[fl] &= ~(1u << sl);
+				if (sl_bitmap[fl] == 0)
+					fl_bitmap &= ~(1u << fl);
+			}
+		}
+	}
+
+	// Find a free run of at least count pages
+	MICRO_EXPORT_CLASS_MEMBER MemoryPageProvider::index_type MemoryPageProvider::find_free(index_type count) noexcept
+	{
+		// Round up the page count to the next list, so that any run of this list is big enough
+		index_type target = count;
+		if (count >= sl_count)
+			target += (1u << (bit_scan_reverse_32(count) - sl_bits)) - 1u;
+		unsigned fl, sl;
+		mapping(target, fl, sl);
+
+		std::uint32_t sl_map = fl < fl_count ? sl_bitmap[fl] & (~0u << sl) : 0;
+		if (!sl_map) {
+			std::uint32_t fl_map = fl + 1u < fl_count ? fl_bitmap & (~0u << (fl + 1u)) : 0;
+			if (fl_map) {
+				fl = bit_scan_forward_32(fl_map);
+				sl_map = sl_bitmap[fl];
+			}
+		}
+		if (sl_map)
+			return heads[fl][bit_scan_forward_32(sl_map)];
+
+		// Last resort: look for a big enough run in the list of count
+		mapping(count, fl, sl);
+		for (index_type idx = heads[fl][sl]; idx != nil; idx = entries[idx].next)
+			if ((entries[idx].count & ~free_flag) >= count)
+				return idx;
+		return nil;
+	}
 
+	MICRO_EXPORT_CLASS_MEMBER bool MemoryPageProvider::set_buffer(char* b, size_type size) noexcept
+	{
 		// align end buffer on page size
 		if (b) {
 			uintptr_t end = reinterpret_cast<uintptr_t>(b) + size;
@@ -75,15 +247,90 @@ namespace micro
 
 		buffer = b;
 		buffer_size = size;
-		page_head = buffer + buffer_size;
-		set_tail = buffer;
-		first_free = nullptr;
+		meta_committed = nullptr;
+		entries = nullptr;
+		pages = nullptr;
+		pages_count = 0;
 		page_count = 0;
-		if (buffer) {
-			// no need to cleanup the set, just create a new one
-			new (by_size.set()) set_size_type(allocator_type{ this });
-			new (by_addr.set()) set_addr_type(allocator_type{ this });
+		fl_bitmap = 0;
+		memset(sl_bitmap, 0, sizeof(sl_bitmap));
+		memset(heads, 0xFF, sizeof(heads));
+		if (!buffer)
+			return false;
+
+		// Compute the number of pages: the metadata area (commit bitmap and one PageEntry per page)
+		// is followed by the pages, aligned on page size.
+		const size_t psize = os_page_size();
+		size_type count = size / (p_size + sizeof(PageEntry));
+		if (count >= free_flag)
+			count = free_flag - 1u;
+		size_type bitmap_bytes = 0;
+		for (;;) {
+			if (commit)
+				bitmap_bytes = ((((count * sizeof(PageEntry) + 2u * p_size) / psize + 1u) + 63u) / 64u) * 8u;
+			uintptr_t first = reinterpret_cast<uintptr_t>(buffer) + bitmap_bytes + count * sizeof(PageEntry);
+			first = (first + p_size - 1u) & ~(static_cast<uintptr_t>(p_size) - 1u);
+			if (count == 0 || first + count * p_size <= reinterpret_cast<uintptr_t>(buffer) + size) {
+				pages = reinterpret_cast<char*>(first);
+				break;
+			}
+			--count;
 		}
+
+		if (commit) {
+			meta_committed = reinterpret_cast<std::uint64_t*>(buffer);
+			if (!os_commit_pages(buffer, (bitmap_bytes + psize - 1u) / psize))
+				count = 0;
+			else
+				memset(meta_committed, 0, bitmap_bytes);
+		}
+		entries = reinterpret_cast<PageEntry*>(buffer + bitmap_bytes);
+		pages_count = static_cast<index_type>(count);
+
+		if (pages_count == 0 || (commit && (!commit_entry(0) || !commit_entry(pages_count - 1u)))) {
+			buffer = nullptr;
+			pages_count = 0;
+			return false;
+		}
+		return true;
+	}
+
+	MICRO_EXPORT_CLASS_MEMBER void MemoryPageProvider::init(char* b, size_type size) noexcept
+	{
+		std::unique_lock<lock_type> ll(lock);
+		if (!set_buffer(b, size))
+			return;
+
+		// Start with a single free run
+		tag(0, pages_count, free_flag);
+		insert_free(0, pages_count);
+	}
+
+	MICRO_EXPORT_CLASS_MEMBER bool MemoryPageProvider::attach(char* b, size_type size) noexcept
+	{
+		std::unique_lock<lock_type> ll(lock);
+		MICRO_ASSERT_DEBUG(!commit, "");
+		if (!set_buffer(b, size))
+			return false;
+
+		// Walk all runs using their boundary tags
+		size_type allocated = 0;
+		for (index_type idx = 0; idx < pages_count;) {
+			const index_type tag_value = entries[idx].count;
+			const index_type count = tag_value & ~free_flag;
+			if (count == 0 || count > pages_count - idx || entries[idx + count - 1u].count != tag_value) {
+				buffer = nullptr;
+				pages_count = 0;
+				return false;
+			}
+			if (tag_value & free_flag)
+				insert_free(idx, count);
+			else
+				allocated += count;
+			idx += count;
+		}
+		page_count = allocated;
+		return true;
 	}
 
 	MICRO_EXPORT_CLASS_MEMBER bool MemoryPageProvider::own(void* ptr) const noexcept
@@ -92,16 +339,33 @@ namespace micro
 		return p >= buffer && p < (buffer + buffer_size);
 	}
 
+	MICRO_EXPORT_CLASS_MEMBER bool MemoryPageProvider::allocated_run(const void* ptr) const noexcept
+	{
+		// Lock free check based on the boundary tags. The metadata area of a reserved buffer might not be committed.
+		const char* p = static_cast<const char*>(ptr);
+		if (commit || p < pages || p >= pages + (static_cast<size_type>(pages_count) << p_size_bits) || ((p - pages) & (p_size - 1u)))
+			return false;
+		const index_type idx = static_cast<index_type>(static_cast<size_type>(p - pages) >> p_size_bits);
+		const index_type count = entries[idx].count;
+		if (count == 0 || (count & free_flag) || count > pages_count - idx || entries[idx].next != idx)
+			return false;
+		return entries[idx + count - 1u].count == count;
+	}
+
 	MICRO_EXPORT_CLASS_MEMBER bool MemoryPageProvider::empty() const noexcept { return page_count == 0; }
 
 	MICRO_EXPORT_CLASS_MEMBER size_t MemoryPageProvider::max_pages() const noexcept
 	{
-		size_t from_head = static_cast<size_t>(page_head - set_tail) >> page_size_bits();
-		size_t from_free = 0;
-		if (!by_size.set()->empty()) {
-			from_free = (--by_size.set()->end())->size >> page_size_bits();
-		}
-		return std::max(from_head, from_free);
+		// Largest free run, only the highest non empty list needs to be inspected
+		std::lock_guard<lock_type> ll(const_cast<lock_type&>(lock));
+		if (!fl_bitmap)
+			return 0;
+		unsigned fl = bit_scan_reverse_32(fl_bitmap);
+		unsigned sl = bit_scan_reverse_32(sl_bitmap[fl]);
+		size_t res = 0;
+		for (index_type idx = heads[fl][sl]; idx != nil; idx = entries[idx].next)
+			res = std::max(res, static_cast<size_t>(entries[idx].count & ~free_flag));
+		return res;
 	}
 
 	/// @brief Allocate and return pcount pages of size PageSize
@@ -109,59 +373,46 @@ namespace micro
 	{
 		std::lock_guard<lock_type> ll(lock);
 
-		if (!buffer) {
+		index_type idx = nil;
+		if (buffer && pcount && pcount <= pages_count)
+			idx = find_free(static_cast<index_type>(pcount));
+
+		if (idx == nil) {
+			// no room left
 			if (grow)
 				return os_allocate_pages(pcount);
+			if (buffer && log_enabled(MicroWarning))
+				print_stderr(MicroWarning, this->params().log_date_format.data(), "MemoryPageProvider: cannot allocate %u pages\n", static_cast<unsigned>(pcount));
 			return nullptr;
 		}
 
-		try {
-			size_type bytes = pcount * p_size;
-
-			// Find in free pages
-			auto it = by_size.set()->lower_bound(PageEntry{ nullptr, bytes });
-			if (it == by_size.set()->end()) {
-				// allocate from page head
-				char* new_head = page_head - bytes;
-				if (new_head < set_tail) {
-					// no room left
-					if (grow)
-						return os_allocate_pages(pcount);
-					if (log_enabled(MicroWarning))
-						print_stderr(MicroWarning, this->params().log_date_format.data(), "MemoryPageProvider: cannot allocate %u pages\n", static_cast<unsigned>(pcount));
-					return nullptr;
-				}
-				page_head = new_head;
-				page_count += pcount;
-				return page_head;
-			}
-
-			PageEntry e = *it;
+		// Carve pages from the right side of the free run
+		const index_type count = entries[idx].count & ~free_flag;
+		const index_type n = static_cast<index_type>(pcount);
+		const index_type res = idx + count - n;
+		char* p = pages + (static_cast<size_type>(res) << p_size_bits);
 
-			// remove entry
-			erase_entry(e, by_addr.set()->end(), it);
-
-			if (e.size != bytes) {
-				// split
-				char* new_pages = e.page + bytes;
-				size_type new_size = e.size - bytes;
-				// add new pages
-				insert_entry(PageEntry{ new_pages, new_size });
+		if (commit) {
+			// Commit everything first, so that a failure leaves the provider untouched
+			bool ok = commit_entry(res) && (count == n || commit_entry(res - 1u)) && os_commit_pages(p, os_pages(pcount));
+			if (!ok) {
+				if (log_enabled(MicroWarning))
+					print_stderr(MicroWarning, this->params().log_date_format.data(), "MemoryPageProvider: cannot commit %u pages\n", static_cast<unsigned>(pcount));
+				return nullptr;
 			}
-
-			page_count += pcount;
-			return e.page;
 		}
-		catch (...) {
-			// potential bad_alloc from std::set/multiset
-			if (!grow)
-				if (log_enabled(MicroWarning))
-					print_stderr(MicroWarning, this->params().log_date_format.data(), "MemoryPageProvider: cannot allocate %u pages\n", static_cast<unsigned>(pcount));
+
+		remove_free(idx, count);
+		if (count != n) {
+			tag(idx, count - n, free_flag);
+			insert_free(idx, count - n);
 		}
+		tag(res, n, 0);
+		// Mark the first page of the run (see allocated_run())
+		entries[res].next = res;
 
-		if (grow)
-			return os_allocate_pages(pcount);
-		return nullptr;
+		page_count += pcount;
+		return p;
 	}
 
 	/// @brief Deallocate pcount pages starting at address p
@@ -181,38 +432,42 @@ namespace micro
 			return false;
 		}
 
-		MICRO_ASSERT_DEBUG(by_addr.set()->find(PageEntry{ static_cast<char*>(p), pcount * p_size }) == by_addr.set()->end(), "");
-
-		try {
-			PageEntry e{ static_cast<char*>(p), pcount * p_size };
-
-			if (by_addr.set()->size()) {
-				// find free page just after
-				auto next = by_addr.set()->lower_bound(e);
-				auto prev = next;
-				--prev; // we are certain that prev != next since the map is not empty
-				if (next != by_addr.set()->end() && e.page + e.size == next->page) {
-					// free pages just after: merge
-					e.size += next->size;
-					erase_entry(*next, next, by_size.set()->end());
-				}
-				if (prev != by_addr.set()->end() && (prev->page + prev->size) == e.page) {
-					// free pages before: merge
-					e.size += prev->size;
-					e.page = prev->page;
-					erase_entry(*prev, prev, by_size.set()->end());
-				}
+		index_type idx = static_cast<index_type>(static_cast<size_type>(static_cast<char*>(p) - pages) >> p_size_bits);
+		index_type count = static_cast<index_type>(pcount);
+		MICRO_ASSERT_DEBUG(static_cast<char*>(p) >= pages && idx + count <= pages_count, "");
+		MICRO_ASSERT_DEBUG(entries[idx].count == count && entries[idx + count - 1u].count == count, "");
+
+		// Give back physical memory, pages are committed again on allocation
+		if (commit)
+			os_uncommit_pages(p, os_pages(pcount));
+
+		// Invalidate the tags, they won't be rewritten if the run is merged with its neighbors
+		tag(idx, count, free_flag);
+		entries[idx].next = nil;
+
+		// Merge with the next and previous free runs using their boundary tags
+		if (idx + count < pages_count) {
+			index_type next = entries[idx + count].count;
+			if (next & free_flag) {
+				next &= ~free_flag;
+				remove_free(idx + count, next);
+				count += next;
 			}
-			insert_entry(e);
-			page_count -= pcount;
-			return true;
 		}
-		catch (...) {
-			// potential bad_alloc from std::set/multiset
-			if (log_enabled(MicroWarning))
-				print_stderr(MicroWarning, this->params().log_date_format.data(), "MemoryPageProvider: cannot deallocate %u pages\n", static_cast<unsigned>(pcount));
-			return false;
+		if (idx > 0) {
+			index_type prev = entries[idx - 1u].count;
+			if (prev & free_flag) {
+				prev &= ~free_flag;
+				remove_free(idx - prev, prev);
+				idx -= prev;
+				count += prev;
+			}
 		}
+		tag(idx, count, free_flag);
+		insert_free(idx, count);
+
+		page_count -= pcount;
+		return true;
 	}
 
 	MICRO_EXPORT_CLASS_MEMBER size_t MemoryPageProvider::page_size() const noexcept { return p_size; }
@@ -224,7 +479,13 @@ namespace micro
 		return grow;
 	}
 
-	MICRO_EXPORT_CLASS_MEMBER void MemoryPageProvider::reset() noexcept { init(buffer, buffer_size); }
+	MICRO_EXPORT_CLASS_MEMBER void MemoryPageProvider::reset() noexcept
+	{
+		// Decommit the whole buffer at once
+		if (commit && buffer)
+			os_uncommit_pages(buffer, buffer_size / os_page_size());
+		init(buffer, buffer_size);
+	}
 
 #ifndef MICRO_NO_FILE_MAPPING
 
@@ -237,6 +498,8 @@ namespace micro
 	  , d_size(0)
 	  , d_file_size(0)
 	  , d_flags(0)
+	  , d_header(nullptr)
+	  , d_zeroed(false)
 	{
 		d_filename[0] = 0;
 		d_basename[0] = 0;
@@ -252,16 +515,8 @@ namespace micro
 
 	MICRO_EXPORT_CLASS_MEMBER FilePageProvider::~FilePageProvider() noexcept
 	{
-		if (d_filename[0]) {
-			// Close all views
-			auto* p = d_first;
-			while (p) {
-				auto* next = p->next;
-				p->view = memory_map_file_view{};
-				p = next;
-			}
-			d_file.init(nullptr, 0);
-		}
+		if (d_filename[0])
+			close();
 		//if (d_filename[0] && (d_flags & MicroRemoveOnClose)) {
 			// Remove file
 		//	remove(d_filename);
@@ -360,25 +615,109 @@ namespace micro
 	}
 
 
+	MICRO_EXPORT_CLASS_MEMBER bool FilePageProvider::add_view(memory_map_file_view&& view, size_t offset, bool attach) noexcept
+	{
+		char* view_ptr = static_cast<char*>(view.view_ptr());
+		const std::uint64_t view_size = view.view_size();
+		char* buffer = view_ptr + offset + sizeof(MemPageProvider);
+		const size_t buffer_size = static_cast<size_t>(view_size - offset - sizeof(MemPageProvider));
+
+		// Link the provider first so that close() unmaps the view on failure
+		d_first = new (view_ptr + offset) MemPageProvider{ std::move(view), { this->params(), p_size, false }, d_first };
+		d_file_size += view_size;
+		if (attach)
+			return d_first->provider.attach(buffer, buffer_size);
+
+		d_first->provider.init(buffer, buffer_size);
+		if (d_header) {
+			// Record the view address for the next opening
+			d_header->views[d_header->view_count].address = reinterpret_cast<std::uintptr_t>(view_ptr);
+			d_header->views[d_header->view_count].size = view_size;
+			++d_header->view_count;
+		}
+		return true;
+	}
+
+	MICRO_EXPORT_CLASS_MEMBER bool FilePageProvider::open_persistent(const char* filename, std::uint64_t size) noexcept
+	{
+		std::uint64_t existing = 0;
+		if (!d_file.open(filename, &existing))
+			return false;
+
+		if (existing == 0) {
+			// New file: the first view starts with the header
+			if (size < header_bytes() + p_size * 2)
+				size = header_bytes() + p_size * 2;
+			memory_map_file_view view = d_file.extend(size);
+			if (!view.valid())
+				return false;
+			d_header = new (view.view_ptr()) PersistentHeader();
+			d_header->page_size = p_size;
+			add_view(std::move(view), header_bytes(), false);
+			d_header->magic = MICRO_PERSISTENT_MAGIC;
+		}
+		else {
+			// Existing file: map all views at their previous addresses
+			PersistentHeader h;
+			if (existing < header_bytes() || !d_file.read(&h, sizeof(h)) || h.magic != MICRO_PERSISTENT_MAGIC || h.page_size != p_size || h.view_count == 0 ||
+			    h.view_count > MICRO_MAX_PERSISTENT_VIEWS) {
+				if (log_enabled(MicroWarning))
+					print_stderr(MicroWarning, this->params().log_date_format.data(), "FilePageProvider: %s is not a valid persistent file\n", filename);
+				return false;
+			}
+			if (h.attached) {
+				if (log_enabled(MicroWarning))
+					print_stderr(MicroWarning, this->params().log_date_format.data(), "FilePageProvider: %s is already opened or was not properly closed\n", filename);
+				return false;
+			}
+			for (unsigned i = 0; i < h.view_count; ++i) {
+				memory_map_file_view view = d_file.extend(h.views[i].size, reinterpret_cast<void*>(static_cast<std::uintptr_t>(h.views[i].address)));
+				if (!view.valid()) {
+					if (log_enabled(MicroWarning))
+						print_stderr(MicroWarning, this->params().log_date_format.data(), "FilePageProvider: unable to map %s at its previous address\n", filename);
+					return false;
+				}
+				if (i == 0)
+					d_header = static_cast<PersistentHeader*>(view.view_ptr());
+				if (!add_view(std::move(view), i == 0 ? header_bytes() : 0, true)) {
+					if (log_enabled(MicroWarning))
+						print_stderr(MicroWarning, this->params().log_date_format.data(), "FilePageProvider: %s is corrupted\n", filename);
+					return false;
+				}
+			}
+		}
+		d_header->attached = 1;
+		return true;
+	}
+
+	MICRO_EXPORT_CLASS_MEMBER void FilePageProvider::close() noexcept
+	{
+		// Mark the persistent file as properly closed
+		if (d_header)
+			d_header->attached = 0;
+
+		// Close all views
+		auto* p = d_first;
+		while (p) {
+			auto* next = p->next;
+			p->view = memory_map_file_view{};
+			p = next;
+		}
+		d_file.init(nullptr, 0);
+		d_first = nullptr;
+		d_header = nullptr;
+		d_filename[0] = 0;
+		d_size = d_file_size = 0;
+		d_flags = 0;
+	}
+
 	MICRO_EXPORT_CLASS_MEMBER bool FilePageProvider::init(const char* filename, std::uint64_t size, unsigned flags) noexcept
 	{
 		
 		std::lock_guard<spinlock> ll(d_lock);
 
-		if (d_filename[0]) {
-			// Close all views
-			auto* p = d_first;
-			while (p) {
-				auto* next = p->next;
-				p->view = memory_map_file_view{};
-				p = next;
-			}
-			d_file.init(nullptr, 0);
-			d_first = nullptr;
-			d_filename[0] = 0;
-			d_size = d_file_size = 0;
-			d_flags = 0;
-		}
+		if (d_filename[0])
+			close();
 
 		// Initial size must be at least equal to 2 pages (one to store the memory provider, and one to provide)
 		if (size < p_size * 2)
@@ -388,6 +727,29 @@ namespace micro
 
 		char tmp[MICRO_MAX_PATH];
 
+		if (flags & MicroPersistent) {
+			// Persistent file: the name must be reproducible, so only try once
+			filename = d_basename;
+			if (!d_basename[0] || params().page_file_provider_dir[0]) {
+				memset(tmp, 0, sizeof(tmp));
+				if (!create_filename(this, tmp, params().page_file_provider_dir.data(), d_basename, 0))
+					return false;
+				filename = tmp;
+			}
+			if (!open_persistent(filename, size)) {
+				close();
+				if (log_enabled(MicroWarning))
+					print_safe(stderr, "WARNING cannot open persistent FilePageProvider on ", filename, "\n");
+				return false;
+			}
+			if (filename == tmp)
+				strcpy(const_cast<char*>(params().page_file_provider.data()), filename);
+			d_size = size;
+			d_flags = flags;
+			strcpy(d_filename, filename);
+			return true;
+		}
+
 		if (!d_basename[0] || params().page_file_provider_dir[0]) {
 			unsigned try_count = 0;
 			while (try_count < 1000) {
@@ -415,12 +777,7 @@ namespace micro
 		}
 
 		// Initialize first memory provider
-		auto* view_ptr = view.view_ptr();
-		auto view_size = view.view_size();
-
-		d_first = new (view_ptr) MemPageProvider{ std::move(view), { this->params(), p_size, false }, nullptr };
-		d_first->provider.init(static_cast<char*>(view_ptr) + sizeof(MemPageProvider), static_cast<std::uintptr_t>(view_size - sizeof(MemPageProvider)));
-		d_file_size = view_size;
+		add_view(std::move(view), 0, false);
 		d_size = size;
 		d_flags = flags;
 		strcpy(d_filename, filename);
@@ -443,13 +800,14 @@ namespace micro
 			void* pages = p->provider.allocate_pages(pcount);
 			if (pages) {
 				MICRO_ASSERT_DEBUG(!pages || (reinterpret_cast<uintptr_t>(pages) & (p_size - 1)) == 0, "");
-				memset(pages, 0, p_size * pcount);
+				if (!d_zeroed)
+					memset(pages, 0, p_size * pcount);
 				return pages;
 			}
 			p = p->next;
 		}
 
-		if (!(d_flags & MicroGrowing) || !d_first) {
+		if (!(d_flags & MicroGrowing) || !d_first || (d_header && d_header->view_count == MICRO_MAX_PERSISTENT_VIEWS)) {
 			if (log_enabled(MicroWarning))
 				print_stderr(MicroWarning, this->params().log_date_format.data(), "FilePageProvider: cannot allocate %u pages\n", static_cast<unsigned>(pcount));
 			return nullptr;
@@ -460,7 +818,7 @@ namespace micro
 		std::uint64_t bytes_from_grow_factor = static_cast<std::uint64_t>(static_cast<double>(d_file_size) * (d_grow_factor - 1.));
 		if (bytes < bytes_from_grow_factor)
 			bytes = bytes_from_grow_factor;
-		bytes += p_size; // add a page for MemoryPageProvider bookkeeping
+		bytes += p_size + MemoryPageProvider::metadata_bytes(static_cast<size_t>(bytes / p_size), p_size); // add MemoryPageProvider bookkeeping
 
 		auto view = d_file.extend(bytes);
 		if (!view.valid()) {
@@ -470,37 +828,49 @@ namespace micro
 			return nullptr;
 		}
 
-		auto* view_ptr = view.view_ptr();
-		auto view_size = view.view_size();
-
-		d_file_size += view_size;
-		MemPageProvider* provider = new (view_ptr) MemPageProvider{ std::move(view), { this->params(), p_size, false }, d_first };
-		provider->provider.init(static_cast<char*>(view_ptr) + sizeof(MemPageProvider), static_cast<std::uintptr_t>(view_size - sizeof(MemPageProvider)));
-		d_first = provider;
+		add_view(std::move(view), 0, false);
 
-		void * pages= provider->provider.allocate_pages(pcount);
+		void * pages= d_first->provider.allocate_pages(pcount);
 		MICRO_ASSERT_DEBUG(!pages || (reinterpret_cast<uintptr_t>(pages) & (p_size - 1)) == 0, "");
-		if(pages)
+		if (pages && !d_zeroed)
 			memset(pages, 0, p_size * pcount);
 		return pages;
 	}
 
+	MICRO_EXPORT_CLASS_MEMBER FilePageProvider::MemPageProvider* FilePageProvider::find_view(void* p) const noexcept
+	{
+		for (MemPageProvider* provider = d_first; provider; provider = provider->next)
+			if (provider->provider.own(p))
+				return provider;
+		return nullptr;
+	}
+
 	MICRO_EXPORT_CLASS_MEMBER bool FilePageProvider::deallocate_pages(void* p, size_t pcount) noexcept
 	{
 		std::lock_guard<spinlock> ll(d_lock);
 
 		// Find the owning provider
-		MemPageProvider* provider = d_first;
-		while (provider) {
-			if (provider->provider.own(p))
-				return provider->provider.deallocate_pages(p, pcount);
-			provider = provider->next;
-		}
+		if (MemPageProvider* provider = find_view(p))
+			return provider->provider.deallocate_pages(p, pcount);
 		if (log_enabled(MicroWarning))
 			print_stderr(MicroWarning, this->params().log_date_format.data(), "FilePageProvider: cannot deallocate %u pages\n", static_cast<unsigned>(pcount));
 		return false;
 	}
 
+	MICRO_EXPORT_CLASS_MEMBER void FilePageProvider::reset() noexcept
+	{
+		{
+			std::lock_guard<spinlock> ll(d_lock);
+			if (d_header) {
+				// Keep the persistent file and its views, only release their pages
+				for (MemPageProvider* p = d_first; p; p = p->next)
+					p->provider.reset();
+				return;
+			}
+		}
+		init(current_filename(), current_size(), current_flags());
+	}
+
 	MICRO_EXPORT_CLASS_MEMBER const char* FilePageProvider::current_filename() const noexcept
 	{
 		std::lock_guard<spinlock> ll(const_cast<spinlock&>(d_lock));
@@ -517,27 +887,200 @@ namespace micro
 		return d_flags;
 	}
 
+#ifdef MICRO_HAS_MEMFD
+
+	MICRO_EXPORT_CLASS_MEMBER bool MemfdPageProvider::init(std::uint64_t size, unsigned flags) noexcept
+	{
+		std::lock_guard<spinlock> ll(d_lock);
+
+		if (d_filename[0])
+			close();
+
+		// Initial size must be at least equal to 2 pages (one to store the memory provider, and one to provide)
+		if (size < p_size * 2)
+			size = p_size * 2;
+
+		const char* name = d_basename[0] ? d_basename : "micro";
+		memory_map_file_view view = d_file.init_memfd(name, size);
+		if (!view.valid()) {
+			if (log_enabled(MicroWarning))
+				print_safe(stderr, "WARNING cannot create MemfdPageProvider\n");
+			return false;
+		}
+
+		add_view(std::move(view), 0, false);
+		d_size = size;
+		d_flags = flags & MicroGrowing;
+		// New file content and punched holes read as zeros
+		d_zeroed = true;
+		snprintf(d_filename, sizeof(d_filename), "memfd:%.*s", static_cast<int>(sizeof(d_filename) - 7), name);
+		return true;
+	}
+
+	MICRO_EXPORT_CLASS_MEMBER bool MemfdPageProvider::deallocate_pages(void* p, size_t pcount) noexcept
+	{
+		std::lock_guard<spinlock> ll(d_lock);
+
+		MemPageProvider* provider = find_view(p);
+		if (!provider || !provider->provider.deallocate_pages(p, pcount)) {
+			if (log_enabled(MicroWarning))
+				print_stderr(MicroWarning, this->params().log_date_format.data(), "MemfdPageProvider: cannot deallocate %u pages\n", static_cast<unsigned>(pcount));
+			return false;
+		}
+
+		// Give the pages back to the kernel, still under the lock as they could be reallocated right away.
+		// Pages must read as zeros on the next allocation.
+		const std::uint64_t offset = provider->view.file_offset() + static_cast<std::uint64_t>(static_cast<char*>(p) - static_cast<char*>(provider->view.view_ptr()));
+		if (!d_file.punch_hole(offset, static_cast<std::uint64_t>(pcount) * p_size))
+			memset(p, 0, pcount * p_size);
+		return true;
+	}
+
+	MICRO_EXPORT_CLASS_MEMBER bool MemfdPageProvider::decommit_pages(void* p, size_t pcount) noexcept
+	{
+		std::lock_guard<spinlock> ll(d_lock);
+
+		MemPageProvider* provider = find_view(p);
+		if (!provider)
+			return false;
+		const std::uint64_t offset = provider->view.file_offset() + static_cast<std::uint64_t>(static_cast<char*>(p) - static_cast<char*>(provider->view.view_ptr()));
+		return d_file.punch_hole(offset, static_cast<std::uint64_t>(pcount) * p_size);
+	}
+
+#endif
+
 #endif
 
 	MICRO_EXPORT_CLASS_MEMBER PreallocatePageProvider::PreallocatePageProvider(const parameters& params, size_t bytes, bool allow_grow) noexcept
 	  : BasePageProvider(params)
 	  , d_pages(nullptr)
 	  , d_pcount(0)
+	  , d_huge(false)
+	  , d_time_ns(0)
 	  , d_provider(params, static_cast<unsigned>(os_page_size()), allow_grow)
 	{
+		const unsigned flags = params.prealloc_flags;
+		timer t;
+		t.tick();
+
 		size_t pcount = bytes / os_page_size() + (bytes % os_page_size() ? 1 : 0);
-		d_pages = os_allocate_pages(pcount);
+		if (flags & MicroPreallocHugePages) {
+			// Explicit huge pages first, transparent huge pages otherwise
+			size_t hsize = os_huge_page_size();
+			if (hsize > os_page_size()) {
+				size_t hpages = hsize / os_page_size();
+				size_t hcount = (pcount + hpages - 1) / hpages * hpages;
+				d_pages = os_allocate_huge_pages(hcount);
+				if (d_pages) {
+					pcount = hcount;
+					d_huge = true;
+				}
+			}
+		}
+		if (!d_pages) {
+			d_pages = os_allocate_pages(pcount);
+			if (d_pages && (flags & MicroPreallocHugePages) && !os_advise_huge_pages(d_pages, pcount) && log_enabled(MicroWarning))
+				print_stderr(MicroWarning, params.log_date_format.data(), "PreallocatePageProvider: huge pages not available\n");
+		}
+		if (!d_pages)
+			return;
+
+		d_pcount = pcount;
+		d_provider.init(static_cast<char*>(d_pages), pcount * os_page_size());
+
+		// Locking faults in the remaining pages, populate them anyway if it fails
+		bool populated = false;
+		if (flags & (MicroPreallocPopulate | MicroPreallocParallel)) {
+			populate();
+			populated = true;
+		}
+		if ((flags & MicroPreallocLock) && !os_lock_pages(d_pages, d_pcount)) {
+			if (log_enabled(MicroWarning))
+				print_stderr(MicroWarning, params.log_date_format.data(), "PreallocatePageProvider: unable to lock %u pages\n", static_cast<unsigned>(d_pcount));
+			if (!populated)
+				populate();
+		}
+
+		d_time_ns = t.tock();
+		if (log_enabled(MicroInfo))
+			print_stderr(MicroInfo,
+				     params.log_date_format.data(),
+				     "PreallocatePageProvider: %u MB preallocated in %u ms\n",
+				     static_cast<unsigned>((d_pcount * os_page_size()) >> 20u),
+				     static_cast<unsigned>(d_time_ns / 1000000u));
+	}
+
+	MICRO_EXPORT_CLASS_MEMBER void PreallocatePageProvider::populate() noexcept
+	{
+		// Split the pages between threads, each one faulting in at least MICRO_POPULATE_THREAD_BYTES
+		size_t count = 1;
+#ifndef MICRO_NO_LOCK
+		if (params().prealloc_flags & MicroPreallocParallel) {
+			count = (d_pcount * os_page_size()) / MICRO_POPULATE_THREAD_BYTES;
+			size_t hc = std::thread::hardware_concurrency();
+			if (count > hc)
+				count = hc;
+			if (count > MICRO_MAX_POPULATE_THREADS)
+				count = MICRO_MAX_POPULATE_THREADS;
+			if (count == 0)
+				count = 1;
+		}
+		std::thread threads[MICRO_MAX_POPULATE_THREADS];
+#endif
+		const size_t slice = d_pcount / count;
+		char* p = static_cast<char*>(d_pages);
+		size_t i = 1;
+#ifndef MICRO_NO_LOCK
+		try {
+			for (; i < count; ++i)
+				threads[i] = std::thread(os_populate_pages, p + i * slice * os_page_size(), i == count - 1 ? d_pcount - i * slice : slice);
+		}
+		catch (...) {
+		}
+#endif
+		// Slices without thread are faulted in by the calling thread
+		os_populate_pages(p, slice);
+		for (size_t j = i; j < count; ++j)
+			os_populate_pages(p + j * slice * os_page_size(), j == count - 1 ? d_pcount - j * slice : slice);
+#ifndef MICRO_NO_LOCK
+		for (size_t j = 1; j < i; ++j)
+			threads[j].join();
+#endif
+	}
+
+	MICRO_EXPORT_CLASS_MEMBER PreallocatePageProvider::~PreallocatePageProvider() noexcept
+	{
+		if (d_pages) {
+			if (!(d_huge ? os_release_pages(d_pages, d_pcount) : os_free_pages(d_pages, d_pcount)))
+				if (log_enabled(MicroWarning))
+					print_stderr(MicroWarning, params().log_date_format.data(), "unable to free pages");
+		}
+	}
+
+	MICRO_EXPORT_CLASS_MEMBER ReservePageProvider::ReservePageProvider(const parameters& params, size_t bytes, bool allow_grow) noexcept
+	  : BasePageProvider(params)
+	  , d_pages(nullptr)
+	  , d_pcount(0)
+	  , d_provider(params, static_cast<unsigned>(os_page_size()), allow_grow, true)
+	{
+		if (bytes == 0)
+			bytes = static_cast<size_t>(MICRO_DEFAULT_RESERVE_SIZE);
+		size_t pcount = bytes / os_page_size() + (bytes % os_page_size() ? 1 : 0);
+		d_pages = os_reserve_pages(pcount);
 		if (d_pages) {
 			d_pcount = pcount;
 			d_provider.init(static_cast<char*>(d_pages), pcount * os_page_size());
 		}
+		else if (log_enabled(MicroWarning))
+			print_stderr(MicroWarning, params.log_date_format.data(), "unable to reserve address range");
 	}
-	MICRO_EXPORT_CLASS_MEMBER PreallocatePageProvider::~PreallocatePageProvider() noexcept
+	MICRO_EXPORT_CLASS_MEMBER ReservePageProvider::~ReservePageProvider() noexcept
 	{
+		// Drop the whole reservation at once
 		if (d_pages) {
-			if (!os_free_pages(d_pages, d_pcount))
+			if (!os_release_pages(d_pages, d_pcount))
 				if (log_enabled(MicroWarning))
-					print_stderr(MicroWarning, params().log_date_format.data(), "unable to free pages");
+					print_stderr(MicroWarning, params().log_date_format.data(), "unable to release address range");
 		}
 	}
 
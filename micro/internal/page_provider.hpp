@@ -40,7 +40,6 @@ extern "C" {
 #include "../enums.h"
 }
 #include "../parameters.hpp"
-#include <set>
 
 MICRO_PUSH_DISABLE_OLD_STYLE_CAST
 
@@ -65,10 +64,47 @@ namespace micro
 		virtual size_t page_size_bits() const noexcept = 0;
 		virtual size_t allocation_granularity() const noexcept { return this->page_size(); }
 
+		/// @brief Returns the size of the huge pages backing page runs of whole huge pages, 0 if not used
+		virtual size_t huge_page_size() const noexcept { return 0; }
+
+		/// @brief Resize a run of pages, potentially moving it.
+		/// Returns the new pages address, or null if not supported by the provider.
+		virtual void* reallocate_pages(void*, size_t, size_t) noexcept { return nullptr; }
+
+		/// @brief Release the physical memory of pages inside an allocated page run.
+		/// The pages must stay accessible (recommitted on next access).
+		/// Returns false if not supported by the provider.
+		virtual bool decommit_pages(void*, size_t) noexcept { return false; }
+
+		/// @brief Set the preferred NUMA node of a run of pages that was not touched yet.
+		/// Returns false if not supported by the provider.
+		virtual bool bind_pages(void*, size_t, unsigned) noexcept { return false; }
+
 		/// @brief Tells if this providers owns the pages, i.e. pages need
 		/// to be deallocated when parent BaseMemoryManager is destroyed.
 		virtual bool own_pages() const noexcept = 0;
 
+		/// @brief Tells if the page run starting at given address is released by reset() at once,
+		/// and therefore does not need to be deallocated individually in BaseMemoryManager::clear().
+		virtual bool released_on_reset(void*) const noexcept { return false; }
+
+		/// @brief Tells if given address is the start of a page run currently allocated from this provider.
+		/// Used to find the owner of a page run of a shared heap, which is not stored in the process page map.
+		/// Returns false if not supported by the provider.
+		virtual bool allocated_run(const void*) const noexcept { return false; }
+
+		/// @brief Returns the file descriptor of the file backing the pages, or -1 if the pages are not file backed.
+		/// The descriptor must not be closed, and stays valid until the provider is reset or destroyed.
+		virtual int file_descriptor() const noexcept { return -1; }
+
+		/// @brief Returns an area of MICRO_PERSISTENT_AREA_SIZE bytes stored with the pages, used by the
+		/// parent BaseMemoryManager to save its state when the pages outlive the process (see MicroPersistent).
+		/// Returns null if the pages are not persistent.
+		virtual void* persistent_area() noexcept { return nullptr; }
+
+		/// @brief Returns the time in nanoseconds spent preallocating pages on construction, 0 if none.
+		virtual std::uint64_t prealloc_time_ns() const noexcept { return 0; }
+
 		virtual bool is_valid() const noexcept = 0;
 
 		/// @brief Reset page provider in an empty valid state, ready to provide new pages.
@@ -79,16 +115,50 @@ namespace micro
 		bool log_enabled(micro_log_level l) const noexcept { return d_params->log_level >= static_cast<unsigned>(l); }
 	};
 
-	/// @brief Page provider using OS page allocation/deallocation mechanisms
+	/// @brief Page provider using OS page allocation/deallocation mechanisms.
+	///
+	/// Released page runs are decommitted based on parameters::decommit.
+	/// With MicroDecommitFree and MicroDecommitNone, up to MICRO_DECOMMIT_CACHE_RUNS
+	/// released page runs are kept (lazily decommitted or committed) and reused
+	/// by further allocations of the same size.
 	class MICRO_EXPORT_CLASS OsPageProvider : public BasePageProvider
 	{
+		struct CachedRun
+		{
+			void* pages;
+			size_t pcount;
+		};
+		spinlock d_lock;
+		std::atomic<unsigned> d_cache_count{ 0 };
+		CachedRun d_cache[MICRO_DECOMMIT_CACHE_RUNS];
+		const size_t d_huge_size; // huge page size, 0 if huge pages are disabled
+		std::atomic<bool> d_huge_warned{ false };
+
+		/// @brief Tells if a page run of pcount pages is made of whole huge pages
+		bool is_huge_run(size_t pcount) const noexcept { return d_huge_size && (pcount * os_page_size()) % d_huge_size == 0; }
+		void* allocate_huge_pages(size_t pcount) noexcept;
+		bool free_pages(void* p, size_t pcount) noexcept;
+
 	public:
 		OsPageProvider(const parameters& params) noexcept
 		  : BasePageProvider(params)
+		  , d_huge_size(params.huge_pages != MicroHugePagesNone ? os_huge_page_size() : 0)
+		{
+		}
+		virtual ~OsPageProvider() noexcept override { reset(); }
+		virtual void* allocate_pages(size_t pcount) noexcept override;
+		virtual bool deallocate_pages(void* p, size_t pcount) noexcept override;
+		virtual bool decommit_pages(void* p, size_t pcount) noexcept override;
+		virtual void reset() noexcept override;
+		virtual void* reallocate_pages(void* p, size_t old_pcount, size_t new_pcount) noexcept override
 		{
+			// Remapping would break the huge page alignment (and fails on explicit huge pages)
+			if (is_huge_run(old_pcount) || is_huge_run(new_pcount))
+				return nullptr;
+			return os_remap_pages(p, old_pcount, new_pcount);
 		}
-		virtual void* allocate_pages(size_t pcount) noexcept override { return os_allocate_pages(pcount); }
-		virtual bool deallocate_pages(void* p, size_t pcount) noexcept override { return os_free_pages(p, pcount); }
+		virtual size_t huge_page_size() const noexcept override { return d_huge_size; }
+		virtual bool bind_pages(void* p, size_t pcount, unsigned node) noexcept override { return os_bind_pages(p, pcount, node); }
 		virtual size_t page_size() const noexcept override { return os_page_size(); }
 		virtual size_t allocation_granularity() const noexcept override { return os_allocation_granularity(); }
 		virtual size_t page_size_bits() const noexcept override
@@ -103,195 +173,103 @@ namespace micro
 	/// @brief Page provider using a user provided buffer to allocate/deallocate pages.
 	/// The size of one page is given in the constructor.
 	///
-	/// MemoryPageProvider internally uses 2 sorted sets of free pages: one sorted by page address
-	/// and another sorted by page count.
+	/// MemoryPageProvider splits the buffer in a metadata area (one PageEntry per page) followed by the pages.
+	/// Free page runs are managed with a two levels segregated fit allocator (TLSF): free runs are linked in
+	/// lists indexed by their page count (first level: power of 2, second level: 16 linear subdivisions),
+	/// and two bitmaps tell which lists are non empty.
 	///
-	/// When allocating pages, MemoryPageProvider first look in the set of free pages for the lowest possible
-	/// a page run that fits required page count. If found, this page run is removed from the set(s), and
-	/// possible remaining pages are added back to the set(s).
+	/// Allocating and deallocating pages are O(1): finding a free run is a couple of bit scans, and merging
+	/// with neighbor free runs uses the boundary tags (page count and free flag) stored in the PageEntry of
+	/// the first and last page of each run. No memory is allocated for the bookkeeping, and all links are
+	/// page indexes, independant from the buffer address.
 	///
-	/// If no big enough free page run is found, the page head pointer (pointing to the very end of provided buffer)
-	/// is shifted left if possible by the required amount of pages. Thus, pages are carved from the right side
-	/// of provided buffer.
-	///
-	/// The internal sets are standard std::set and std::multiset objects. They both use a custom allocator that
-	/// provides memory chunks from the beginning of the buffer. Therefore, page allocation becomes impossible
-	/// when the tail pointer of sets allocators meet the head pointer of carved pages.
+	/// Initially, the buffer is a single free run, and pages are carved from its right side.
 	///
 	class MICRO_EXPORT_CLASS MemoryPageProvider : public BasePageProvider
 	{
-		template<class T>
-		friend struct SetAllocator;
-
-		// Let's use std::uintptr_t to make sure that PageEntry has the size of 2 pointers
+		using index_type = std::uint32_t;
 		using size_type = std::uintptr_t;
 
-		// Page description (address and size in bytes)
-		struct PageEntry
-		{
-			char* page{ nullptr };
-			size_type size{ 0 }; // size of the page span in bytes
-
-			// forward list of PageEntry, used by custom std::set allocator
-			PageEntry* next() noexcept { return reinterpret_cast<PageEntry*>(page); }
-			void set_next(PageEntry* n) noexcept { page = reinterpret_cast<char*>(n); }
-		};
-
-		// Sort PageEntry by size
-		struct LessSize
-		{
-			bool operator()(const PageEntry& l, const PageEntry& r) const noexcept { return l.size < r.size; }
-		};
-
-		// Sort PageEntry by address
-		struct LessAddr
-		{
-			bool operator()(const PageEntry& l, const PageEntry& r) const noexcept { return l.page < r.page; }
-		};
-
-		// Custom allocator for std::set and std::multiset
-		template<class T>
-		struct SetAllocator : std::allocator<T>
-		{
-			using is_always_equal = std::false_type;
-			using propagate_on_container_swap = std::true_type;
-			using propagate_on_container_copy_assignment = std::true_type;
-			using propagate_on_container_move_assignment = std::true_type;
-			template<class Other>
-			struct rebind
-			{
-				using other = SetAllocator<Other>;
-			};
-
-			MemoryPageProvider* mgr{ nullptr };
-			SetAllocator(MemoryPageProvider* d) noexcept
-			  : mgr(d)
-			{
-			}
-			SetAllocator(const SetAllocator& other) noexcept
-			  : mgr(other.mgr)
-			{
-			}
-			template<class Other>
-			SetAllocator(const SetAllocator<Other>& other) noexcept
-			  : mgr(other.mgr)
-			{
-			}
-			SetAllocator& operator=(const SetAllocator& other) noexcept
-			{
-				mgr = other.mgr;
-				return *this;
-			}
-			bool operator==(const SetAllocator& other) const noexcept { return mgr == other.mgr; }
-			bool operator!=(const SetAllocator& other) const noexcept { return mgr != other.mgr; }
-
-			void deallocate(T* p, const size_t count) noexcept
-			{
-				// add to free list
-				PageEntry* entry = reinterpret_cast<PageEntry*>(p);
-				entry->size = sizeof(T) * count;
-				entry->set_next(mgr->first_free);
-				mgr->first_free = entry;
-			}
-
-			T* allocate(const size_t count)
-			{
-				size_t bytes = count * sizeof(T);
-				// first, look in free entries
-				PageEntry* prev = nullptr;
-				PageEntry* cur = mgr->first_free;
-				while (cur) {
-					if (cur->size >= bytes) {
-						// remove and return
-						if (!prev)
-							mgr->first_free = cur->next();
-						else
-							prev->set_next(cur->next());
-						return reinterpret_cast<T*>(cur);
-					}
-					prev = cur;
-					cur = cur->next();
-				}
-				// use tail
-				if (mgr->set_tail + bytes > mgr->page_head)
-					throw std::bad_alloc();
-				T* p = reinterpret_cast<T*>(mgr->set_tail);
-				mgr->set_tail += bytes;
-				return p;
-			}
-			T* allocate(const size_t count, const void*) { return allocate(count); }
-			size_t max_size() const noexcept { return static_cast<size_t>(-1) / sizeof(T); }
-		};
+		static constexpr index_type nil = static_cast<index_type>(-1);
+		static constexpr index_type free_flag = 1u << 31u;
+		static constexpr unsigned sl_bits = 4;
+		static constexpr unsigned sl_count = 1u << sl_bits;
+		static constexpr unsigned fl_count = 31 - sl_bits + 1;
 
-		// Set proxy, used to avoid calling default constructor and destructor of std::set/std::multiset
-		template<class Set>
-		struct alignas(Set) SetProxy
+		// Boundary tag of a page run, stored for its first and last page.
+		// next and prev (free list links) are only valid for the first page of a free run.
+		struct PageEntry
 		{
-			char data[sizeof(Set)];
-			Set* set() noexcept { return reinterpret_cast<Set*>(data); }
-			const Set* set() const noexcept { return reinterpret_cast<const Set*>(data); }
+			index_type count; // page count, combined with free_flag
+			index_type next;
+			index_type prev;
 		};
 
 		using lock_type = spinlock;
-		using allocator_type = SetAllocator<PageEntry>;
-		using set_size_type = std::multiset<PageEntry, LessSize, allocator_type>;
-		using set_addr_type = std::set<PageEntry, LessAddr, allocator_type>;
 
 		// global lock
 		lock_type lock;
 		// allow using os_allocate_pages
 		bool grow;
+		// buffer is a reserved address range, commit pages on demand
+		bool commit;
 		// user provided buffer
 		char* buffer{ nullptr };
 		// user provided buffer size
 		size_type buffer_size{ 0 };
-		// page head position, used to carve new pages. Points to the end of the buffer.
-		char* page_head{ nullptr };
-		// sets allocator tail position, points to the beginning of the buffer.
-		char* set_tail{ nullptr };
-
-		// First free memory block in order to recycle memory blocks deallocated by std::set/multiset
-		PageEntry* first_free{ nullptr };
-
-		// Set of PageEntry sorted by size
-		SetProxy<set_size_type> by_size;
-		// Set of PageEntry sorted by address
-		SetProxy<set_addr_type> by_addr;
+		// commit mode: one bit per OS page of the metadata area, set if committed
+		std::uint64_t* meta_committed{ nullptr };
+		// one PageEntry per page
+		PageEntry* entries{ nullptr };
+		// first page, aligned on page size
+		char* pages{ nullptr };
+		// number of pages
+		index_type pages_count{ 0 };
+
+		// Bitmap of non empty first level lists
+		std::uint32_t fl_bitmap{ 0 };
+		// Bitmaps of non empty second level lists
+		std::uint32_t sl_bitmap[fl_count];
+		// Free lists heads
+		index_type heads[fl_count][sl_count];
 
 		unsigned p_size{ 4096 };
 		unsigned p_size_bits{ 12 };
 		std::atomic<size_type> page_count{ 0 };
 
-		// Erase a PageEntry from by_size and by_addr
-		template<class It1, class It2>
-		void erase_entry(PageEntry e, It1 addr_it, It2 size_it)
+		// Compute the list of a page count
+		static MICRO_ALWAYS_INLINE void mapping(index_type count, unsigned& fl, unsigned& sl) noexcept
 		{
-			// Take PageEntry by value as it will be invalidated
-
-			// Erase entry from address map
-			if (addr_it != by_addr.set()->end())
-				by_addr.set()->erase(addr_it);
-			else
-				by_addr.set()->erase(e);
-
-			// Erase entry from size map
-			if (size_it != by_size.set()->end())
-				by_size.set()->erase(size_it);
+			if (count < sl_count) {
+				fl = 0;
+				sl = count;
+			}
 			else {
-				auto range = by_size.set()->equal_range(e);
-				for (auto it = range.first; it != range.second; ++it) {
-					if (it->page == e.page) {
-						by_size.set()->erase(it);
-						return;
-					}
-				}
+				unsigned b = bit_scan_reverse_32(count);
+				fl = b - sl_bits + 1;
+				sl = (count >> (b - sl_bits)) - sl_count;
 			}
 		}
-		// Insert a PageEntry into by_size and by_addr
-		void insert_entry(const PageEntry& e);
+		// Compute the buffer layout (metadata area and pages), clear the free lists
+		bool set_buffer(char* b, size_type size) noexcept;
+		// Commit the metadata area of given entry (commit mode only)
+		bool commit_entry(index_type idx) noexcept;
+		// Set the boundary tags of a run
+		void tag(index_type idx, index_type count, index_type flag) noexcept;
+		// Insert a free run into its list
+		void insert_free(index_type idx, index_type count) noexcept;
+		// Remove a free run from its list
+		void remove_free(index_type idx, index_type count) noexcept;
+		// Find a free run of at least count pages, or nil
+		index_type find_free(index_type count) noexcept;
+		// Convert a number of pages to a number of OS pages (commit mode only)
+		size_t os_pages(size_t pcount) const noexcept { return (pcount << p_size_bits) / os_page_size(); }
 
 	public:
-		MemoryPageProvider(const parameters& params, unsigned psize, bool allow_grow) noexcept;
+		/// @brief Construct from a page size.
+		/// If commit_on_demand is true, the buffer passed to init() is a reserved address range (see os_reserve_pages()):
+		/// pages are committed on allocation and decommitted on deallocation.
+		MemoryPageProvider(const parameters& params, unsigned psize, bool allow_grow, bool commit_on_demand = false) noexcept;
 		MemoryPageProvider(const parameters& params, unsigned psize, bool allow_grow, char* b, size_type size) noexcept
 		  : MemoryPageProvider(params, psize, allow_grow)
 		{
@@ -302,11 +280,30 @@ namespace micro
 		///
 		void init(char* b, size_type size) noexcept;
 
+		/// @brief Init the MemoryPageProvider from a buffer already managed by another MemoryPageProvider,
+		/// like a persistent file mapped at the same address. Allocated pages are kept, and the free lists
+		/// are rebuilt from the boundary tags. Returns false if the metadata area is inconsistent.
+		bool attach(char* b, size_type size) noexcept;
+
+		/// @brief Returns the bytes used by the bookkeeping of a buffer of pcount pages of psize bytes.
+		static size_t metadata_bytes(size_t pcount, size_t psize) noexcept { return ((pcount * sizeof(PageEntry) + psize - 1u) / psize) * psize; }
+
 		bool own(void* ptr) const noexcept;
 		bool empty() const noexcept;
 		size_t max_pages() const noexcept;
 		size_t allocated_pages() const noexcept { return page_count; }
 
+		/// @brief Call fun(pages, pcount) for each free run
+		template<class Fun>
+		void for_each_free_run(Fun&& fun) noexcept
+		{
+			std::lock_guard<lock_type> ll(lock);
+			for (unsigned fl = 0; fl < fl_count; ++fl)
+				for (unsigned sl = 0; sl < sl_count; ++sl)
+					for (index_type idx = heads[fl][sl]; idx != nil; idx = entries[idx].next)
+						fun(pages + (static_cast<size_type>(idx) << p_size_bits), static_cast<size_t>(entries[idx].count & ~free_flag));
+		}
+
 		/// @brief Allocate and return pcount pages of size page_size()
 		virtual void* allocate_pages(size_t pcount) noexcept override;
 
@@ -316,14 +313,22 @@ namespace micro
 		virtual size_t page_size() const noexcept override;
 		virtual size_t page_size_bits() const noexcept override;
 		virtual bool own_pages() const noexcept override;
+		virtual bool released_on_reset(void* p) const noexcept override { return commit && own(p); }
+		virtual bool allocated_run(const void* p) const noexcept override;
 		virtual void reset() noexcept override;
 		virtual bool is_valid() const noexcept override { return buffer != nullptr; }
 	};
 
 #ifndef MICRO_NO_FILE_MAPPING
 	/// @brief BasePageProvider allocating pages from a memory mapped file
+	///
+	/// With the MicroPersistent flag, the file starts with a header recording the address of each
+	/// file view, followed by the area returned by persistent_area(). Opening an existing persistent
+	/// file maps all views at their previous addresses, so that the pages and the memory manager
+	/// state they contain are usable as is.
 	class MICRO_EXPORT_CLASS FilePageProvider : public BasePageProvider
 	{
+	protected:
 		// Combination of MemoryPageProvider and forward linked list
 		struct MemPageProvider
 		{
@@ -332,6 +337,21 @@ namespace micro
 			MemPageProvider* next;
 		};
 
+		// Header of a persistent file, followed by the persistent area
+		struct alignas(16) PersistentHeader
+		{
+			struct View
+			{
+				std::uint64_t address;
+				std::uint64_t size;
+			};
+			std::uint64_t magic;			// MICRO_PERSISTENT_MAGIC
+			std::uint32_t page_size;		// provider page size
+			std::uint32_t attached;			// non zero while a process uses the file
+			std::uint32_t view_count;		// number of file views
+			View views[MICRO_MAX_PERSISTENT_VIEWS]; // address and size of each view, in file order
+		};
+
 		unsigned p_size;		 // page size
 		unsigned p_size_bits;		 // page size bits
 		double d_grow_factor;		 // growth factor, usually 2
@@ -342,8 +362,21 @@ namespace micro
 		unsigned d_flags;		 // initial flags
 		char d_filename[MICRO_MAX_PATH]; // filename
 		char d_basename[MICRO_MAX_PATH]; // copy of params().file_page_provider
+		PersistentHeader* d_header;	 // persistent file header (MicroPersistent only)
+		bool d_zeroed;			 // free pages always read as zeros, no need to clear them on allocation
 		spinlock d_lock;		 // global lock
 
+		// Bytes used by the persistent file header and the persistent area
+		size_t header_bytes() const noexcept { return (sizeof(PersistentHeader) + MICRO_PERSISTENT_AREA_SIZE + p_size - 1u) & ~static_cast<size_t>(p_size - 1u); }
+		// Create a MemPageProvider at offset bytes of given view, either empty or attached to the view content
+		bool add_view(memory_map_file_view&& view, size_t offset, bool attach) noexcept;
+		// Create or reopen a persistent file
+		bool open_persistent(const char* filename, std::uint64_t size) noexcept;
+		// Unmap all views and close the file
+		void close() noexcept;
+		// Returns the MemPageProvider owning given address, or null
+		MemPageProvider* find_view(void* p) const noexcept;
+
 	public:
 		FilePageProvider(const parameters& params, unsigned psize, double grow_factor) noexcept;
 		FilePageProvider(const parameters& params, unsigned psize, double grow_factor, const char* filename, std::uint64_t size, unsigned flags = MicroStaticSize) noexcept
@@ -366,22 +399,58 @@ namespace micro
 		/// to be deallocated when parent BaseMemoryManager is destroyed.
 		virtual bool own_pages() const noexcept override { return false; }
 
+		virtual void* persistent_area() noexcept override { return d_header ? d_header + 1 : nullptr; }
+#ifndef _WIN32
+		virtual int file_descriptor() const noexcept override { return d_first ? d_file.handle() : -1; }
+#endif
+
 		/// @brief Reset page provider in an empty valid state, ready to provide new pages.
 		/// Called in BaseMemoryManager::clear()
-		virtual void reset() noexcept override { init(current_filename(), current_size(), current_flags()); }
+		virtual void reset() noexcept override;
 		virtual bool is_valid() const noexcept override { return d_first != nullptr; }
 	};
+
+#ifdef MICRO_HAS_MEMFD
+	/// @brief BasePageProvider allocating pages from an anonymous memory file (Linux memfd_create).
+	///
+	/// Works like FilePageProvider (the file grows with the MicroGrowing flag), without any file
+	/// system path or disk I/O. Deallocated and decommitted pages are given back to the kernel by
+	/// punching holes in the file. The file descriptor (see file_descriptor()) can be used to map
+	/// the pages a second time, or be sent to another process over a Unix socket.
+	class MICRO_EXPORT_CLASS MemfdPageProvider : public FilePageProvider
+	{
+	public:
+		MemfdPageProvider(const parameters& params, unsigned psize, double grow_factor, std::uint64_t size, unsigned flags = MicroStaticSize) noexcept
+		  : FilePageProvider(params, psize, grow_factor)
+		{
+			init(size, flags);
+		}
+		/// @brief Create a new anonymous file of given size, invalidating previously allocated pages
+		bool init(std::uint64_t size, unsigned flags = MicroStaticSize) noexcept;
+
+		virtual bool deallocate_pages(void* p, size_t pcount) noexcept override;
+		virtual bool decommit_pages(void* p, size_t pcount) noexcept override;
+		virtual void reset() noexcept override { init(current_size(), current_flags()); }
+	};
+#endif
 #endif
 
 	/// @brief BasePageProvider that preallocates a certain amount of memory
+	///
+	/// Preallocated pages are faulted in on first access, unless requested otherwise
+	/// by parameters::prealloc_flags (see micro_prealloc_flags).
 	class MICRO_EXPORT_CLASS PreallocatePageProvider : public BasePageProvider
 	{
 	private:
 		void* d_pages;
 		size_t d_pcount;
+		bool d_huge; // pages allocated with os_allocate_huge_pages()
+		std::uint64_t d_time_ns;
 		MemoryPageProvider d_provider;
 		spinlock d_lock;
 
+		void populate() noexcept;
+
 	public:
 		PreallocatePageProvider(const parameters& params, size_t bytes, bool allow_grow) noexcept;
 		virtual ~PreallocatePageProvider() noexcept override;
@@ -395,59 +464,163 @@ namespace micro
 		virtual size_t page_size() const noexcept override { return d_provider.page_size(); }
 		virtual size_t page_size_bits() const noexcept override { return d_provider.page_size_bits(); }
 		virtual bool own_pages() const noexcept override { return true; }
+		virtual std::uint64_t prealloc_time_ns() const noexcept override { return d_time_ns; }
+		virtual void reset() noexcept override { d_provider.reset(); }
+		virtual bool is_valid() const noexcept override { return d_provider.is_valid(); }
+	};
+
+	/// @brief BasePageProvider that reserves a large range of address space and commits pages inside it on demand.
+	///
+	/// Page runs are carved contiguously from the reserved range, which drastically reduces the number of
+	/// memory mappings and makes all page runs of a heap share the same address range. Released page runs
+	/// are decommitted and made inaccessible. On reset() (BaseMemoryManager::clear()), the whole range is
+	/// decommitted at once, and it is released with a single call on destruction.
+	class MICRO_EXPORT_CLASS ReservePageProvider : public BasePageProvider
+	{
+	private:
+		void* d_pages;
+		size_t d_pcount;
+		MemoryPageProvider d_provider;
+
+	public:
+		ReservePageProvider(const parameters& params, size_t bytes, bool allow_grow) noexcept;
+		virtual ~ReservePageProvider() noexcept override;
+
+		/// @brief Allocate and return pcount pages of size page_size()
+		virtual void* allocate_pages(size_t pcount) noexcept override { return d_provider.allocate_pages(pcount); }
+
+		/// @brief Deallocate pcount pages starting at address p
+		virtual bool deallocate_pages(void* p, size_t pcount) noexcept override { return d_provider.deallocate_pages(p, pcount); }
+
+		virtual bool decommit_pages(void* p, size_t pcount) noexcept override { return os_decommit_pages(p, pcount); }
+		virtual size_t page_size() const noexcept override { return d_provider.page_size(); }
+		virtual size_t page_size_bits() const noexcept override { return d_provider.page_size_bits(); }
+		virtual bool own_pages() const noexcept override { return true; }
+		virtual bool released_on_reset(void* p) const noexcept override { return d_provider.released_on_reset(p); }
 		virtual void reset() noexcept override { d_provider.reset(); }
 		virtual bool is_valid() const noexcept override { return d_provider.is_valid(); }
+
+		/// @brief Tells if given address belongs to the reserved range
+		bool own(void* p) const noexcept { return d_provider.own(p); }
 	};
 
 	/// @brief Generic page provider as stored in MemoryManager class
-	class MICRO_EXPORT_CLASS GenericPageProvider : public BasePageProvider
+	///
+	/// GenericPageProvider is not polymorphic, and calls the MemoryPageProvider without virtual dispatch:
+	/// the page provider of a shared heap (see micro_heap_create_shared()) lives in a mapping used by several
+	/// processes, where its virtual table pointer is only valid in the process that created the heap.
+	class MICRO_EXPORT_CLASS GenericPageProvider
 	{
 		static constexpr size_t sizeof_mem_provider = sizeof(PreallocatePageProvider);
+#ifdef MICRO_HAS_MEMFD
+		static constexpr size_t sizeof_file_provider = sizeof(MemfdPageProvider);
+#else
 		static constexpr size_t sizeof_file_provider = sizeof(FilePageProvider);
-		static constexpr size_t sizeof_data = sizeof_mem_provider > sizeof_file_provider ? sizeof_mem_provider : sizeof_file_provider;
+#endif
+		static constexpr size_t sizeof_os_provider = sizeof(OsPageProvider);
+		static constexpr size_t sizeof_reserve_provider = sizeof(ReservePageProvider);
+		static constexpr size_t sizeof_max_provider = sizeof_mem_provider > sizeof_file_provider ? sizeof_mem_provider : sizeof_file_provider;
+		static constexpr size_t sizeof_max_os_provider = sizeof_reserve_provider > sizeof_os_provider ? sizeof_reserve_provider : sizeof_os_provider;
+		static constexpr size_t sizeof_data = sizeof_max_provider > sizeof_max_os_provider ? sizeof_max_provider : sizeof_max_os_provider;
 
 		alignas(16) char d_data[sizeof_data];
-		BasePageProvider* d_provider;
+		BasePageProvider* d_provider; // process local page provider, null for the MemoryPageProvider
+		const parameters* d_params;
+
+		MemoryPageProvider* memory() noexcept { return reinterpret_cast<MemoryPageProvider*>(d_data); }
+		const MemoryPageProvider* memory() const noexcept { return reinterpret_cast<const MemoryPageProvider*>(d_data); }
+		void destroy() noexcept
+		{
+			if (d_provider)
+				d_provider->~BasePageProvider();
+			else
+				memory()->MemoryPageProvider::~MemoryPageProvider();
+		}
 
 	public:
+		MICRO_DELETE_COPY(GenericPageProvider)
+
 		GenericPageProvider(const parameters& params) noexcept
-		  : BasePageProvider(params)
+		  : d_params(&params)
 		{
 			d_provider = new (d_data) OsPageProvider(params);
 		}
 
 		void setOSProvider() noexcept
 		{
-			d_provider->~BasePageProvider();
+			destroy();
 			d_provider = new (d_data) OsPageProvider(params());
 		}
 		void setMemoryProvider(unsigned psize, bool grow, void* p, std::uintptr_t size) noexcept
 		{
-			d_provider->~BasePageProvider();
-			d_provider = new (d_data) MemoryPageProvider(params(), psize, grow, static_cast<char*>(p), size);
+			destroy();
+			new (d_data) MemoryPageProvider(params(), psize, grow, static_cast<char*>(p), size);
+			d_provider = nullptr;
 		}
 #ifndef MICRO_NO_FILE_MAPPING
 		void setFileProvider(unsigned psize, double grow_factor, const char* filename, std::uint64_t size, unsigned flags = 0) noexcept
 		{
-			d_provider->~BasePageProvider();
+			destroy();
 			d_provider = new (d_data) FilePageProvider(params(), psize, grow_factor, filename, size, flags);
 		}
+#endif
+#ifdef MICRO_HAS_MEMFD
+		void setMemfdProvider(unsigned psize, double grow_factor, std::uint64_t size, unsigned flags = 0) noexcept
+		{
+			destroy();
+			d_provider = new (d_data) MemfdPageProvider(params(), psize, grow_factor, size, flags);
+		}
 #endif
 		void setPreallocatedPageProvider(size_t bytes, bool grow) noexcept
 		{
-			d_provider->~BasePageProvider();
+			destroy();
 			d_provider = new (d_data) PreallocatePageProvider(params(), bytes, grow);
 		}
+		void setReservePageProvider(size_t bytes, bool grow) noexcept
+		{
+			destroy();
+			d_provider = new (d_data) ReservePageProvider(params(), bytes, grow);
+		}
+
+		~GenericPageProvider() noexcept { destroy(); }
 
-		virtual ~GenericPageProvider() override { d_provider->~BasePageProvider(); }
-		virtual void* allocate_pages(size_t pcount) noexcept override { return d_provider->allocate_pages(pcount); }
-		virtual bool deallocate_pages(void* p, size_t pcount) noexcept override { return d_provider->deallocate_pages(p, pcount); }
-		virtual size_t page_size() const noexcept override { return d_provider->page_size(); }
-		virtual size_t page_size_bits() const noexcept override { return d_provider->page_size_bits(); }
-		virtual size_t allocation_granularity() const noexcept override { return d_provider->allocation_granularity(); }
-		virtual bool own_pages() const noexcept override { return d_provider->own_pages(); }
-		virtual void reset() noexcept override { d_provider->reset(); }
-		virtual bool is_valid() const noexcept override { return d_provider->is_valid(); }
+		// Qualified calls below bypass the virtual table of the MemoryPageProvider
+		void* allocate_pages(size_t pcount) noexcept { return d_provider ? d_provider->allocate_pages(pcount) : memory()->MemoryPageProvider::allocate_pages(pcount); }
+		bool deallocate_pages(void* p, size_t pcount) noexcept
+		{
+			return d_provider ? d_provider->deallocate_pages(p, pcount) : memory()->MemoryPageProvider::deallocate_pages(p, pcount);
+		}
+		void* reallocate_pages(void* p, size_t old_pcount, size_t new_pcount) noexcept
+		{
+			return d_provider ? d_provider->reallocate_pages(p, old_pcount, new_pcount) : memory()->MemoryPageProvider::reallocate_pages(p, old_pcount, new_pcount);
+		}
+		bool decommit_pages(void* p, size_t pcount) noexcept { return d_provider ? d_provider->decommit_pages(p, pcount) : memory()->MemoryPageProvider::decommit_pages(p, pcount); }
+		bool bind_pages(void* p, size_t pcount, unsigned node) noexcept
+		{
+			return d_provider ? d_provider->bind_pages(p, pcount, node) : memory()->MemoryPageProvider::bind_pages(p, pcount, node);
+		}
+		size_t page_size() const noexcept { return d_provider ? d_provider->page_size() : memory()->MemoryPageProvider::page_size(); }
+		size_t page_size_bits() const noexcept { return d_provider ? d_provider->page_size_bits() : memory()->MemoryPageProvider::page_size_bits(); }
+		// BasePageProvider::allocation_granularity() calls the virtual page_size()
+		size_t allocation_granularity() const noexcept { return d_provider ? d_provider->allocation_granularity() : memory()->MemoryPageProvider::page_size(); }
+		size_t huge_page_size() const noexcept { return d_provider ? d_provider->huge_page_size() : memory()->MemoryPageProvider::huge_page_size(); }
+		bool own_pages() const noexcept { return d_provider ? d_provider->own_pages() : memory()->MemoryPageProvider::own_pages(); }
+		bool released_on_reset(void* p) const noexcept { return d_provider ? d_provider->released_on_reset(p) : memory()->MemoryPageProvider::released_on_reset(p); }
+		bool allocated_run(const void* p) const noexcept { return d_provider ? d_provider->allocated_run(p) : memory()->MemoryPageProvider::allocated_run(p); }
+		void* persistent_area() noexcept { return d_provider ? d_provider->persistent_area() : memory()->MemoryPageProvider::persistent_area(); }
+		int file_descriptor() const noexcept { return d_provider ? d_provider->file_descriptor() : memory()->MemoryPageProvider::file_descriptor(); }
+		std::uint64_t prealloc_time_ns() const noexcept { return d_provider ? d_provider->prealloc_time_ns() : memory()->MemoryPageProvider::prealloc_time_ns(); }
+		void reset() noexcept
+		{
+			if (d_provider)
+				d_provider->reset();
+			else
+				memory()->MemoryPageProvider::reset();
+		}
+		bool is_valid() const noexcept { return d_provider ? d_provider->is_valid() : memory()->MemoryPageProvider::is_valid(); }
+
+		const parameters& params() const noexcept { return *d_params; }
+		bool log_enabled(micro_log_level l) const noexcept { return d_params->log_level >= static_cast<unsigned>(l); }
 	};
 }
 
@@ -135,14 +135,32 @@ namespace micro
 			p.page_size = MICRO_DEFAULT_PAGE_SIZE;
 		}
 
-		if (p.provider_type > MicroFileProvider) {
+		if (p.provider_type > MicroMemfdProvider) {
 			if (l != MicroNoLog)
 				print_safe(stderr, "WARNING invalid provider_type value: ", p.provider_type, "\n");
 			p.provider_type = MicroOSProvider;
 		}
 
-		if (p.page_file_flags > MicroGrowing)
-			p.page_file_flags = MicroGrowing;
+		if (p.decommit > MicroDecommitNone) {
+			if (l != MicroNoLog)
+				print_safe(stderr, "WARNING invalid decommit value: ", p.decommit, "\n");
+			p.decommit = MicroDecommitDontNeed;
+		}
+
+		if (p.huge_pages > MicroHugePagesExplicit) {
+			if (l != MicroNoLog)
+				print_safe(stderr, "WARNING invalid huge_pages value: ", p.huge_pages, "\n");
+			p.huge_pages = MicroHugePagesNone;
+		}
+
+		if (p.prealloc_flags > (MicroPreallocPopulate | MicroPreallocParallel | MicroPreallocLock | MicroPreallocHugePages)) {
+			if (l != MicroNoLog)
+				print_safe(stderr, "WARNING invalid prealloc_flags value: ", p.prealloc_flags, "\n");
+			p.prealloc_flags &= MicroPreallocPopulate | MicroPreallocParallel | MicroPreallocLock | MicroPreallocHugePages;
+		}
+
+		if (p.page_file_flags > (MicroGrowing | MicroPersistent))
+			p.page_file_flags &= MicroGrowing | MicroPersistent;
 
 		if (p.grow_factor <= 0 || p.grow_factor > 8) {
 			if (l != MicroNoLog)
@@ -195,6 +213,26 @@ namespace micro
 			char* end = env + strlen(env);
 			p.memory_limit = static_cast<uint64_t>(std::strtoll(env, &end, 10));
 		}
+		if (char* env = detail::mgetenv("MICRO_ARENA_PER_CPU")) {
+			char* end = env + strlen(env);
+			p.arena_per_cpu = (static_cast<unsigned>(std::strtol(env, &end, 10)));
+		}
+		if (char* env = detail::mgetenv("MICRO_REMOTE_FREE")) {
+			char* end = env + strlen(env);
+			p.remote_free = (static_cast<unsigned>(std::strtol(env, &end, 10)));
+		}
+		if (char* env = detail::mgetenv("MICRO_NUMA")) {
+			char* end = env + strlen(env);
+			p.numa = (static_cast<unsigned>(std::strtol(env, &end, 10)));
+		}
+		if (char* env = detail::mgetenv("MICRO_PURGE_DECAY_MS")) {
+			char* end = env + strlen(env);
+			p.purge_decay_ms = (static_cast<unsigned>(std::strtol(env, &end, 10)));
+		}
+		if (char* env = detail::mgetenv("MICRO_THREAD_CACHE_BYTES")) {
+			char* end = env + strlen(env);
+			p.thread_cache_bytes = static_cast<uint64_t>(std::strtoll(env, &end, 10));
+		}
 		if (char* env = detail::mgetenv("MICRO_LOG_LEVEL")) {
 			char* end = env + strlen(env);
 			p.log_level = (static_cast<unsigned>(std::strtol(env, &end, 10)));
@@ -212,6 +250,18 @@ namespace micro
 			char* end = env + strlen(env);
 			p.grow_factor = std::strtod(env, &end);
 		}
+		if (char* env = detail::mgetenv("MICRO_DECOMMIT")) {
+			char* end = env + strlen(env);
+			p.decommit = (static_cast<unsigned>(std::strtol(env, &end, 10)));
+		}
+		if (char* env = detail::mgetenv("MICRO_HUGE_PAGES")) {
+			char* end = env + strlen(env);
+			p.huge_pages = static_cast<unsigned>(std::strtol(env, &end, 10));
+		}
+		if (char* env = detail::mgetenv("MICRO_DECOMMIT_THRESHOLD")) {
+			char* end = env + strlen(env);
+			p.decommit_threshold = static_cast<uint64_t>(std::strtoll(env, &end, 10));
+		}
 		if (char* env = detail::mgetenv("MICRO_PROVIDER_TYPE")) {
 			char* end = env + strlen(env);
 			p.provider_type = (static_cast<unsigned>(std::strtoll(env, &end, 10)));
@@ -230,6 +280,10 @@ namespace micro
 			char* end = env + strlen(env);
 			p.page_memory_size = (static_cast<uint64_t>(std::strtoll(env, &end, 10)));
 		}
+		if (char* env = detail::mgetenv("MICRO_PREALLOC_FLAGS")) {
+			char* end = env + strlen(env);
+			p.prealloc_flags = (static_cast<unsigned>(std::strtol(env, &end, 10)));
+		}
 		if (char* env = detail::mgetenv("MICRO_PAGE_FILE_FLAGS")) {
 			char* end = env + strlen(env);
 			p.page_file_flags = (static_cast<unsigned>(std::strtol(env, &end, 10)));
@@ -288,16 +342,25 @@ namespace micro
 		print_generic(callback, opaque, MicroNoLog, nullptr, "allow_small_alloc_from_radix_tree\t%u\n", static_cast<unsigned>(allow_small_alloc_from_radix_tree));
 		print_generic(callback, opaque, MicroNoLog, nullptr, "deplete_arenas\t%u\n", deplete_arenas);
 		print_generic(callback, opaque, MicroNoLog, nullptr, "max_arenas\t%u\n", max_arenas);
+		print_generic(callback, opaque, MicroNoLog, nullptr, "arena_per_cpu\t%u\n", arena_per_cpu);
+		print_generic(callback, opaque, MicroNoLog, nullptr, "numa\t%u\n", numa);
+		print_generic(callback, opaque, MicroNoLog, nullptr, "remote_free\t%u\n", remote_free);
 		print_generic(callback, opaque, MicroNoLog, nullptr, "backend_memory\t" MICRO_U64F "\n", backend_memory);
 		print_generic(callback, opaque, MicroNoLog, nullptr, "memory_limit\t" MICRO_U64F "\n", memory_limit);
+		print_generic(callback, opaque, MicroNoLog, nullptr, "purge_decay_ms\t%u\n", purge_decay_ms);
+		print_generic(callback, opaque, MicroNoLog, nullptr, "thread_cache_bytes\t" MICRO_U64F "\n", thread_cache_bytes);
 		print_generic(callback, opaque, MicroNoLog, nullptr, "log_level\t%u\n", log_level);
 		print_generic(callback, opaque, MicroNoLog, nullptr, "page_size\t%u\n", page_size);
 		print_generic(callback, opaque, MicroNoLog, nullptr, "grow_factor\t%f\n", grow_factor);
 		print_generic(callback, opaque, MicroNoLog, nullptr, "disable_malloc_replacement\t%u\n", static_cast<unsigned>(disable_malloc_replacement));
 
 		print_generic(callback, opaque, MicroNoLog, nullptr, "provider_type\t%u\n", provider_type);
+		print_generic(callback, opaque, MicroNoLog, nullptr, "decommit\t%u\n", decommit);
+		print_generic(callback, opaque, MicroNoLog, nullptr, "huge_pages\t%u\n", huge_pages);
+		print_generic(callback, opaque, MicroNoLog, nullptr, "decommit_threshold\t" MICRO_U64F "\n", decommit_threshold);
 		print_generic(callback, opaque, MicroNoLog, nullptr, "page_memory_provider\t%p\n", static_cast<void*>(page_memory_provider));
 		print_generic(callback, opaque, MicroNoLog, nullptr, "page_memory_size\t" MICRO_U64F "\n",static_cast<uint64_t>(page_memory_size));
+		print_generic(callback, opaque, MicroNoLog, nullptr, "prealloc_flags\t%u\n", prealloc_flags);
 
 		print_generic(callback, opaque, MicroNoLog, nullptr, "page_file_provider\t%s\n", page_file_provider.data()[0] ? page_file_provider.data() : "");
 		print_generic(callback, opaque, MicroNoLog, nullptr, "page_file_provider_dir\t%s\n", page_file_provider_dir.data()[0] ? page_file_provider_dir.data() : "");
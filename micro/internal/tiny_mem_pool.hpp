@@ -163,6 +163,10 @@ namespace micro
 #endif
 
 			ParentType* parent{ nullptr }; // Parent TinyMemPool
+#ifndef MICRO_NO_LOCK
+			std::atomic<void*> remote_head{ nullptr }; // Lock-free list of objects freed by other arenas, drained by the owner
+			std::atomic<TinyBlockPool*> remote_next{ nullptr }; // Next block with remote frees for the same size class
+#endif
 
 			// Default ctor
 			TinyBlockPool() noexcept
@@ -222,11 +226,16 @@ namespace micro
 			// Deallocate object
 			MEM_POOL_INLINE bool deallocate(void* p, spinlock& ll) noexcept
 			{
-				TailType* b = static_cast<TailType*>(p);
-				TailType diff = static_cast<TailType>(reinterpret_cast<Bytes16*>(p) - reinterpret_cast<Bytes16*>(this));
-
 				// Lock the parent spinlock for this size class
 				ll.lock();
+				return deallocate_locked(p);
+			}
+
+			// Deallocate object, parent spinlock for this size class must be locked
+			MEM_POOL_INLINE bool deallocate_locked(void* p) noexcept
+			{
+				TailType* b = static_cast<TailType*>(p);
+				TailType diff = static_cast<TailType>(reinterpret_cast<Bytes16*>(p) - reinterpret_cast<Bytes16*>(this));
 
 				MICRO_ASSERT_DEBUG(this->header.first_free < get_chunk_size() && (header.first_free == 0 || header.first_free >= sizeof(TinyBlockPool) / 16), "");
 				MICRO_ASSERT_DEBUG(diff >= sizeof(TinyBlockPool) / 16 && diff < get_chunk_size(), "");
@@ -361,6 +370,40 @@ namespace micro
 				parent->d_data[idx].lock.unlock();
 			}
 
+#ifndef MICRO_NO_LOCK
+			/// @brief Give back objects freed by other arenas to their blocks.
+			/// Size class lock must be held.
+			void drain_remote_blocks(unsigned idx) noexcept
+			{
+				block* bl = d_data[idx].remote.exchange(nullptr, std::memory_order_acquire);
+				while (bl) {
+					// Read the next block first, as bl might be published again as soon as its list is empty.
+					// The release exchange orders this read before the next publication of bl.
+					block* next = bl->remote_next.load(std::memory_order_relaxed);
+					void* obj = bl->remote_head.exchange(nullptr, std::memory_order_acq_rel);
+					while (obj) {
+						void* n = *static_cast<void**>(obj);
+						bl->deallocate_locked(obj);
+						obj = n;
+					}
+					// The block provides free slots: move it to the front of the list.
+					// Empty blocks are kept, the next allocations will use them.
+					if (bl->left)
+						bl->remove();
+					bl->insert(static_cast<block*>(&d_data[idx].it), d_data[idx].it.right);
+					bl = next;
+				}
+			}
+
+			/// @brief Give back objects freed by other arenas to their blocks, and allocate one object.
+			/// Size class lock must be held.
+			MICRO_NOINLINE(void*) drain_remote(unsigned idx) noexcept
+			{
+				drain_remote_blocks(idx);
+				return d_data[idx].it.right->allocate();
+			}
+#endif
+
 			MICRO_NOINLINE(void*) allocate_from_pool_list(unsigned idx) noexcept
 			{
 				block* bl = d_data[idx].it.right;
@@ -388,10 +431,14 @@ namespace micro
 
 			BaseMemoryManager* d_mgr;
 
-			struct It
+			// With MICRO_PAD_LOCKS, each size class lives in its own cache line(s)
+			struct MICRO_CACHE_ALIGNED It
 			{
 				block_it it;
 				spinlock lock;
+#ifndef MICRO_NO_LOCK
+				std::atomic<block*> remote{ nullptr }; // Blocks with remote frees
+#endif
 			};
 			It d_data[SmallAllocation::class_count];
 			std::atomic<size_t> d_pool_count{ 0 };
@@ -407,6 +454,9 @@ namespace micro
 
 			MICRO_DELETE_COPY(TinyMemPool)
 
+			/// @brief Set the parent manager, used when a persistent heap is reopened by a new manager
+			void set_manager(BaseMemoryManager* mgr) noexcept { d_mgr = mgr; }
+
 			/// @brief Allocate object of given size
 			/// @param size size in bytes
 			/// @param force if true and no free slot available, allocate from a new block
@@ -423,6 +473,10 @@ namespace micro
 				void* res = d_data[idx].it.right->allocate();
 				if (MICRO_LIKELY(res))
 					return res;
+#ifndef MICRO_NO_LOCK
+				if (d_data[idx].remote.load(std::memory_order_relaxed) && (res = drain_remote(idx)))
+					return res;
+#endif
 				if((res = allocate_from_pool_list(idx)))
 					return res;
 				if (force)
@@ -430,6 +484,90 @@ namespace micro
 				return nullptr;
 			}
 
+			/// @brief Allocate up to count objects of given size, locking the size class only once.
+			/// Returns the number of allocated objects.
+			MICRO_NOINLINE(unsigned) allocate_batch(unsigned size, void** out, unsigned count) noexcept
+			{
+				// Note: size CANNOT be 0
+				unsigned idx = SmallAllocation::size_to_idx(size);
+				MICRO_ASSERT_DEBUG(idx < SmallAllocation::class_count, "");
+
+				std::lock_guard<spinlock> ll(d_data[idx].lock);
+
+				unsigned i = 0;
+				while (i < count) {
+					// Carve as many objects as possible from the front block
+					block* bl = d_data[idx].it.right;
+					while (i < count && (out[i] = bl->allocate()))
+						++i;
+					if (i == count)
+						break;
+#ifndef MICRO_NO_LOCK
+					// Drained blocks are moved to the front
+					if (d_data[idx].remote.load(std::memory_order_relaxed) && (out[i] = drain_remote(idx))) {
+						++i;
+						continue;
+					}
+#endif
+
+					void* res = allocate_from_pool_list(idx);
+					if (!res) {
+						if (!(res = allocate_from_new_block(SmallAllocation::idx_to_size(idx), idx)))
+							break;
+						// Object directly allocated from the radix tree (not a small object): always return it last
+						block* front = d_data[idx].it.right;
+						if (front == &d_data[idx].it || !front->is_inside(res)) {
+							out[i++] = res;
+							break;
+						}
+					}
+					out[i++] = res;
+				}
+				return i;
+			}
+
+			/// @brief Deallocate count objects, all belonging to given block, locking the size class only once.
+			static MICRO_NOINLINE(void) deallocate_batch(void** ptrs, unsigned count, block* p) noexcept
+			{
+				const auto idx = p->header.pool_idx_plus_one - 1u;
+				auto* parent = p->get_parent();
+				MICRO_ASSERT_DEBUG(idx < SmallAllocation::class_count, "");
+
+				parent->d_data[idx].lock.lock();
+				bool empty = false;
+				for (unsigned i = 0; i < count; ++i)
+					empty = p->deallocate_locked(ptrs[i]);
+				if (MICRO_UNLIKELY(empty || !p->left)) {
+					// A full (unlinked) block might be emptied by a single batch
+					if (empty && !p->left)
+						p->insert(static_cast<block*>(&parent->d_data[idx].it), parent->d_data[idx].it.right);
+					return handle_deallocate(parent, p, static_cast<unsigned>(idx));
+				}
+				parent->d_data[idx].lock.unlock();
+			}
+
+#ifndef MICRO_NO_LOCK
+			/// @brief Deallocate object from a thread using another arena.
+			/// The object is pushed to the block remote list without taking the size class lock,
+			/// and will be given back to the block on the next allocation miss of the owner arena.
+			static MEM_POOL_INLINE void deallocate_remote(void* ptr, block* p) noexcept
+			{
+				void* head = p->remote_head.load(std::memory_order_acquire);
+				do {
+					*static_cast<void**>(ptr) = head;
+				} while (!p->remote_head.compare_exchange_weak(head, ptr, std::memory_order_acq_rel, std::memory_order_acquire));
+
+				if (!head) {
+					// First remote free for this block: publish the block to the owner
+					auto& list = p->get_parent()->d_data[p->header.pool_idx_plus_one - 1u].remote;
+					block* first = list.load(std::memory_order_relaxed);
+					do {
+						p->remote_next.store(first, std::memory_order_relaxed);
+					} while (!list.compare_exchange_weak(first, p, std::memory_order_release, std::memory_order_relaxed));
+				}
+			}
+#endif
+
 			/// @brief Deallocate object from given block
 			static MEM_POOL_INLINE void deallocate(void* ptr, block* p) noexcept
 			{
@@ -441,7 +579,69 @@ namespace micro
 					return handle_deallocate(parent, p, static_cast<unsigned>(idx));
 				parent->d_data[idx].lock.unlock();
 			}
+
+			/// @brief Give back all empty blocks to the radix tree, even those kept for MICRO_TINY_POOL_CACHE.
+			/// Objects freed by other arenas are first given back to their blocks.
+			void release_empty_blocks() noexcept
+			{
+				for (unsigned idx = 0; idx < SmallAllocation::class_count; ++idx) {
+					block* to_free = nullptr;
+					{
+						std::lock_guard<spinlock> ll(d_data[idx].lock);
+#ifndef MICRO_NO_LOCK
+						drain_remote_blocks(idx);
+#endif
+						block* bl = d_data[idx].it.right;
+						while (bl != &d_data[idx].it) {
+							block* next = bl->right;
+							if (bl->empty()) {
+								bl->get_parent_run()->unset_pool(bl);
+								bl->remove();
+								bl->right = to_free;
+								to_free = bl;
+							}
+							bl = next;
+						}
+					}
+
+					// Deallocate blocks outside of the size class lock
+					while (to_free) {
+						block* next = to_free->right;
+#if MICRO_TINY_POOL_CACHE
+						d_pool_count.fetch_sub(1, std::memory_order_relaxed);
+#endif
+#if MICRO_USE_FIRST_ALIGNED_CHUNK
+						MediumChunkHeader* h = (MediumChunkHeader::from(to_free) - 1);
+						if (h->offset_prev == 0)
+							h->parent()->header.status = 0;
+#endif
+						memset(static_cast<void*>(to_free), 0, sizeof(block));
+						d_mgr->deallocate_no_tiny_pool(to_free);
+						to_free = next;
+					}
+				}
+			}
 		};
+
+		/// @brief Per-thread magazines of small objects, in front of the TinyMemPool
+		///
+		/// Cached objects are still considered as allocated by their TinyBlockPool.
+		/// Each magazine is only accessed by its owning thread, so that a hit is lock-free.
+		/// The bytes held by all thread caches are bounded by parameters::thread_cache_bytes.
+		///
+		struct ThreadCache
+		{
+			struct Magazine
+			{
+				unsigned count{ 0 };			   // number of cached objects
+				void* objs[MICRO_THREAD_CACHE_OBJECTS]; // cached objects, the last one is popped first
+			};
+
+			size_t credit{ 0 };   // reserved bytes not used by cached objects
+			size_t reserved{ 0 }; // bytes reserved from the global thread cache budget
+			Magazine mags[SmallAllocation::class_count];
+		};
+
 	} // end namespace detail
 
 } // end namespace micro
@@ -28,6 +28,18 @@
 #include "../bits.hpp"
 #include <atomic>
 
+// Vectorized scanning of multi-word masks, selected at compile time.
+// Define MICRO_NO_SIMD_MASK to force the portable version.
+#if !defined(MICRO_NO_SIMD_MASK) && defined(MICRO_ARCH_64) && defined(__AVX2__)
+#define MICRO_SIMD_MASK 2
+#include <immintrin.h>
+#elif !defined(MICRO_NO_SIMD_MASK) && defined(MICRO_ARCH_64) && defined(__SSE4_1__)
+#define MICRO_SIMD_MASK 1
+#include <smmintrin.h>
+#else
+#define MICRO_SIMD_MASK 0
+#endif
+
 namespace micro
 {
 	namespace detail
@@ -65,9 +77,53 @@ namespace micro
 		{
 			std::atomic<std::uint64_t> masks[N];
 
+			// Vector loads read the words as relaxed loads would (no tearing of aligned 64 bits words on x86),
+			// but not as a whole: concurrent modifications might be partially seen, as for the scalar version.
+			MICRO_ALWAYS_INLINE const std::uint64_t* words() const noexcept { return reinterpret_cast<const std::uint64_t*>(masks); }
+
+			/// @brief Returns a mask of the non null words
+			MICRO_ALWAYS_INLINE unsigned non_null_words() const noexcept
+			{
+				unsigned res = 0;
+				unsigned i = 0;
+#if MICRO_SIMD_MASK == 2
+				for (; i + 4 <= N; i += 4) {
+					__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words() + i));
+					unsigned eq = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(v, _mm256_setzero_si256()))));
+					res |= (~eq & 15u) << i;
+				}
+#endif
+#if MICRO_SIMD_MASK >= 1
+				for (; i + 2 <= N; i += 2) {
+					__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(words() + i));
+					unsigned eq = static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(v, _mm_setzero_si128()))));
+					res |= (~eq & 3u) << i;
+				}
+#endif
+				for (; i < N; ++i)
+					res |= static_cast<unsigned>(masks[i].load(std::memory_order_relaxed) != 0) << i;
+				return res;
+			}
+
 			MICRO_ALWAYS_INLINE UIntN_64bits() noexcept { memset(static_cast<void*>(masks), 0, sizeof(masks)); }
 			MICRO_ALWAYS_INLINE bool null() const noexcept
 			{
+#if MICRO_SIMD_MASK == 2
+				if (N % 4 == 0) {
+					__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words()));
+					for (unsigned i = 4; i < N; i += 4)
+						v = _mm256_or_si256(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words() + i)));
+					return _mm256_testz_si256(v, v) != 0;
+				}
+#endif
+#if MICRO_SIMD_MASK >= 1
+				if (N % 2 == 0) {
+					__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(words()));
+					for (unsigned i = 2; i < N; i += 2)
+						v = _mm_or_si128(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(words() + i)));
+					return _mm_testz_si128(v, v) != 0;
+				}
+#endif
 				for (unsigned i = 0; i < N; ++i)
 					if (masks[i].load(std::memory_order_relaxed))
 						return false;
@@ -92,11 +148,24 @@ namespace micro
 				if (m)
 					return bit_scan_forward_64(m) + idx * 64;
 
+#if MICRO_SIMD_MASK
+				// Find the next non null words at once.
+				// A word might be emptied meanwhile: try the following one.
+				unsigned nz = non_null_words() & ~((2u << idx) - 1u);
+				while (nz) {
+					const unsigned i = bit_scan_forward_32(nz);
+					m = masks[i].load(std::memory_order_relaxed);
+					if (MICRO_LIKELY(m))
+						return bit_scan_forward_64(m) + i * 64;
+					nz &= nz - 1u;
+				}
+#else
 				for (unsigned i = idx + 1; i < N; ++i) {
 					m = masks[i].load(std::memory_order_relaxed);
 					if (m)
 						return bit_scan_forward_64(m) + i * 64;
 				}
+#endif
 				return N * 64u;
 			}
 			MICRO_ALWAYS_INLINE unsigned scan_forward_small(unsigned start) const noexcept
@@ -44,9 +44,21 @@
 #else
 // Assume pthread is available
 #include <pthread.h>
+#include <unistd.h>
 #define MICRO_USE_PTHREAD
 #endif
 
+#if defined(__linux__) && !defined(MICRO_NO_LOCK)
+#include <sched.h>
+// Restartable sequences (glibc >= 2.35) give the current CPU with a single load
+#if defined(__has_include)
+#if __has_include(<sys/rseq.h>) && defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11 && (defined(__x86_64__) || defined(__aarch64__))
+#include <sys/rseq.h>
+#define MICRO_HAS_RSEQ
+#endif
+#endif
+#endif
+
 #include "bits.hpp"
 #include "internal/defines.hpp"
 
@@ -325,6 +337,19 @@ namespace micro
 				return data;
 			}
 
+		public:
+			/// @brief Function called with the thread id on thread exit
+			using exit_callback_type = void (*)(unsigned);
+			/// @brief Thread ids below this value are recycled and unique among alive threads
+			static constexpr unsigned max_threads = Data::max_threads;
+
+		private:
+			static std::atomic<exit_callback_type>& exit_callback() noexcept
+			{
+				static std::atomic<exit_callback_type> cb{ nullptr };
+				return cb;
+			}
+
 			/// @brief Thread local storage of thread identifier.
 			/// Since the thread id is recycled on thread destruction, we need
 			/// to provide a non empty class destructor.
@@ -347,8 +372,14 @@ namespace micro
 				{
 
 					Id* id = static_cast<Id*>(arg);
-					if (id->idx < Data::max_threads)
+					if (id->idx < Data::max_threads) {
+						// Notify before the id is recycled
+						if (exit_callback_type cb = exit_callback().load(std::memory_order_acquire))
+							cb(id->idx);
 						data().remove_idx(id->idx);
+					}
+					// Following calls to get_thread_id() must not return a recycled id
+					id->idx = Data::max_threads;
 #ifdef MICRO_USE_PTHREAD
 					pthread_key_delete(id->k);
 #endif
@@ -385,6 +416,8 @@ namespace micro
 			static MICRO_ALWAYS_INLINE unsigned get_max_thread_count() noexcept { return data().max_count; }
 			static MICRO_ALWAYS_INLINE unsigned get_mask() noexcept { return data().mask; }
 			static MICRO_ALWAYS_INLINE unsigned get_max_mask() noexcept { return data().max_mask; }
+			/// @brief Set the function called on thread exit, before the thread id is recycled
+			static void set_exit_callback(exit_callback_type cb) noexcept { exit_callback().store(cb, std::memory_order_release); }
 		};
 
 #endif
@@ -434,6 +467,45 @@ namespace micro
 	/// @brief Returns current thread id
 	MICRO_ALWAYS_INLINE size_t this_thread_id() noexcept { return detail::ThreadCounter::get_thread_id(); }
 
+	namespace detail
+	{
+		/// @brief Process tag used to build thread ids that are unique among
+		/// all processes sharing a heap (see micro_heap_create_shared()).
+		/// The tag is rebuilt in forked children.
+		class ProcessTag
+		{
+			static std::atomic<std::uint64_t>& value() noexcept
+			{
+				static std::atomic<std::uint64_t> v{ 0 };
+				return v;
+			}
+			static void reset() noexcept { value().store(0, std::memory_order_relaxed); }
+			static MICRO_NOINLINE(std::uint64_t) build() noexcept
+			{
+#ifdef MICRO_USE_PTHREAD
+				static int registered = pthread_atfork(nullptr, nullptr, reset);
+				(void)registered;
+				std::uint64_t tag = static_cast<std::uint64_t>(getpid());
+#else
+				std::uint64_t tag = static_cast<std::uint64_t>(GetCurrentProcessId());
+#endif
+				tag <<= 32u;
+				value().store(tag, std::memory_order_relaxed);
+				return tag;
+			}
+
+		public:
+			static MICRO_ALWAYS_INLINE std::uint64_t get() noexcept
+			{
+				std::uint64_t tag = value().load(std::memory_order_relaxed);
+				return MICRO_LIKELY(tag != 0) ? tag : build();
+			}
+		};
+	}
+
+	/// @brief Returns an id for the current thread, unique among all processes
+	MICRO_ALWAYS_INLINE std::uint64_t this_process_thread_id() noexcept { return detail::ProcessTag::get() | (this_thread_id() + 1u); }
+
 	/// @brief Returns current thread id suitable to select an arena.
 	/// Introduces flickering of the thread id for mono thread cases
 	/// as it greatly reduces the memory footprint.
@@ -449,15 +521,40 @@ namespace micro
 		return res;
 	}
 
+	/// @brief Returns the CPU currently running the calling thread.
+	/// The result is only a hint, as the thread might migrate right after the call.
+	MICRO_ALWAYS_INLINE unsigned this_cpu_id() noexcept
+	{
+#if defined(MICRO_HAS_RSEQ)
+		// Read the cpu_id field of the rseq area registered by glibc
+		if (MICRO_LIKELY(__rseq_size != 0)) {
+			const struct rseq* rs = reinterpret_cast<const struct rseq*>(static_cast<char*>(__builtin_thread_pointer()) + __rseq_offset);
+			int cpu = static_cast<int>(rs->cpu_id);
+			if (MICRO_LIKELY(cpu >= 0))
+				return static_cast<unsigned>(cpu);
+		}
+#endif
+#if defined(__linux__)
+		int cpu = sched_getcpu();
+		if (cpu >= 0)
+			return static_cast<unsigned>(cpu);
+#elif defined(_MSC_VER) || defined(__MINGW32__)
+		return static_cast<unsigned>(GetCurrentProcessorNumber());
+#endif
+		// Fallback to thread id
+		return static_cast<unsigned>(this_thread_id());
+	}
+
 	/// @brief Straightforward recursive spinlock implementation
 	///
 	class MICRO_EXPORT_CLASS recursive_spinlock
 	{
 		spinlock d_lock;
 		int d_count{ 0 };
-		size_t d_id{ 0 };
+		// Owner id, valid across processes for shared heaps
+		std::uint64_t d_id{ 0 };
 
-		bool try_lock(size_t id) noexcept
+		bool try_lock(std::uint64_t id) noexcept
 		{
 			std::lock_guard<spinlock> ll(d_lock);
 			if (d_count == 0) {
@@ -477,10 +574,10 @@ namespace micro
 		constexpr recursive_spinlock() noexcept {}
 		MICRO_DELETE_COPY(recursive_spinlock)
 
-		bool try_lock() noexcept { return try_lock(this_thread_id()); }
+		bool try_lock() noexcept { return try_lock(this_process_thread_id()); }
 		void lock() noexcept
 		{
-			auto id = this_thread_id();
+			auto id = this_process_thread_id();
 			while (!try_lock(id))
 				std::this_thread::yield();
 		}
@@ -509,6 +606,9 @@ namespace micro
 	/// as it greatly reduces the memory footprint.
 	MICRO_ALWAYS_INLINE size_t this_thread_id_for_arena() noexcept { return 0; }
 
+	/// @brief Returns the CPU currently running the calling thread
+	MICRO_ALWAYS_INLINE unsigned this_cpu_id() noexcept { return 0; }
+
 	/// @brief Straightforward recursive spinlock implementation
 	///
 	class MICRO_EXPORT_CLASS recursive_spinlock
@@ -135,14 +135,37 @@ MICRO_EXPORT size_t micro_malloc_good_size(size_t) MICRO_THROW;
 /// micro_calloc, micro_heap_malloc, micro_heap_memalign, micro_heap_realloc or micro_heap_calloc.
 MICRO_EXPORT void micro_free(void*) MICRO_THROW;
 
+/// @brief Similar behavior to free_sized() C23 function.
+/// Free a chunk of memory allocated with micro_malloc, micro_realloc, micro_calloc,
+/// micro_heap_malloc, micro_heap_realloc or micro_heap_calloc.
+/// size must be the size requested at allocation.
+MICRO_EXPORT void micro_free_sized(void*, size_t) MICRO_THROW;
+
+/// @brief Allocate count chunks of size bytes each and store them in out.
+/// Small chunks are allocated with a single lock per batch.
+/// Returns the number of allocated chunks (lower than count on error).
+MICRO_EXPORT size_t micro_malloc_batch(size_t size, size_t count, void** out) MICRO_THROW;
+
+/// @brief Free count chunks of memory (null pointers are ignored).
+/// Consecutive small chunks belonging to the same block are freed with a single lock.
+MICRO_EXPORT void micro_free_batch(void** ptrs, size_t count) MICRO_THROW;
+
 /// @brief Clear the global heap: deallocate all previously allocated pages
 /// and reset its internal state, except for its parameters.
 MICRO_EXPORT void micro_clear() MICRO_THROW;
 
+/// @brief Return as much memory as possible to the OS without invalidating allocated chunks.
+/// Free page runs are released (except for pad bytes), empty small object blocks are given back
+/// and the whole pages inside free chunks are decommitted.
+/// Objects cached by other threads are not released.
+/// Returns the number of released bytes.
+MICRO_EXPORT size_t micro_trim(size_t pad) MICRO_THROW;
+
 /// @brief Retrieve global heap statistics
 MICRO_EXPORT void micro_dump_stats(micro_statistics* stats) MICRO_THROW;
 
-/// @brief Similar to msvc _expand
+/// @brief Similar to msvc _expand.
+/// Grow or shrink given chunk without moving it, returns null if this is not possible.
 MICRO_EXPORT void* micro_expand(void* ptr, size_t size) MICRO_THROW;
 
 /// @brief Similar to msvc _recalloc
@@ -156,13 +179,46 @@ MICRO_EXPORT void* micro_recalloc(void* p, size_t num, size_t size) MICRO_THROW;
 /// This heap is similar to the global one and can be used by any thread.
 MICRO_EXPORT micro_heap* micro_heap_create() MICRO_THROW;
 
+/// @brief Create a heap shared between processes, stored in a file of given size in bytes.
+/// The heap and all its pages live in the file, which is mapped with MAP_SHARED at the same address
+/// in all processes. Forked children inherit the heap, other processes attach with micro_heap_attach().
+/// Chunks can be allocated and freed by any process. The heap does not grow beyond the file size,
+/// and never falls back to the OS pages. Thread caches and background purging are disabled.
+/// Returns NULL on error.
+MICRO_EXPORT micro_heap* micro_heap_create_shared(const char* filename, uint64_t bytes) MICRO_THROW;
+
+/// @brief Attach to a heap created by micro_heap_create_shared() in another process.
+/// The attaching process can be any process using a compatible build of the library (same version,
+/// same options), whatever its load address. The file is mapped at the same address as in the creating
+/// process. Returns NULL if the file is not a valid shared heap, if it was created by an incompatible build,
+/// or if its address range is not available.
+MICRO_EXPORT micro_heap* micro_heap_attach(const char* filename) MICRO_THROW;
+
 /// @brief Destroy a local heap and clear all memory allocated by this heap.
+/// A persistent heap (MicroPersistent file flag) keeps its content in the page file,
+/// which can be reopened by a new heap using the same parameters.
+/// A shared heap is only detached from the current process: its content is kept in its file.
 MICRO_EXPORT void micro_heap_destroy(micro_heap* h) MICRO_THROW;
 
 /// @brief Clear a local heap: deallocate all previously allocated memory
 /// and reset its internal state, except for its parameters.
 MICRO_EXPORT void micro_heap_clear(micro_heap* h) MICRO_THROW;
 
+/// @brief Equivalent to micro_trim for local heap
+MICRO_EXPORT size_t micro_heap_trim(micro_heap* h, size_t pad) MICRO_THROW;
+
+/// @brief Returns the file descriptor of the file backing the heap pages, or -1 if the pages are not file backed.
+/// For MicroMemfdProvider, the descriptor can be used to map the pages a second time, or be sent to another
+/// process over a Unix socket. The descriptor must not be closed, and is invalidated by micro_heap_clear().
+MICRO_EXPORT int micro_heap_file_descriptor(micro_heap* h) MICRO_THROW;
+
+/// @brief Set the root object of a persistent heap.
+/// The root object is retrieved with micro_heap_get_root() once the heap is reopened.
+MICRO_EXPORT void micro_heap_set_root(micro_heap* h, void* root) MICRO_THROW;
+/// @brief Returns the root object of a persistent heap, or NULL if not set.
+/// Returns NULL if the page file could not be reopened.
+MICRO_EXPORT void* micro_heap_get_root(micro_heap* h) MICRO_THROW;
+
 /// @brief Set local heap parameter.
 /// This must be called prior to any allocation.
 /// This function is NOT trhead safe.
@@ -185,6 +241,12 @@ MICRO_EXPORT void* micro_heap_memalign(micro_heap* h, size_t, size_t) MICRO_THRO
 MICRO_EXPORT void* micro_heap_realloc(micro_heap* h, void*, size_t) MICRO_THROW;
 /// @brief Equivalent to micro_calloc for local heap
 MICRO_EXPORT void* micro_heap_calloc(micro_heap* h, size_t, size_t) MICRO_THROW;
+/// @brief Equivalent to micro_free_sized for local heap
+MICRO_EXPORT void micro_heap_free_sized(micro_heap* h, void*, size_t) MICRO_THROW;
+/// @brief Equivalent to micro_malloc_batch for local heap
+MICRO_EXPORT size_t micro_heap_malloc_batch(micro_heap* h, size_t size, size_t count, void** out) MICRO_THROW;
+/// @brief Equivalent to micro_free_batch for local heap
+MICRO_EXPORT void micro_heap_free_batch(micro_heap* h, void** ptrs, size_t count) MICRO_THROW;
 
 /// @brief Retrieve local heap statistics
 MICRO_EXPORT void micro_heap_dump_stats(micro_heap* h, micro_statistics* stats) MICRO_THROW;
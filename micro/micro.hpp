@@ -118,19 +118,50 @@ namespace micro
 		/// Returns null on error.
 		MICRO_ALWAYS_INLINE void* aligned_allocate(size_t alignment, size_t size) noexcept { return d_mgr.aligned_allocate(alignment, size); }
 
+		/// @brief Allocate count chunks of size bytes each and store them in out.
+		/// Returns the number of allocated chunks (lower than count on error).
+		MICRO_ALWAYS_INLINE size_t allocate_batch(size_t size, size_t count, void** out) noexcept { return d_mgr.allocate_batch(size, count, out); }
+
 		/// @brief Deallocate a memory chunk previously allocated with
 		/// heap::allocate, heap::aligned_allocate, micro_malloc,
 		/// micro_memalign, micro_realloc, micro_calloc, micro_heap_malloc,
 		/// micro_heap_memalign, micro_heap_realloc or micro_heap_calloc.
 		static MICRO_ALWAYS_INLINE void deallocate(void* p) noexcept { detail::MemoryManager::deallocate(p); }
 
+		/// @brief Deallocate a memory chunk of known size.
+		/// size must be the size requested at allocation (or any value up to the chunk usable size).
+		/// Faster than deallocate() for chunks that cannot belong to the tiny pool.
+		static MICRO_ALWAYS_INLINE void deallocate_sized(void* p, size_t size) noexcept { detail::MemoryManager::deallocate_sized(p, size); }
+
+		/// @brief Deallocate count memory chunks (null pointers are ignored).
+		static MICRO_ALWAYS_INLINE void deallocate_batch(void** ptrs, size_t count) noexcept { detail::MemoryManager::deallocate_batch(ptrs, count); }
+
 		/// @brief Returns the amount of bytes given chunk (allocated with micro library) can hold.
 		static MICRO_ALWAYS_INLINE size_t usable_size(void* p) noexcept { return detail::MemoryManager::usable_size(p); }
 
+		/// @brief Try to grow or shrink given chunk (allocated with micro library) without moving it.
+		/// Returns true if the chunk can hold at least size bytes after the call.
+		static MICRO_ALWAYS_INLINE bool resize_in_place(void* p, size_t size) noexcept { return detail::MemoryManager::resize_in_place(p, size); }
+
+		/// @brief Try to reallocate given chunk (allocated with micro library) without copying its content.
+		/// Medium chunks are resized in place, big chunks might be remapped to a new address.
+		/// Returns the new chunk address, or null on failure (in which case p is still valid).
+		static MICRO_ALWAYS_INLINE void* try_reallocate(void* p, size_t size) noexcept { return detail::MemoryManager::try_reallocate(p, size); }
+
 		/// @brief Clear the heap: deallocated all remaining memory and reset internal state
 		/// (except for the parameters)
 		MICRO_ALWAYS_INLINE void clear() noexcept { d_mgr.clear(); }
 
+		/// @brief Return as much memory as possible to the OS, keeping at most pad bytes of free pages.
+		/// Returns the number of released bytes.
+		MICRO_ALWAYS_INLINE size_t trim(size_t pad = 0) noexcept { return static_cast<size_t>(d_mgr.trim(pad)); }
+
+		/// @brief Set the root object of a persistent heap, retrieved with root() once the heap is reopened
+		MICRO_ALWAYS_INLINE void set_root(void* p) noexcept { d_mgr.set_root(p); }
+
+		/// @brief Returns the root object of a persistent heap
+		MICRO_ALWAYS_INLINE void* root() noexcept { return d_mgr.root(); }
+
 		/// @brief Reset the heap statistics
 		MICRO_ALWAYS_INLINE void reset_stats() noexcept { d_mgr.reset_statistics(); }
 
@@ -164,6 +195,20 @@ namespace micro
 
 		MICRO_ALWAYS_INLINE void set_main() noexcept { detail::MemoryManager::get_main_manager() = &d_mgr; }
 
+		/// @brief Make the heap usable by other processes mapping it at the same address.
+		/// Used by micro_heap_create_shared() and should not be called manually.
+		MICRO_ALWAYS_INLINE bool set_shared() noexcept { return d_mgr.set_shared(); }
+		/// @brief Register/unregister a shared heap mapped by the current process.
+		/// Used by micro_heap_attach() and micro_heap_destroy(), and should not be called manually.
+		MICRO_ALWAYS_INLINE bool attach_shared() noexcept { return detail::MemoryManager::register_shared(&d_mgr); }
+		MICRO_ALWAYS_INLINE void detach_shared() noexcept { detail::MemoryManager::unregister_shared(&d_mgr); }
+		/// @brief Tells if this heap is shared between processes
+		MICRO_ALWAYS_INLINE bool is_shared() const noexcept { return d_mgr.is_shared(); }
+
+		/// @brief Returns the file descriptor of the file backing the heap pages
+		/// (MicroFileProvider and MicroMemfdProvider), or -1.
+		MICRO_ALWAYS_INLINE int file_descriptor() const noexcept { return d_mgr.page_provider()->file_descriptor(); }
+
 	private:
 		detail::MemoryManager d_mgr;
 	};
@@ -271,7 +316,7 @@ namespace micro
 #else
 			(void)n;
 #endif
-			d_heap->deallocate(p);
+			d_heap->deallocate_sized(p, n * sizeof(T));
 		}
 	};
 }
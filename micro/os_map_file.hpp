@@ -112,6 +112,7 @@ namespace micro
 	{
 		HANDLE hFile{ nullptr };
 		std::uint64_t hSize{ 0 };
+		std::uint64_t hFileSize{ 0 };
 		bool hUseFileSize{ false };
 
 	public:
@@ -128,7 +129,7 @@ namespace micro
 			if (hFile) {
 				CloseHandle(hFile);
 				hFile = nullptr;
-				hSize = 0;
+				hSize = hFileSize = 0;
 			}
 			if (!filename)
 				return memory_map_file_view{};
@@ -139,7 +140,7 @@ namespace micro
 			// Create file
 			hFile = CreateFileA(filename,			  // file name
 					    GENERIC_WRITE | GENERIC_READ, // access type
-					    0,				  // other processes can't share
+					    FILE_SHARE_READ | FILE_SHARE_WRITE, // other processes can map the file (shared heaps)
 					    nullptr,			  // security
 					    open_flag,
 					    FILE_ATTRIBUTE_NORMAL,
@@ -165,7 +166,37 @@ namespace micro
 			return extend(size);
 		}
 
-		memory_map_file_view extend(std::uint64_t bytes) noexcept
+		/// @brief Open a file without truncating it, and retrieve its current size.
+		/// The existing content can then be mapped with extend().
+		bool open(const char* filename, std::uint64_t* size) noexcept
+		{
+			init(nullptr, 0);
+			hFile = CreateFileA(filename, GENERIC_WRITE | GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (hFile == INVALID_HANDLE_VALUE) {
+				hFile = nullptr;
+				return false;
+			}
+			LARGE_INTEGER fsize;
+			if (!GetFileSizeEx(hFile, &fsize)) {
+				init(nullptr, 0);
+				return false;
+			}
+			hUseFileSize = false;
+			*size = hFileSize = static_cast<std::uint64_t>(fsize.QuadPart);
+			return true;
+		}
+
+		/// @brief Read the first bytes of the file
+		bool read(void* dst, std::uint64_t bytes) const noexcept
+		{
+			OVERLAPPED o{};
+			DWORD r = 0;
+			return hFile && ReadFile(hFile, dst, static_cast<DWORD>(bytes), &r, &o) && r == bytes;
+		}
+
+		/// @brief Map the next bytes of the file, growing it if needed.
+		/// If address is not null, the view must be mapped at this address.
+		memory_map_file_view extend(std::uint64_t bytes, void* address = nullptr) noexcept
 		{
 			if (!bytes || !hFile)
 				return memory_map_file_view{};
@@ -177,10 +208,13 @@ namespace micro
 
 			std::uint64_t new_size = hSize + bytes;
 
+			const std::uint64_t old_file_size = hFileSize;
 			if (!hUseFileSize) {
 				// Resize file
 				bytes = (bytes / os_allocation_granularity() + (bytes % os_allocation_granularity() ? 1 : 0)) * os_allocation_granularity();
 				new_size = hSize + bytes;
+			}
+			if (!hUseFileSize && new_size > hFileSize) {
 				// Set size
 				LARGE_INTEGER l;
 				l.QuadPart = static_cast<LONGLONG>(new_size);
@@ -190,6 +224,7 @@ namespace micro
 				if (!SetEndOfFile(hFile)) {
 					return memory_map_file_view{};
 				}
+				hFileSize = new_size;
 			}
 
 			HANDLE hMapFile = CreateFileMapping(hFile,	    // file handle
@@ -201,24 +236,27 @@ namespace micro
 							    nullptr);
 
 			if (hMapFile == nullptr) {
-				if (!hUseFileSize) {
+				if (hFileSize != old_file_size) {
 					LARGE_INTEGER l;
-					l.QuadPart = static_cast<LONGLONG>(hSize);
+					l.QuadPart = static_cast<LONGLONG>(old_file_size);
 					if (SetFilePointerEx(hFile, l, nullptr, FILE_BEGIN))
 						SetEndOfFile(hFile);
+					hFileSize = old_file_size;
 				}
 				return memory_map_file_view{};
 			}
 
 			LARGE_INTEGER l;
 			l.QuadPart = static_cast<LONGLONG>(hSize);
-			void* p = MapViewOfFile(hMapFile, FILE_MAP_READ | FILE_MAP_WRITE, static_cast<DWORD>(l.HighPart), l.LowPart, 0);
+			void* p = MapViewOfFileEx(hMapFile, FILE_MAP_READ | FILE_MAP_WRITE, static_cast<DWORD>(l.HighPart), l.LowPart, static_cast<SIZE_T>(bytes), address);
 			if (!p) {
-				if (!hUseFileSize) {
+				CloseHandle(hMapFile);
+				if (hFileSize != old_file_size) {
 					// shrink file to previous size
-					l.QuadPart = static_cast<LONGLONG>(hSize);
+					l.QuadPart = static_cast<LONGLONG>(old_file_size);
 					if (SetFilePointerEx(hFile, l, nullptr, FILE_BEGIN))
 						SetEndOfFile(hFile);
+					hFileSize = old_file_size;
 				}
 				return memory_map_file_view{};
 			}
@@ -261,6 +299,11 @@ namespace micro
 #include <sys/syscall.h>
 #endif
 
+// Anonymous memory files (Linux >= 3.17)
+#if defined(__linux__) && defined(SYS_memfd_create)
+#define MICRO_HAS_MEMFD
+#endif
+
 namespace micro
 {
 	class MICRO_EXPORT_CLASS memory_map_file_view
@@ -315,6 +358,7 @@ namespace micro
 	{
 		int hFile{ 0 };
 		std::uint64_t hSize{ 0 };
+		std::uint64_t hFileSize{ 0 };
 
 	public:
 		MICRO_DELETE_COPY(memory_map_file)
@@ -330,12 +374,12 @@ namespace micro
 			if (hFile) {
 				close(hFile);
 				hFile = 0;
-				hSize = 0;
+				hSize = hFileSize = 0;
 			}
 			if (!filename)
 				return memory_map_file_view{};
 
-			hFile = open(filename, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+			hFile = ::open(filename, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
 
 			if (hFile == -1) {
 				hFile = 0;
@@ -345,7 +389,66 @@ namespace micro
 			return extend(size);
 		}
 
-		memory_map_file_view extend(std::uint64_t bytes) noexcept
+		/// @brief Open a file without truncating it, and retrieve its current size.
+		/// The existing content can then be mapped with extend().
+		bool open(const char* filename, std::uint64_t* size) noexcept
+		{
+			init(nullptr, 0);
+			hFile = ::open(filename, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+			if (hFile == -1) {
+				hFile = 0;
+				return false;
+			}
+			off_t end = lseek(hFile, 0, SEEK_END);
+			if (end < 0) {
+				init(nullptr, 0);
+				return false;
+			}
+			*size = hFileSize = static_cast<std::uint64_t>(end);
+			return true;
+		}
+
+		/// @brief Read the first bytes of the file
+		bool read(void* dst, std::uint64_t bytes) const noexcept { return hFile && pread(hFile, dst, bytes, 0) == static_cast<ssize_t>(bytes); }
+
+		/// @brief Returns the file descriptor, or 0 if no file is opened
+		int handle() const noexcept { return hFile; }
+
+#ifdef MICRO_HAS_MEMFD
+		/// @brief Initialize from an anonymous memory file (see memfd_create) of given size.
+		/// The name is only used for debugging purposes (/proc/self/fd).
+		memory_map_file_view init_memfd(const char* name, std::uint64_t size) noexcept
+		{
+			init(nullptr, 0);
+			// MFD_CLOEXEC
+			hFile = static_cast<int>(syscall(SYS_memfd_create, name, 1u));
+			if (hFile <= 0) {
+				hFile = 0;
+				return memory_map_file_view{};
+			}
+			memory_map_file_view view = extend(size);
+			if (!view.valid())
+				init(nullptr, 0);
+			return view;
+		}
+#endif
+
+		/// @brief Release the storage of a file range, which reads back as zeros.
+		/// Returns false if not supported by the file system.
+		bool punch_hole(std::uint64_t offset, std::uint64_t bytes) noexcept
+		{
+#if defined(__linux__) && defined(FALLOC_FL_PUNCH_HOLE)
+			return hFile && fallocate(hFile, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, static_cast<off_t>(offset), static_cast<off_t>(bytes)) == 0;
+#else
+			(void)offset;
+			(void)bytes;
+			return false;
+#endif
+		}
+
+		/// @brief Map the next bytes of the file, growing it if needed.
+		/// If address is not null, the view must be mapped at this address.
+		memory_map_file_view extend(std::uint64_t bytes, void* address = nullptr) noexcept
 		{
 			if (!bytes || !hFile)
 				return memory_map_file_view{};
@@ -356,13 +459,32 @@ namespace micro
 			bytes = (bytes / os_allocation_granularity() + (bytes % os_allocation_granularity() ? 1 : 0)) * os_allocation_granularity();
 			new_size = hSize + bytes;
 
-			if (ftruncate(hFile, new_size) < 0)
-				return memory_map_file_view{};
+			const std::uint64_t old_file_size = hFileSize;
+			if (new_size > hFileSize) {
+				if (ftruncate(hFile, static_cast<off_t>(new_size)) < 0)
+					return memory_map_file_view{};
+				hFileSize = new_size;
+			}
 
-			void* ptr = mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, hFile, hSize);
+			int flags = MAP_SHARED;
+#ifdef MAP_FIXED_NOREPLACE
+			if (address)
+				flags |= MAP_FIXED_NOREPLACE;
+#endif
+			void* ptr = mmap(address, bytes, PROT_READ | PROT_WRITE, flags, hFile, static_cast<off_t>(hSize));
+			if (ptr == MAP_FAILED)
+				ptr = nullptr;
+			if (ptr && address && ptr != address) {
+				// Mapping address is only a hint without MAP_FIXED_NOREPLACE
+				munmap(ptr, bytes);
+				ptr = nullptr;
+			}
 
-			if (ptr == 0) {
-				ftruncate(hFile, hSize);
+			if (!ptr) {
+				if (hFileSize != old_file_size) {
+					(void)ftruncate(hFile, static_cast<off_t>(old_file_size));
+					hFileSize = old_file_size;
+				}
 				return memory_map_file_view{};
 			}
 
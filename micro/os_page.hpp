@@ -39,6 +39,47 @@ namespace micro
 	MICRO_EXPORT void* os_allocate_pages(size_t pages) noexcept;
 	/// @brief Decommit pages
 	MICRO_EXPORT bool os_free_pages(void* p, size_t pages) noexcept;
+	/// @brief Lazily decommit pages: the OS reclaims them only under memory pressure.
+	/// Pages remain accessible, and their content is undefined.
+	MICRO_EXPORT bool os_reset_pages(void* p, size_t pages) noexcept;
+	/// @brief Release the physical memory of pages that stay mapped.
+	/// Pages remain accessible, and are zero filled (Linux) or undefined (Windows) on next access.
+	MICRO_EXPORT bool os_decommit_pages(void* p, size_t pages) noexcept;
+	/// @brief Reserve a range of address space without committing it.
+	/// The range is aligned on MICRO_BLOCK_SIZE if possible, and pages are not accessible before os_commit_pages().
+	MICRO_EXPORT void* os_reserve_pages(size_t pages) noexcept;
+	/// @brief Commit pages inside a range previously reserved with os_reserve_pages()
+	MICRO_EXPORT bool os_commit_pages(void* p, size_t pages) noexcept;
+	/// @brief Decommit pages inside a range previously reserved with os_reserve_pages().
+	/// Pages are not accessible anymore until the next os_commit_pages().
+	MICRO_EXPORT bool os_uncommit_pages(void* p, size_t pages) noexcept;
+	/// @brief Release a whole range previously reserved with os_reserve_pages()
+	MICRO_EXPORT bool os_release_pages(void* p, size_t pages) noexcept;
+	/// @brief Resize pages previously allocated with os_allocate_pages(), potentially moving them.
+	/// Returns the new pages address, or null if not supported (Linux only) or on error.
+	MICRO_EXPORT void* os_remap_pages(void* p, size_t old_pages, size_t new_pages) noexcept;
+	/// @brief Returns the size of explicit huge pages, or 0 if not supported
+	MICRO_EXPORT size_t os_huge_page_size() noexcept;
+	/// @brief Allocate (commit) pages backed by explicit huge pages (MAP_HUGETLB or MEM_LARGE_PAGES).
+	/// The size must be a multiple of os_huge_page_size(), and the pages are released with os_release_pages().
+	/// Returns null if no huge page is available.
+	MICRO_EXPORT void* os_allocate_huge_pages(size_t pages) noexcept;
+	/// @brief Allocate (commit) pages aligned on given power of 2 alignment.
+	/// The pages are released with os_release_pages().
+	MICRO_EXPORT void* os_allocate_aligned_pages(size_t pages, size_t alignment) noexcept;
+	/// @brief Ask the OS to back given pages with transparent huge pages (Linux only)
+	MICRO_EXPORT bool os_advise_huge_pages(void* p, size_t pages) noexcept;
+	/// @brief Fault in given pages (MADV_POPULATE_WRITE, or touch each page) without modifying their content
+	MICRO_EXPORT void os_populate_pages(void* p, size_t pages) noexcept;
+	/// @brief Lock given pages in physical memory (mlock or VirtualLock)
+	MICRO_EXPORT bool os_lock_pages(void* p, size_t pages) noexcept;
+	/// @brief Returns the number of NUMA nodes (highest node id + 1), or 1 if NUMA is not supported
+	MICRO_EXPORT unsigned os_numa_node_count() noexcept;
+	/// @brief Returns the NUMA node of the CPU currently running the calling thread
+	MICRO_EXPORT unsigned os_current_numa_node() noexcept;
+	/// @brief Set the preferred NUMA node of given pages, which must not be touched yet.
+	/// Returns false if not supported (Linux only) or on error.
+	MICRO_EXPORT bool os_bind_pages(void* p, size_t pages, unsigned node) noexcept;
 	/// @brief Retrieve process infos
 	MICRO_EXPORT bool os_process_infos(micro_process_infos& infos) noexcept;
 }
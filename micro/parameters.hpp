@@ -77,6 +77,18 @@ namespace micro
 		/// @brief Number of arenas
 		unsigned max_arenas{ detail::default_arenas() };
 
+		/// @brief Select the arena based on the CPU currently running the thread instead of the thread id.
+		/// Arena usage then follows the actual concurrency instead of the thread creation order.
+		bool arena_per_cpu{ false };
+
+		/// @brief Small objects freed by a thread using another arena than the owner of their block
+		/// are pushed to a lock-free list, and given back by the owner on its next allocation miss.
+		bool remote_free{ false };
+
+		/// @brief NUMA mode: group arenas per NUMA node and bind their page runs to this node.
+		/// Falls back to a single node if NUMA is not available.
+		bool numa{ false };
+
 		/// @brief Global memory limit, calls to micro_malloc() or heap::allocate() will return null if we go beyong this limit.
 		/// Default to 0 (disabled).
 		std::uint64_t memory_limit{ 0 };
@@ -86,6 +98,16 @@ namespace micro
 		/// If >= 100, it is considered as a raw maximum number of pages.
 		std::uint64_t backend_memory{ MICRO_DEFAULT_BACKEND_MEMORY };
 
+		/// @brief Decay time in milliseconds of free page runs.
+		/// If non 0, deallocated page runs are kept in the free list and gradually returned
+		/// to the page provider by a background thread within this delay (backend_memory still applies).
+		/// Default to 0: free page runs are trimmed synchronously on deallocation.
+		unsigned purge_decay_ms{ 0 };
+
+		/// @brief Maximum bytes cached by all per-thread magazines in front of the tiny pools.
+		/// Trade memory for lock-free small allocations. Default to 0 (disabled).
+		std::uint64_t thread_cache_bytes{ 0 };
+
 		/// @brief Disable malloc replacement in micro_proxy.
 		/// Only used by micro_proxy shared library based on MICRO_DISABLE_REPLACEMENT env. variable.
 		bool disable_malloc_replacement{ false };
@@ -102,13 +124,33 @@ namespace micro
 		/// @brief Default page size for non-OS page providers
 		unsigned page_size{ MICRO_DEFAULT_PAGE_SIZE };
 
+		/// @brief For MicroOSProvider, how released page runs are given back to the OS, see micro_decommit_type enum.
+		/// Default to MicroDecommitDontNeed.
+		unsigned decommit{ MicroDecommitDontNeed };
+
+		/// @brief For MicroOSProvider, huge pages backing page runs of whole huge pages, see micro_huge_pages_type enum.
+		/// Big allocations of at least one huge page are rounded up to whole huge pages.
+		/// Default to MicroHugePagesTransparent for memory level 4, MicroHugePagesNone otherwise.
+		unsigned huge_pages{ MICRO_DEFAULT_HUGE_PAGES };
+
+		/// @brief Minimum size in bytes of the OS pages released inside free medium chunks.
+		/// When a deallocation produces a free chunk spanning at least this amount of whole pages,
+		/// these pages are decommitted (see decommit) and recommitted on their next access.
+		/// Default to 0 (disabled).
+		std::uint64_t decommit_threshold{ 0 };
+
+		/// @brief For MicroOSPreallocProvider, combination of micro_prealloc_flags.
+		/// Default to MicroPreallocLazy.
+		unsigned prealloc_flags{ MicroPreallocLazy };
+
 		/// @brief Memory block used for memory page provider
 		char* page_memory_provider{ nullptr };
 
-		/// @brief Memory provider size, or file provider start size, or preallocated provider size, default to 0
+		/// @brief Memory provider size, or file/memfd provider start size, or preallocated provider size,
+		/// or reserved address range size (0 meaning MICRO_DEFAULT_RESERVE_SIZE), default to 0
 		std::uint64_t page_memory_size{ 0 };
 
-		/// @brief For MicroOSPreallocProvider, MicroMemProvider and MicroFileProvider,
+		/// @brief For MicroOSPreallocProvider, MicroOSReserveProvider, MicroMemProvider and MicroFileProvider,
 		/// Allow the use of OS page alloc/dealloc API when the page provider cannot allocate pages anymore.
 		/// Default to true.
 		bool allow_os_page_alloc{ true };
@@ -192,6 +192,40 @@ void __MICRO_malloc_safer_free(void* ptr, void (*original_free)(void*))
 	}
 }
 
+static MICRO_ALWAYS_INLINE bool __MICRO_free_medium_or_big(void* ptr, size_t sz)
+{
+	// Free a chunk known NOT to belong to a TinyBlockPool:
+	// once the page map tells that it belongs to the main manager, its header is valid.
+	ManagerType* main = ManagerType::get_main_manager();
+	if (!main || ManagerType::find_from_ptr(ptr) != main)
+		return false;
+	auto* tiny = micro::detail::SmallChunkHeader::from(ptr) - 1;
+	if (tiny->guard == MICRO_BLOCK_GUARD && (tiny->status == MICRO_ALLOC_MEDIUM || tiny->status == MICRO_ALLOC_BIG)) {
+		MICRO_ASSERT_DEBUG(sz <= ManagerType::usable_size(ptr, tiny->status), "invalid chunk size");
+		(void)sz;
+		ManagerType::deallocate(ptr, tiny->status, nullptr, nullptr, true);
+		return true;
+	}
+	return false;
+}
+
+void __MICRO_malloc_safer_free_sized(void* ptr, size_t sz, void (*original_free)(void*))
+{
+	// Chunks bigger than MICRO_MAX_SMALL_ALLOC_THRESHOLD never belong to a TinyBlockPool
+	if (ptr && sz > MICRO_MAX_SMALL_ALLOC_THRESHOLD && __MICRO_free_medium_or_big(ptr, sz))
+		return;
+	__MICRO_malloc_safer_free(ptr, original_free);
+}
+
+void __MICRO_malloc_safer_free_aligned(void* ptr, size_t sz, size_t alignment, void (*original_free)(void*))
+{
+	// Chunks aligned on more than MICRO_MINIMUM_ALIGNMENT never belong to a TinyBlockPool.
+	// sz is 0 if unknown.
+	if (ptr && (alignment > MICRO_MINIMUM_ALIGNMENT || sz > MICRO_MAX_SMALL_ALLOC_THRESHOLD) && __MICRO_free_medium_or_big(ptr, sz))
+		return;
+	__MICRO_malloc_safer_free(ptr, original_free);
+}
+
 STATIC_FUNCTION void* __MICRO_malloc_safer_realloc_dbg(void* ptr, size_t sz, int, const char*, int)
 {
 	void* tmp = nullptr;
@@ -213,11 +247,14 @@ STATIC_FUNCTION void* __MICRO_malloc_safer_realloc_dbg(void* ptr, size_t sz, int
 				auto originalSize = ManagerType::usable_size(ptr, status);
 				auto minSize = (originalSize < sz) ? originalSize : sz;
 
-				// Don't change size if the object is shrinking by less than half.
-				if (sz <= originalSize) {
-					// Do nothing.
+				// Don't change size if the object is shrinking by less than half,
+				// otherwise try to grow/shrink in place (or remap big chunks).
+				if (sz <= originalSize && sz > originalSize / 2) {
 					tmp = ptr;
 				}
+				else if ((tmp = ManagerType::try_reallocate(ptr, sz))) {
+					// Done
+				}
 				else {
 					tmp = micro_malloc(sz);
 					if (tmp) {
@@ -302,11 +339,14 @@ void* __MICRO_malloc_safer_realloc(void* ptr, size_t sz, void* original_realloc)
 				auto originalSize = ManagerType::usable_size(ptr, status);
 				auto minSize = (originalSize < sz) ? originalSize : sz;
 
-				// Don't change size if the object is shrinking by less than half.
-				if (sz <= originalSize) {
-					// Do nothing.
+				// Don't change size if the object is shrinking by less than half,
+				// otherwise try to grow/shrink in place (or remap big chunks).
+				if (sz <= originalSize && sz > originalSize / 2) {
 					tmp = ptr;
 				}
+				else if ((tmp = ManagerType::try_reallocate(ptr, sz))) {
+					// Done
+				}
 				else {
 					tmp = micro_malloc(sz);
 					if (tmp) {
@@ -526,9 +566,10 @@ size_t __MICRO_malloc_safer_aligned_msize(void* object, size_t alignment, size_t
 	printf(buff);
 }*/
 
-STATIC_FUNCTION inline void* InternalOperatorNew(size_t sz)
+STATIC_FUNCTION inline void* InternalOperatorNew(size_t sz, size_t alignment = 0)
 {
-	void* res = micro_malloc(sz);
+	// alignment is 0 for the non aligned operator new
+	void* res = alignment ? micro_memalign(alignment, sz) : micro_malloc(sz);
 #if MICRO_USE_EXCEPTIONS
 	while (!res) {
 		std::new_handler handler;
@@ -547,7 +588,7 @@ STATIC_FUNCTION inline void* InternalOperatorNew(size_t sz)
 		else {
 			throw std::bad_alloc();
 		}
-		res = micro_malloc(sz);
+		res = alignment ? micro_memalign(alignment, sz) : micro_malloc(sz);
 	}
 #endif /* MICRO_USE_EXCEPTIONS */
 	return res;
@@ -717,6 +758,11 @@ int mallopt(int /*param*/, int /*value*/) __THROW
 	return 1;
 }
 
+int malloc_trim(size_t pad) __THROW
+{
+	return micro_trim(pad) != 0;
+}
+
 #if defined(__GLIBC__) || defined(__ANDROID__)
 struct mallinfo mallinfo() __THROW
 {
@@ -801,6 +847,66 @@ void operator delete[](void* ptr, const std::nothrow_t&) noexcept
 	InitOrigPointers();
 	__MICRO_malloc_safer_free(ptr, (void (*)(void*))orig_free);
 }
+#if __cpp_sized_deallocation
+void operator delete(void* ptr, size_t sz) noexcept
+{
+	InitOrigPointers();
+	__MICRO_malloc_safer_free_sized(ptr, sz, (void (*)(void*))orig_free);
+}
+void operator delete[](void* ptr, size_t sz) noexcept
+{
+	InitOrigPointers();
+	__MICRO_malloc_safer_free_sized(ptr, sz, (void (*)(void*))orig_free);
+}
+#endif
+#if __cpp_aligned_new
+void* operator new(size_t sz, std::align_val_t al)
+{
+	return InternalOperatorNew(sz, static_cast<size_t>(al));
+}
+void* operator new[](size_t sz, std::align_val_t al)
+{
+	return InternalOperatorNew(sz, static_cast<size_t>(al));
+}
+void* operator new(size_t sz, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+	return micro_memalign(static_cast<size_t>(al), sz);
+}
+void* operator new[](size_t sz, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+	return micro_memalign(static_cast<size_t>(al), sz);
+}
+void operator delete(void* ptr, std::align_val_t al) noexcept
+{
+	InitOrigPointers();
+	__MICRO_malloc_safer_free_aligned(ptr, 0, static_cast<size_t>(al), (void (*)(void*))orig_free);
+}
+void operator delete[](void* ptr, std::align_val_t al) noexcept
+{
+	InitOrigPointers();
+	__MICRO_malloc_safer_free_aligned(ptr, 0, static_cast<size_t>(al), (void (*)(void*))orig_free);
+}
+void operator delete(void* ptr, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+	InitOrigPointers();
+	__MICRO_malloc_safer_free_aligned(ptr, 0, static_cast<size_t>(al), (void (*)(void*))orig_free);
+}
+void operator delete[](void* ptr, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+	InitOrigPointers();
+	__MICRO_malloc_safer_free_aligned(ptr, 0, static_cast<size_t>(al), (void (*)(void*))orig_free);
+}
+void operator delete(void* ptr, size_t sz, std::align_val_t al) noexcept
+{
+	InitOrigPointers();
+	__MICRO_malloc_safer_free_aligned(ptr, sz, static_cast<size_t>(al), (void (*)(void*))orig_free);
+}
+void operator delete[](void* ptr, size_t sz, std::align_val_t al) noexcept
+{
+	InitOrigPointers();
+	__MICRO_malloc_safer_free_aligned(ptr, sz, static_cast<size_t>(al), (void (*)(void*))orig_free);
+}
+#endif
 
 #endif /* MALLOC_UNIXLIKE_OVERLOAD_ENABLED */
 #endif /* MALLOC_UNIXLIKE_OVERLOAD_ENABLED || MALLOC_ZONE_OVERLOAD_ENABLED */
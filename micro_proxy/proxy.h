@@ -56,6 +56,8 @@
 
 extern "C" {
     OVERRIDE_EXPORT void   __MICRO_malloc_safer_free( void *ptr, void (*original_free)(void*));
+    OVERRIDE_EXPORT void   __MICRO_malloc_safer_free_sized( void *ptr, size_t, void (*original_free)(void*));
+    OVERRIDE_EXPORT void   __MICRO_malloc_safer_free_aligned( void *ptr, size_t, size_t, void (*original_free)(void*));
     OVERRIDE_EXPORT void * __MICRO_malloc_safer_realloc( void *ptr, size_t, void* );
     OVERRIDE_EXPORT void * __MICRO_malloc_safer_aligned_realloc( void *ptr, size_t, size_t, void* );
     OVERRIDE_EXPORT size_t __MICRO_malloc_safer_msize( void *ptr, size_t (*orig_msize_crt80d)(void*));
@@ -0,0 +1,127 @@
+#include <micro/micro.h>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Batch allocation returns count distinct chunks of at least the requested size,
+// and batch deallocation accepts any mix of chunks and null pointers.
+
+static void fill_batch(void** ptrs, size_t count, size_t size)
+{
+	for (size_t i = 0; i < count; ++i)
+		memset(ptrs[i], static_cast<char>(i), size);
+}
+
+static void check_batch(void** ptrs, size_t count, size_t size)
+{
+	for (size_t i = 0; i < count; ++i) {
+		MICRO_TEST(ptrs[i] != nullptr);
+		MICRO_TEST(micro_usable_size(ptrs[i]) >= size);
+		MICRO_TEST(reinterpret_cast<std::uintptr_t>(ptrs[i]) % sizeof(void*) == 0);
+	}
+	std::vector<void*> sorted(ptrs, ptrs + count);
+	std::sort(sorted.begin(), sorted.end());
+	MICRO_TEST(std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+
+	// Chunks do not overlap
+	fill_batch(ptrs, count, size);
+	for (size_t i = 0; i < count; ++i) {
+		const char* p = static_cast<const char*>(ptrs[i]);
+		MICRO_TEST(p[0] == static_cast<char>(i) && p[size - 1] == static_cast<char>(i));
+	}
+}
+
+static void test_batch_sizes()
+{
+	micro_heap* h = micro_heap_create();
+	MICRO_TEST(h != nullptr);
+
+	const size_t sizes[] = { 0, 8, 24, 100, 512, 2000, 70000, 2u << 20u };
+	for (size_t size : sizes) {
+		// Several packets of small objects
+		const size_t count = size >= (1u << 20u) ? 8 : 1000;
+		std::vector<void*> ptrs(count, nullptr);
+		MICRO_TEST(micro_heap_malloc_batch(h, size, count, ptrs.data()) == count);
+		check_batch(ptrs.data(), count, size ? size : 1);
+		micro_heap_free_batch(h, ptrs.data(), count);
+	}
+	MICRO_TEST(micro_heap_malloc_batch(h, 16, 0, nullptr) == 0);
+
+	micro_heap_destroy(h);
+}
+
+static void test_mixed_free()
+{
+	micro_heap* h = micro_heap_create();
+	MICRO_TEST(h != nullptr);
+
+	// Small and medium chunks of two heaps, with null pointers, in random order
+	std::vector<void*> ptrs(256, nullptr);
+	MICRO_TEST(micro_malloc_batch(24, 64, ptrs.data()) == 64);
+	MICRO_TEST(micro_malloc_batch(2000, 63, ptrs.data() + 64) == 63);
+	MICRO_TEST(micro_heap_malloc_batch(h, 40, 64, ptrs.data() + 127) == 64);
+	for (size_t i = 191; i < 250; ++i) {
+		ptrs[i] = micro_heap_malloc(h, 16 + i);
+		MICRO_TEST(ptrs[i] != nullptr);
+	}
+	std::shuffle(ptrs.begin(), ptrs.end(), std::mt19937(0));
+	micro_free_batch(ptrs.data(), ptrs.size());
+
+	// Freed chunks are reused
+	MICRO_TEST(micro_heap_malloc_batch(h, 40, 64, ptrs.data()) == 64);
+	check_batch(ptrs.data(), 64, 40);
+	micro_free_batch(ptrs.data(), 64);
+	micro_heap_destroy(h);
+}
+
+static void burst_thread(unsigned seed, bool* ok)
+{
+	static constexpr size_t max_burst = 256;
+	std::mt19937 gen(seed);
+	std::uniform_int_distribution<> burst_distribution(32, max_burst);
+	std::uniform_int_distribution<> size_distribution(8, 512);
+
+	void* ptrs[max_burst];
+	*ok = true;
+	for (int i = 0; i < 5000 && *ok; ++i) {
+		size_t count = static_cast<size_t>(burst_distribution(gen));
+		size_t size = static_cast<size_t>(size_distribution(gen));
+		if (micro_malloc_batch(size, count, ptrs) != count) {
+			*ok = false;
+			break;
+		}
+		fill_batch(ptrs, count, size);
+		for (size_t j = 0; j < count; ++j) {
+			const char* p = static_cast<const char*>(ptrs[j]);
+			if (p[0] != static_cast<char>(j) || p[size - 1] != static_cast<char>(j))
+				*ok = false;
+		}
+		micro_free_batch(ptrs, count);
+	}
+}
+
+static void test_batch_threads(unsigned threads)
+{
+	std::vector<std::thread> ths;
+	std::unique_ptr<bool[]> ok(new bool[threads]);
+	for (unsigned i = 0; i < threads; ++i)
+		ths.emplace_back(burst_thread, 42 + i, &ok[i]);
+	for (auto& t : ths)
+		t.join();
+	for (unsigned i = 0; i < threads; ++i)
+		MICRO_TEST(ok[i]);
+}
+
+int test_batch_alloc(int, char** const)
+{
+	MICRO_TEST_MODULE_RETURN(batch_sizes, 1, test_batch_sizes());
+	MICRO_TEST_MODULE_RETURN(batch_mixed_free, 1, test_mixed_free());
+	MICRO_TEST_MODULE_RETURN(batch_threads, 1, test_batch_threads(4));
+	return 0;
+}
@@ -0,0 +1,114 @@
+#include <micro/micro.h>
+#include <micro/micro.hpp>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// Address to manager lookup shared by all heaps, and detection of foreign
+// pointers as done by the proxy.
+
+using namespace micro::detail;
+
+static int foreign_object = 0;
+
+static void test_heap_ownership(size_t heap_count)
+{
+	static constexpr size_t chunks_per_heap = 16;
+
+	std::mt19937 gen(42);
+	std::uniform_int_distribution<size_t> medium_distribution(1024, 64 * 1024);
+
+	std::vector<micro_heap*> heaps(heap_count);
+	std::vector<void*> ptrs;
+	std::vector<size_t> owners;
+	for (size_t i = 0; i < heap_count; ++i) {
+		heaps[i] = micro_heap_create();
+		MICRO_TEST(heaps[i] != nullptr);
+		for (size_t j = 0; j < chunks_per_heap; ++j) {
+			// Mix small, medium and big chunks
+			size_t size = (j & 1) ? 16 + j * 8 : (j == 0 ? 4 * 1024 * 1024 : medium_distribution(gen));
+			void* p = micro_heap_malloc(heaps[i], size);
+			MICRO_TEST(p != nullptr);
+			ptrs.push_back(p);
+			owners.push_back(i);
+		}
+	}
+
+	// Chunks of the same heap share the same manager, different heaps use different managers
+	std::vector<MemoryManager*> mgrs(heap_count, nullptr);
+	for (size_t i = 0; i < ptrs.size(); ++i) {
+		MemoryManager* m = MemoryManager::find_from_ptr(ptrs[i]);
+		MICRO_TEST(m != nullptr);
+		MICRO_TEST(MemoryManager::find_from_ptr(static_cast<char*>(ptrs[i]) + 8) == m);
+		if (!mgrs[owners[i]])
+			mgrs[owners[i]] = m;
+		MICRO_TEST(mgrs[owners[i]] == m);
+	}
+	for (size_t i = 1; i < heap_count; ++i)
+		MICRO_TEST(mgrs[i] != mgrs[i - 1]);
+
+	// Foreign addresses
+	int stack_object = 0;
+	MICRO_TEST(MemoryManager::find_from_ptr(&stack_object) == nullptr);
+	MICRO_TEST(MemoryManager::find_from_ptr(&foreign_object) == nullptr);
+
+	for (void* p : ptrs)
+		micro_free(p);
+	for (micro_heap* h : heaps)
+		micro_heap_destroy(h);
+
+	// Destroyed heaps must not be found anymore
+	for (void* p : ptrs)
+		MICRO_TEST(MemoryManager::find_from_ptr(p) == nullptr);
+}
+
+static void test_proxy_foreign_pointers()
+{
+	// Make sure the main manager exists
+	void* small = micro_malloc(16);
+	void* medium = micro_malloc(4096);
+	void* big = micro_malloc(4 * 1024 * 1024);
+	MICRO_TEST(small && medium && big);
+	MICRO_TEST(MemoryManager::get_main_manager() != nullptr);
+
+	MICRO_TEST(MemoryManager::type_of_safe_for_proxy(small) == MICRO_ALLOC_SMALL_BLOCK);
+	MICRO_TEST(MemoryManager::type_of_safe_for_proxy(medium) == MICRO_ALLOC_MEDIUM);
+	MICRO_TEST(MemoryManager::type_of_safe_for_proxy(big) == MICRO_ALLOC_BIG);
+
+	// Pointers from the C runtime malloc are rejected
+	void* foreign = malloc(100);
+	MICRO_TEST(foreign != nullptr);
+	MICRO_TEST(MemoryManager::type_of_safe_for_proxy(foreign) == 0);
+	free(foreign);
+
+	// Even if they look like a valid micro chunk
+	alignas(16) static SmallChunkHeader fake[4];
+	new (fake) SmallChunkHeader(MICRO_ALLOC_BIG, 0);
+	new (fake + 2) SmallChunkHeader(MICRO_ALLOC_MEDIUM, 0);
+	MICRO_TEST(MemoryManager::type_of_safe_for_proxy(fake + 1) == 0);
+	MICRO_TEST(MemoryManager::type_of_safe_for_proxy(fake + 3) == 0);
+
+	// Chunks of other heaps are not handled by the proxy
+	micro_heap* h = micro_heap_create();
+	void* other = micro_heap_malloc(h, 4096);
+	MICRO_TEST(other != nullptr);
+	MICRO_TEST(MemoryManager::type_of_safe_for_proxy(other) == 0);
+	micro_free(other);
+	micro_heap_destroy(h);
+
+	micro_free(small);
+	micro_free(medium);
+	micro_free(big);
+}
+
+int test_heap_index(int, char** const)
+{
+	MICRO_TEST_MODULE_RETURN(heap_ownership_1, 1, test_heap_ownership(1));
+	MICRO_TEST_MODULE_RETURN(heap_ownership_16, 1, test_heap_ownership(16));
+	MICRO_TEST_MODULE_RETURN(heap_ownership_256, 1, test_heap_ownership(256));
+	MICRO_TEST_MODULE_RETURN(proxy_foreign_pointers, 1, test_proxy_foreign_pointers());
+	return 0;
+}
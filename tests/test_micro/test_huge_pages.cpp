@@ -0,0 +1,70 @@
+#include <micro/micro.h>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Huge pages of the OS page provider (MicroHugePages): big chunks of at least one
+// huge page start at the beginning of a huge page aligned page run, whatever the
+// huge page support of the system (explicit huge pages fall back to transparent ones).
+
+static constexpr size_t huge_page_size = 2u << 20u;
+
+static void test_mode(unsigned mode)
+{
+	micro_heap* h = micro_heap_create();
+	MICRO_TEST(h != nullptr);
+	micro_heap_set_parameter(h, MicroHugePages, mode);
+	MICRO_TEST(micro_heap_get_parameter(h, MicroHugePages) == mode);
+
+	std::vector<char*> chunks;
+	std::vector<size_t> sizes;
+	for (size_t size : { huge_page_size, 3 * huge_page_size + 12345, 16 * huge_page_size }) {
+		char* p = static_cast<char*>(micro_heap_malloc(h, size));
+		MICRO_TEST(p != nullptr);
+		MICRO_TEST(micro_usable_size(p) >= size);
+		// Only the chunk header lies before the chunk in its huge page
+		if (mode != MicroHugePagesNone)
+			MICRO_TEST(reinterpret_cast<std::uintptr_t>(p) % huge_page_size <= 4096);
+		memset(p, static_cast<int>(size), size);
+		chunks.push_back(p);
+		sizes.push_back(size);
+	}
+
+	// Growing a huge page run keeps the content
+	char* p = static_cast<char*>(micro_realloc(chunks[0], 8 * huge_page_size));
+	MICRO_TEST(p != nullptr);
+	for (size_t i = 0; i < huge_page_size; i += 4096)
+		MICRO_TEST(p[i] == static_cast<char>(huge_page_size));
+	MICRO_TEST(p[huge_page_size - 1] == static_cast<char>(huge_page_size));
+	chunks[0] = p;
+	sizes[0] = 8 * huge_page_size;
+	memset(p, static_cast<int>(sizes[0]), sizes[0]);
+
+	for (size_t i = 0; i < chunks.size(); ++i) {
+		MICRO_TEST(chunks[i][0] == static_cast<char>(sizes[i]) && chunks[i][sizes[i] - 1] == static_cast<char>(sizes[i]));
+		micro_free(chunks[i]);
+	}
+
+	// Small and medium chunks are not affected
+	std::vector<void*> ptrs;
+	for (size_t size = 16; size < 200000; size = size * 3 / 2) {
+		void* q = micro_heap_malloc(h, size);
+		MICRO_TEST(q != nullptr);
+		memset(q, 0, size);
+		ptrs.push_back(q);
+	}
+	for (void* q : ptrs)
+		micro_free(q);
+	micro_heap_destroy(h);
+}
+
+int test_huge_pages(int, char** const)
+{
+	MICRO_TEST_MODULE_RETURN(default_pages, 1, test_mode(MicroHugePagesNone));
+	MICRO_TEST_MODULE_RETURN(transparent_huge_pages, 1, test_mode(MicroHugePagesTransparent));
+	MICRO_TEST_MODULE_RETURN(explicit_huge_pages, 1, test_mode(MicroHugePagesExplicit));
+	return 0;
+}
@@ -0,0 +1,98 @@
+#include <micro/micro.h>
+#include <micro/micro.hpp>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Lock layout of radix tree leaves: each position owns exactly one spinlock and,
+// with MICRO_PAD_LOCKS, consecutive positions use locks from different cache lines.
+// Threads sharing a single arena on neighbor size classes keep their content.
+
+using namespace micro::detail;
+
+static void test_lock_index()
+{
+	static constexpr unsigned size = RadixAccess::l1_size;
+	std::vector<unsigned> count(size, 0);
+	for (unsigned pos = 0; pos < size; ++pos) {
+		unsigned idx = RadixLeaf::lock_index(pos);
+		MICRO_TEST(idx < size);
+		if (idx < size)
+			++count[idx];
+	}
+	// lock_index() is a permutation of [0, l1_size)
+	for (unsigned c : count)
+		MICRO_TEST(c == 1);
+
+#if MICRO_PAD_LOCKS
+	MICRO_TEST(alignof(RadixLeaf) >= MICRO_CACHE_LINE_SIZE);
+	MICRO_TEST(offsetof(RadixLeaf, locks) % MICRO_CACHE_LINE_SIZE == 0);
+	const unsigned per_line = MICRO_CACHE_LINE_SIZE / sizeof(RadixLeaf::lock_type);
+	if (RadixLeaf::lock_lines > 1) {
+		for (unsigned pos = 0; pos + 1 < size; ++pos)
+			MICRO_TEST(RadixLeaf::lock_index(pos) / per_line != RadixLeaf::lock_index(pos + 1) / per_line);
+	}
+#endif
+
+	// align() returns a suitably aligned address within alignof(RadixLeaf) bytes
+	alignas(RadixLeaf) static char buf[sizeof(RadixLeaf) * 2];
+	for (unsigned off = 0; off < alignof(RadixLeaf); ++off) {
+		RadixLeaf* l = RadixLeaf::align(buf + off);
+		MICRO_TEST(reinterpret_cast<std::uintptr_t>(l) % alignof(RadixLeaf) == 0);
+		MICRO_TEST(reinterpret_cast<char*>(l) >= buf + off && reinterpret_cast<char*>(l) < buf + off + alignof(RadixLeaf));
+	}
+}
+
+static void class_thread(micro_heap* h, size_t size, bool* ok)
+{
+	static constexpr size_t batch = 16;
+	void* ptrs[batch];
+	*ok = true;
+	for (int i = 0; i < 20000 && *ok; ++i) {
+		for (size_t j = 0; j < batch; ++j) {
+			char* p = static_cast<char*>(micro_heap_malloc(h, size));
+			if (!p) {
+				*ok = false;
+				return;
+			}
+			memset(p, static_cast<char>(j), size);
+			ptrs[j] = p;
+		}
+		for (size_t j = 0; j < batch; ++j) {
+			const char* p = static_cast<const char*>(ptrs[j]);
+			if (p[0] != static_cast<char>(j) || p[size / 2] != static_cast<char>(j) || p[size - 1] != static_cast<char>(j))
+				*ok = false;
+			micro_free(ptrs[j]);
+		}
+	}
+}
+
+static void test_neighbor_classes(unsigned threads, size_t base_size)
+{
+	micro_heap* h = micro_heap_create();
+	MICRO_TEST(h != nullptr);
+	micro_heap_set_parameter(h, MicroMaxArenas, 1);
+
+	std::vector<std::thread> ths;
+	std::unique_ptr<bool[]> ok(new bool[threads]);
+	for (unsigned i = 0; i < threads; ++i)
+		ths.emplace_back(class_thread, h, base_size + i * 16u, &ok[i]);
+	for (auto& t : ths)
+		t.join();
+	for (unsigned i = 0; i < threads; ++i)
+		MICRO_TEST(ok[i]);
+	micro_heap_destroy(h);
+}
+
+int test_lock_layout(int, char** const)
+{
+	MICRO_TEST_MODULE_RETURN(lock_index, 1, test_lock_index());
+	MICRO_TEST_MODULE_RETURN(small_neighbor_classes, 1, test_neighbor_classes(4, 16));
+	MICRO_TEST_MODULE_RETURN(medium_neighbor_positions, 1, test_neighbor_classes(4, 1024));
+	return 0;
+}
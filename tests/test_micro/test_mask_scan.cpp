@@ -0,0 +1,127 @@
+#include <micro/micro.h>
+#include <micro/internal/uint_large.hpp>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+// scan_forward() and null() of the multi word masks used by the radix tree,
+// compared to a naive scan whatever the instruction set (portable, SSE4.1, AVX2).
+
+using namespace micro::detail;
+
+template<class U, unsigned Bits>
+static void check_scan(const U& u, const std::vector<bool>& ref)
+{
+	bool empty = true;
+	for (bool b : ref)
+		empty = empty && !b;
+	MICRO_TEST(u.null() == empty);
+	unsigned expect = Bits;
+	for (unsigned start = Bits; start-- > 0;) {
+		if (ref[start])
+			expect = start;
+		MICRO_TEST(u.scan_forward(start) == expect);
+	}
+}
+
+template<class U, unsigned Bits>
+static void test_mask()
+{
+	// Single bits, including word boundaries and the last bit
+	for (unsigned pos = 0; pos < Bits; ++pos) {
+		U u;
+		std::vector<bool> ref(Bits, false);
+		u.set(pos);
+		ref[pos] = true;
+		check_scan<U, Bits>(u, ref);
+		u.unset(pos);
+		ref[pos] = false;
+		check_scan<U, Bits>(u, ref);
+	}
+
+	// Random masks, progressively emptied
+	std::mt19937 gen(42);
+	std::uniform_int_distribution<unsigned> dist(0, Bits - 1);
+	for (unsigned count = 0; count < 16; ++count) {
+		U u;
+		std::vector<bool> ref(Bits, false);
+		std::vector<unsigned> set;
+		for (unsigned k = 0; k < count * count; ++k) {
+			unsigned p = dist(gen);
+			u.set(p);
+			ref[p] = true;
+			set.push_back(p);
+		}
+		check_scan<U, Bits>(u, ref);
+		for (unsigned p : set) {
+			u.unset(p);
+			ref[p] = false;
+		}
+		check_scan<U, Bits>(u, ref);
+	}
+}
+
+// Best fit lookup in a 2 levels bit mask, as done by RadixTree::lower_bound()
+static void test_two_levels(size_t entries)
+{
+	static constexpr unsigned l0 = 256;
+	static constexpr unsigned l1 = 512;
+	struct Tree
+	{
+		UInt256 mask;
+		UInt512 leaves[l0];
+	};
+	std::unique_ptr<Tree> tree(new Tree());
+	std::vector<bool> ref(l0 * l1, false);
+
+	std::mt19937 gen(42);
+	std::uniform_int_distribution<unsigned> dist(0, l0 * l1 - 1);
+	for (size_t i = 0; i < entries; ++i) {
+		unsigned pos = dist(gen);
+		tree->leaves[pos / l1].set(pos % l1);
+		tree->mask.set(pos / l1);
+		ref[pos] = true;
+	}
+
+	for (size_t i = 0; i < 10000; ++i) {
+		const unsigned pos = dist(gen);
+		unsigned expect = pos;
+		while (expect < l0 * l1 && !ref[expect])
+			++expect;
+
+		unsigned index0 = pos / l1;
+		unsigned index1 = pos % l1;
+		unsigned found = l0 * l1;
+		for (;;) {
+			unsigned i0 = tree->mask.scan_forward(index0);
+			if (i0 == l0)
+				break;
+			if (i0 != index0)
+				index1 = 0;
+			unsigned i1 = tree->leaves[i0].scan_forward(index1);
+			if (i1 != l1) {
+				found = i0 * l1 + i1;
+				break;
+			}
+			if (++i0 == l0)
+				break;
+			index0 = i0;
+			index1 = 0;
+		}
+		MICRO_TEST(found == expect);
+	}
+}
+
+int test_mask_scan(int, char** const)
+{
+	MICRO_TEST_MODULE_RETURN(mask_128, 1, (test_mask<UInt128, 128>()));
+	MICRO_TEST_MODULE_RETURN(mask_256, 1, (test_mask<UInt256, 256>()));
+	MICRO_TEST_MODULE_RETURN(mask_512, 1, (test_mask<UInt512, 512>()));
+	MICRO_TEST_MODULE_RETURN(sparse_tree, 1, test_two_levels(16));
+	MICRO_TEST_MODULE_RETURN(medium_tree, 1, test_two_levels(1024));
+	MICRO_TEST_MODULE_RETURN(dense_tree, 1, test_two_levels(256 * 512 / 2));
+	return 0;
+}
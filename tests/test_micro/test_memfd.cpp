@@ -0,0 +1,112 @@
+#include <micro/micro.h>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// Memfd page provider (MicroMemfdProvider): chunks of all sizes live in a growing
+// anonymous file exposed by micro_heap_file_descriptor(). The file can be mapped a
+// second time, and its physical memory is released once all chunks are freed.
+
+#ifdef __linux__
+
+static micro_heap* create_memfd_heap()
+{
+	micro_heap* h = micro_heap_create();
+	if (h) {
+		micro_heap_set_parameter(h, MicroProviderType, MicroMemfdProvider);
+		micro_heap_set_parameter(h, MicroPageFileFlags, MicroGrowing);
+		micro_heap_set_parameter(h, MicroPageMemorySize, 16u << 20u);
+		micro_heap_set_string_parameter(h, MicroPageFileProvider, "micro_test_memfd");
+	}
+	return h;
+}
+
+static void random_allocations(micro_heap* h)
+{
+	std::mt19937 gen(42);
+	std::uniform_int_distribution<size_t> small_distribution(1, 256);
+	std::uniform_int_distribution<size_t> medium_distribution(1024, 64 * 1024);
+	std::uniform_int_distribution<size_t> big_distribution(1024 * 1024, 4 * 1024 * 1024);
+	std::vector<char*> ptrs;
+	std::vector<size_t> sizes;
+
+	for (size_t i = 0; i < 100000; ++i) {
+		if (ptrs.size() == 5000 || (!ptrs.empty() && (gen() & 1))) {
+			size_t k = gen() % ptrs.size();
+			MICRO_TEST(ptrs[k][0] == static_cast<char>(sizes[k]) && ptrs[k][sizes[k] - 1] == static_cast<char>(sizes[k]));
+			micro_free(ptrs[k]);
+			ptrs[k] = ptrs.back();
+			sizes[k] = sizes.back();
+			ptrs.pop_back();
+			sizes.pop_back();
+			continue;
+		}
+		size_t size = (i % 1000 == 0) ? big_distribution(gen) : ((i % 10 == 0) ? medium_distribution(gen) : small_distribution(gen));
+		char* p = static_cast<char*>(micro_heap_malloc(h, size));
+		MICRO_TEST(p != nullptr);
+		p[0] = p[size - 1] = static_cast<char>(size);
+		ptrs.push_back(p);
+		sizes.push_back(size);
+	}
+	for (char* p : ptrs)
+		micro_free(p);
+}
+
+static void test_memfd_heap()
+{
+	// Other providers have no file descriptor
+	micro_heap* os = micro_heap_create();
+	MICRO_TEST(os != nullptr);
+	MICRO_TEST(micro_heap_file_descriptor(os) < 0);
+	micro_heap_destroy(os);
+
+	micro_heap* h = create_memfd_heap();
+	MICRO_TEST(h != nullptr);
+	const int fd = micro_heap_file_descriptor(h);
+	MICRO_TEST(fd >= 0);
+
+	random_allocations(h);
+
+	// Released pages are given back by punching holes
+	micro_heap_trim(h, 0);
+	struct stat st = {};
+	MICRO_TEST(fstat(fd, &st) == 0);
+	MICRO_TEST(st.st_size > 0);
+	MICRO_TEST(st.st_blocks * 512 <= st.st_size / 2);
+
+	// Map the file a second time: both views share the same pages
+	const char pattern[] = "micro memfd double mapping";
+	char* chunk = static_cast<char*>(micro_heap_malloc(h, 100000));
+	MICRO_TEST(chunk != nullptr);
+	memcpy(chunk, pattern, sizeof(pattern));
+	MICRO_TEST(fstat(fd, &st) == 0);
+	const size_t size = static_cast<size_t>(st.st_size);
+	void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	MICRO_TEST(view != MAP_FAILED);
+	char* found = static_cast<char*>(memmem(view, size, pattern, sizeof(pattern)));
+	MICRO_TEST(found != nullptr);
+	found[0] = 'M';
+	MICRO_TEST(chunk[0] == 'M');
+	munmap(view, size);
+
+	micro_free(chunk);
+	micro_heap_destroy(h);
+}
+
+#endif
+
+int test_memfd(int, char** const)
+{
+#ifdef __linux__
+	MICRO_TEST_MODULE_RETURN(memfd_heap, 1, test_memfd_heap());
+#endif
+	return 0;
+}
@@ -0,0 +1,129 @@
+#include <micro/micro.h>
+#include <micro/micro.hpp>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <random>
+#include <vector>
+
+// MemoryPageProvider on a user buffer: page runs are inside the buffer and do not
+// overlap, allocation only fails when no free run is big enough, and freed runs
+// are merged with their neighbors.
+
+static constexpr size_t page_size = 4096;
+static constexpr size_t buffer_pages = 65536;
+
+struct Alloc
+{
+	char* p;
+	size_t count;
+};
+
+// Allocated and free runs must exactly cover the buffer pages not used by the metadata
+static void check_runs(micro::MemoryPageProvider& provider, const std::vector<Alloc>& allocs, char* begin, char* end)
+{
+	std::vector<char> used(static_cast<size_t>(end - begin) / page_size, 0);
+	size_t allocated = 0;
+	auto mark = [&](char* p, size_t count) {
+		MICRO_TEST(p >= begin && p + count * page_size <= end);
+		if (p < begin || p + count * page_size > end)
+			return;
+		size_t first = static_cast<size_t>(p - begin) / page_size;
+		for (size_t j = first; j < first + count; ++j) {
+			MICRO_TEST(!used[j]);
+			used[j] = 1;
+		}
+	};
+	for (const Alloc& a : allocs) {
+		mark(a.p, a.count);
+		allocated += a.count;
+	}
+	MICRO_TEST(provider.allocated_pages() == allocated);
+
+	size_t free_pages = 0;
+	provider.for_each_free_run([&](char* p, size_t count) {
+		mark(p, count);
+		free_pages += count;
+	});
+	const size_t metadata = micro::MemoryPageProvider::metadata_bytes(buffer_pages, page_size) / page_size;
+	MICRO_TEST(allocated + free_pages + metadata == buffer_pages);
+}
+
+static void test_random_runs()
+{
+	const size_t bytes = buffer_pages * page_size;
+	char* buffer = static_cast<char*>(micro::os_allocate_pages(bytes / micro::os_page_size()));
+	MICRO_TEST(buffer != nullptr);
+
+	{
+		micro::parameters params;
+		micro::MemoryPageProvider provider(params, static_cast<unsigned>(page_size), false, buffer, bytes);
+		const size_t capacity = provider.max_pages();
+		MICRO_TEST(capacity > 0 && capacity < buffer_pages);
+
+		std::mt19937 gen(42);
+		std::uniform_int_distribution<size_t> small_count(1, 8);
+		std::uniform_int_distribution<size_t> large_count(9, 256);
+
+		// Fragment the buffer: fill it, then free every other run
+		std::vector<Alloc> allocs;
+		for (;;) {
+			size_t count = (allocs.size() & 7) ? small_count(gen) : large_count(gen);
+			char* p = static_cast<char*>(provider.allocate_pages(count));
+			if (!p) {
+				MICRO_TEST(provider.max_pages() < count);
+				break;
+			}
+			allocs.push_back(Alloc{ p, count });
+		}
+		size_t kept = 0;
+		for (size_t i = 0; i < allocs.size(); ++i) {
+			if (i & 1)
+				MICRO_TEST(provider.deallocate_pages(allocs[i].p, allocs[i].count));
+			else
+				allocs[kept++] = allocs[i];
+		}
+		allocs.resize(kept);
+		check_runs(provider, allocs, buffer, buffer + bytes);
+
+		// Mixed allocations/deallocations on the fragmented buffer
+		for (size_t i = 0; i < 100000; ++i) {
+			if (!allocs.empty() && (gen() & 1)) {
+				size_t k = gen() % allocs.size();
+				MICRO_TEST(provider.deallocate_pages(allocs[k].p, allocs[k].count));
+				allocs[k] = allocs.back();
+				allocs.pop_back();
+			}
+			else {
+				size_t count = (i & 7) ? small_count(gen) : large_count(gen);
+				const size_t max_pages = provider.max_pages();
+				if (char* p = static_cast<char*>(provider.allocate_pages(count)))
+					allocs.push_back(Alloc{ p, count });
+				else
+					MICRO_TEST(max_pages < count);
+			}
+			if (i % 10000 == 0)
+				check_runs(provider, allocs, buffer, buffer + bytes);
+		}
+		check_runs(provider, allocs, buffer, buffer + bytes);
+
+		// Freeing everything merges all runs back
+		for (const Alloc& a : allocs)
+			MICRO_TEST(provider.deallocate_pages(a.p, a.count));
+		MICRO_TEST(provider.empty());
+		MICRO_TEST(provider.max_pages() == capacity);
+		void* p = provider.allocate_pages(capacity);
+		MICRO_TEST(p != nullptr);
+		MICRO_TEST(provider.allocate_pages(1) == nullptr);
+		MICRO_TEST(provider.deallocate_pages(p, capacity));
+		MICRO_TEST(provider.empty());
+	}
+
+	micro::os_free_pages(buffer, bytes / micro::os_page_size());
+}
+
+int test_page_provider(int, char** const)
+{
+	MICRO_TEST_MODULE_RETURN(memory_page_provider, 1, test_random_runs());
+	return 0;
+}
@@ -0,0 +1,122 @@
+#include <micro/micro.h>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+// Persistent heap (MicroFileProvider with MicroPersistent flag): a linked list of
+// small, medium and big nodes survives destroying and reopening the heap, and the
+// reopened heap keeps allocating and freeing without overwriting live nodes.
+
+static const char* file_name = "micro_test_persistent.bin";
+
+struct Node
+{
+	Node* next;
+	std::uint32_t size;
+	std::uint32_t seed;
+};
+
+static micro_heap* open_heap(unsigned flags)
+{
+	micro_heap* h = micro_heap_create();
+	if (h) {
+		micro_heap_set_parameter(h, MicroProviderType, MicroFileProvider);
+		micro_heap_set_parameter(h, MicroPageFileFlags, flags);
+		micro_heap_set_parameter(h, MicroPageMemorySize, 16u << 20u);
+		micro_heap_set_string_parameter(h, MicroPageFileProvider, file_name);
+	}
+	return h;
+}
+
+static Node* new_node(micro_heap* h, std::mt19937& gen, size_t i, Node* next)
+{
+	std::uniform_int_distribution<std::uint32_t> small_distribution(sizeof(Node) + 1, 256);
+	std::uniform_int_distribution<std::uint32_t> medium_distribution(1024, 64 * 1024);
+	std::uniform_int_distribution<std::uint32_t> big_distribution(1024 * 1024, 4 * 1024 * 1024);
+	std::uint32_t size = (i % 1000 == 0) ? big_distribution(gen) : ((i % 10 == 0) ? medium_distribution(gen) : small_distribution(gen));
+
+	Node* n = static_cast<Node*>(micro_heap_malloc(h, size));
+	MICRO_TEST(n != nullptr);
+	memset(n, static_cast<char>(i), size);
+	n->next = next;
+	n->size = size;
+	n->seed = static_cast<std::uint32_t>(i);
+	return n;
+}
+
+static void check_list(Node* head, size_t expected)
+{
+	size_t count = 0;
+	for (Node* n = head; n; n = n->next) {
+		const char c = static_cast<char>(n->seed);
+		MICRO_TEST(reinterpret_cast<char*>(n)[sizeof(Node)] == c && reinterpret_cast<char*>(n)[n->size - 1] == c);
+		MICRO_TEST(micro_usable_size(n) >= n->size);
+		++count;
+	}
+	MICRO_TEST(count == expected);
+}
+
+static std::uint64_t used_memory(micro_heap* h)
+{
+	micro_statistics st;
+	memset(&st, 0, sizeof(st));
+	micro_heap_dump_stats(h, &st);
+	return st.current_used_memory;
+}
+
+static void test_reopen(size_t nodes)
+{
+	std::remove(file_name);
+	std::mt19937 gen(42);
+
+	micro_heap* h = open_heap(MicroGrowing | MicroPersistent);
+	MICRO_TEST(h != nullptr);
+	Node* head = nullptr;
+	for (size_t i = 0; i < nodes; ++i)
+		head = new_node(h, gen, i, head);
+	micro_heap_set_root(h, head);
+	std::uint64_t used = used_memory(h);
+	micro_heap_destroy(h);
+
+	size_t expected = nodes;
+	for (unsigned round = 0; round < 3; ++round) {
+		// The root, the list and the allocator state are restored
+		h = open_heap(MicroGrowing | MicroPersistent);
+		MICRO_TEST(h != nullptr);
+		head = static_cast<Node*>(micro_heap_get_root(h));
+		MICRO_TEST(head != nullptr);
+		check_list(head, expected);
+		MICRO_TEST(used_memory(h) == used);
+
+		// Free every other node, and add new ones
+		for (Node* prev = head; prev && prev->next; prev = prev->next) {
+			Node* n = prev->next;
+			prev->next = n->next;
+			micro_free(n);
+			--expected;
+		}
+		for (size_t i = 0; i < nodes / 4; ++i, ++expected)
+			head = new_node(h, gen, i, head);
+		check_list(head, expected);
+		micro_heap_set_root(h, head);
+		used = used_memory(h);
+		micro_heap_destroy(h);
+	}
+
+	// Without MicroPersistent, the file content is discarded
+	h = open_heap(MicroGrowing);
+	MICRO_TEST(h != nullptr);
+	MICRO_TEST(micro_heap_get_root(h) == nullptr);
+	micro_heap_destroy(h);
+	std::remove(file_name);
+}
+
+int test_persistent(int, char** const)
+{
+	MICRO_TEST_MODULE_RETURN(persistent_small, 1, test_reopen(100));
+	MICRO_TEST_MODULE_RETURN(persistent_large, 1, test_reopen(10000));
+	return 0;
+}
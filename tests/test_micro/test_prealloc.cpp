@@ -0,0 +1,109 @@
+#include <micro/micro.h>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <cstring>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+// Preallocated page provider (MicroOSPreallocProvider) with all micro_prealloc_flags:
+// chunks are served from the preallocated range until it is exhausted, and populated
+// pages do not fault again on the allocation path.
+
+static constexpr size_t prealloc_size = 64u << 20u;
+static constexpr size_t chunk_size = 64u << 10u;
+static constexpr size_t fill_chunks = (48u << 20u) / chunk_size;
+
+static long minor_faults()
+{
+#ifndef _WIN32
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_minflt;
+#else
+	return 0;
+#endif
+}
+
+// Fill most of the preallocated range, returns the page faults of the fill
+static long test_flags(unsigned flags)
+{
+	micro_heap* h = micro_heap_create();
+	MICRO_TEST(h != nullptr);
+	micro_heap_set_parameter(h, MicroProviderType, MicroOSPreallocProvider);
+	micro_heap_set_parameter(h, MicroPageMemorySize, prealloc_size);
+	micro_heap_set_parameter(h, MicroAllowOsPageAlloc, 0);
+	micro_heap_set_parameter(h, MicroPreallocFlags, flags);
+
+	// The first allocation creates the heap and preallocates the pages
+	micro_free(micro_heap_malloc(h, 16));
+	micro_statistics st;
+	memset(&st, 0, sizeof(st));
+	micro_heap_dump_stats(h, &st);
+	if (flags & (MicroPreallocPopulate | MicroPreallocParallel))
+		MICRO_TEST(st.prealloc_time_ns > 0);
+
+	std::vector<char*> ptrs(fill_chunks);
+	const long first_faults = minor_faults();
+	for (size_t i = 0; i < fill_chunks; ++i) {
+		ptrs[i] = static_cast<char*>(micro_heap_malloc(h, chunk_size));
+		MICRO_TEST(ptrs[i] != nullptr);
+		memset(ptrs[i], static_cast<int>(i), chunk_size);
+	}
+	const long faults = minor_faults() - first_faults;
+
+	// All chunks lie in the preallocated range
+	std::uintptr_t lo = ~static_cast<std::uintptr_t>(0), hi = 0;
+	for (size_t i = 0; i < fill_chunks; ++i) {
+		std::uintptr_t p = reinterpret_cast<std::uintptr_t>(ptrs[i]);
+		lo = p < lo ? p : lo;
+		hi = p + chunk_size > hi ? p + chunk_size : hi;
+		MICRO_TEST(ptrs[i][0] == static_cast<char>(i) && ptrs[i][chunk_size - 1] == static_cast<char>(i));
+	}
+	MICRO_TEST(hi - lo <= prealloc_size);
+
+	// No OS fallback: allocations fail once the range is exhausted
+	std::vector<void*> extra;
+	while (void* p = micro_heap_malloc(h, chunk_size)) {
+		extra.push_back(p);
+		MICRO_TEST(extra.size() * chunk_size <= prealloc_size);
+	}
+	for (void* p : extra)
+		micro_free(p);
+	for (char* p : ptrs)
+		micro_free(p);
+	void* p = micro_heap_malloc(h, chunk_size);
+	MICRO_TEST(p != nullptr);
+	micro_free(p);
+	micro_heap_destroy(h);
+	return faults;
+}
+
+static void test_populate()
+{
+	const long lazy = test_flags(MicroPreallocLazy);
+	const long populate = test_flags(MicroPreallocPopulate);
+	const long parallel = test_flags(MicroPreallocParallel);
+	// Falls back to populate if the pages cannot be locked
+	const long lock = test_flags(MicroPreallocLock);
+	test_flags(MicroPreallocHugePages | MicroPreallocPopulate);
+#ifndef _WIN32
+	MICRO_TEST(populate * 4 <= lazy);
+	MICRO_TEST(parallel * 4 <= lazy);
+	MICRO_TEST(lock * 4 <= lazy);
+#else
+	(void)lazy;
+	(void)populate;
+	(void)parallel;
+	(void)lock;
+#endif
+}
+
+int test_prealloc(int, char** const)
+{
+	MICRO_TEST_MODULE_RETURN(prealloc_flags, 1, test_populate());
+	return 0;
+}
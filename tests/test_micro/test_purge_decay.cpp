@@ -0,0 +1,104 @@
+#include <micro/micro.h>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+// With MicroPurgeDecayMs, free page runs are returned by the background purge
+// thread once they were unused for the decay time. Without it, nothing is purged.
+
+static micro_statistics heap_stats(micro_heap* h)
+{
+	micro_statistics st;
+	memset(&st, 0, sizeof(st));
+	micro_heap_dump_stats(h, &st);
+	return st;
+}
+
+static void burst_thread(micro_heap* h, unsigned seed, bool* ok)
+{
+	static constexpr size_t burst_size = 256;
+	std::mt19937 gen(seed);
+	std::uniform_int_distribution<> size_distribution(16 * 1024, 96 * 1024);
+
+	std::vector<char*> ptrs(burst_size);
+	*ok = true;
+	for (int i = 0; i < 20 && *ok; ++i) {
+		for (size_t j = 0; j < burst_size; ++j) {
+			size_t size = static_cast<size_t>(size_distribution(gen));
+			char* p = static_cast<char*>(micro_heap_malloc(h, size));
+			if (!p) {
+				*ok = false;
+				return;
+			}
+			p[0] = p[size - 1] = static_cast<char>(j);
+			ptrs[j] = p;
+		}
+		for (size_t j = 0; j < burst_size; ++j) {
+			if (ptrs[j][0] != static_cast<char>(j))
+				*ok = false;
+			micro_free(ptrs[j]);
+		}
+	}
+}
+
+static void run_bursts(micro_heap* h, unsigned threads)
+{
+	std::vector<std::thread> ths;
+	std::unique_ptr<bool[]> ok(new bool[threads]);
+	for (unsigned i = 0; i < threads; ++i)
+		ths.emplace_back(burst_thread, h, 42 + i, &ok[i]);
+	for (auto& t : ths)
+		t.join();
+	for (unsigned i = 0; i < threads; ++i)
+		MICRO_TEST(ok[i]);
+}
+
+static void test_purge(unsigned threads, unsigned decay_ms)
+{
+	micro_heap* h = micro_heap_create();
+	MICRO_TEST(h != nullptr);
+	micro_heap_set_parameter(h, MicroPurgeDecayMs, decay_ms);
+
+	run_bursts(h, threads);
+
+	// Free page runs are returned within a few decay periods
+	micro_statistics st = heap_stats(h);
+	for (int i = 0; i < 100 && st.purged_bytes == 0; ++i) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(decay_ms));
+		st = heap_stats(h);
+	}
+	MICRO_TEST(st.purged_bytes > 0);
+	MICRO_TEST(st.purge_count > 0);
+
+	// The heap is still usable after a purge
+	run_bursts(h, threads);
+	micro_heap_destroy(h);
+}
+
+static void test_no_purge()
+{
+	micro_heap* h = micro_heap_create();
+	MICRO_TEST(h != nullptr);
+	micro_heap_set_parameter(h, MicroPurgeDecayMs, 0);
+	run_bursts(h, 1);
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	micro_statistics st = heap_stats(h);
+	MICRO_TEST(st.purged_bytes == 0 && st.purge_count == 0);
+	micro_heap_destroy(h);
+}
+
+int test_purge_decay(int, char** const)
+{
+#ifndef MICRO_NO_LOCK
+	MICRO_TEST_MODULE_RETURN(no_purge, 1, test_no_purge());
+	MICRO_TEST_MODULE_RETURN(purge_decay_1, 1, test_purge(1, 20));
+	MICRO_TEST_MODULE_RETURN(purge_decay_4, 1, test_purge(4, 20));
+#endif
+	return 0;
+}
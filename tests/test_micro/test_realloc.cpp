@@ -0,0 +1,173 @@
+#include <micro/micro.h>
+#include <micro/micro.hpp>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Medium chunks grow and shrink in place on realloc when the next chunk is free,
+// big chunks are remapped (Linux only), and growing buffers keep their content
+// whatever the reallocation path.
+
+static void fill(char* p, size_t from, size_t to, char c)
+{
+	memset(p + from, c, to - from);
+}
+static bool check(const char* p, size_t size, char c)
+{
+	// Sparse check of the buffer content
+	for (size_t i = 0; i < size; i += 61)
+		if (p[i] != c)
+			return false;
+	return p[size - 1] == c;
+}
+
+static void test_medium_in_place()
+{
+	micro_heap* h = micro_heap_create();
+	MICRO_TEST(h != nullptr);
+
+	// First chunk of a new heap, followed by free space
+	char* p = static_cast<char*>(micro_heap_malloc(h, 4096));
+	MICRO_TEST(p != nullptr);
+	fill(p, 0, 4096, 'a');
+	MICRO_TEST(micro_expand(p, 16384) == p);
+	MICRO_TEST(micro_usable_size(p) >= 16384);
+	MICRO_TEST(check(p, 4096, 'a'));
+
+	// The next chunk is used: growing in place fails, realloc moves the chunk
+	char* q = static_cast<char*>(micro_heap_malloc(h, 4096));
+	MICRO_TEST(q != nullptr);
+	MICRO_TEST(micro_expand(p, 65536) == nullptr);
+	MICRO_TEST(micro_usable_size(p) >= 16384);
+
+	// Shrinking releases the tail, which is absorbed again when growing
+	MICRO_TEST(micro_expand(p, 2048) == p);
+	MICRO_TEST(micro_usable_size(p) >= 2048 && micro_usable_size(p) < 16384);
+	MICRO_TEST(micro_expand(p, 16384) == p);
+	MICRO_TEST(check(p, 2048, 'a'));
+
+	// Small chunks are never resized beyond their usable size
+	void* s = micro_heap_malloc(h, 32);
+	MICRO_TEST(s != nullptr);
+	MICRO_TEST(micro_expand(s, 16) == s);
+	MICRO_TEST(micro_expand(s, 1000) == nullptr);
+
+	// realloc() does not shrink by less than half
+	MICRO_TEST(micro_realloc(p, micro_usable_size(p) - 16) == p);
+	fill(p, 0, 16384, 'b');
+	char* r = static_cast<char*>(micro_realloc(p, 65536));
+	MICRO_TEST(r != nullptr && r != p);
+	MICRO_TEST(check(r, 16384, 'b'));
+
+	micro_free(r);
+	micro_free(q);
+	micro_free(s);
+	micro_heap_destroy(h);
+}
+
+static void test_big_remap()
+{
+	static constexpr size_t min_buffer_size = 1024 * 1024;
+	static constexpr size_t max_buffer_size = 64 * 1024 * 1024;
+
+	micro_heap* h = micro_heap_create();
+	MICRO_TEST(h != nullptr);
+
+	// Grow then shrink a single buffer in the big chunk range
+	size_t size = min_buffer_size;
+	char* p = static_cast<char*>(micro_heap_malloc(h, size));
+	MICRO_TEST(p != nullptr);
+	fill(p, 0, size, 'b');
+	for (size_t new_size = size + size / 2; new_size <= max_buffer_size; new_size += new_size / 2) {
+#ifdef __linux__
+		char* r = static_cast<char*>(micro::heap::try_reallocate(p, new_size));
+		MICRO_TEST(r != nullptr);
+#else
+		char* r = static_cast<char*>(micro_heap_realloc(h, p, new_size));
+		MICRO_TEST(r != nullptr);
+#endif
+		MICRO_TEST(micro_usable_size(r) >= new_size);
+		MICRO_TEST(check(r, size, 'b'));
+		fill(r, size, new_size, 'b');
+		p = r;
+		size = new_size;
+	}
+	for (size_t new_size = size / 3; new_size >= min_buffer_size; new_size /= 3) {
+		char* r = static_cast<char*>(micro_heap_realloc(h, p, new_size));
+		MICRO_TEST(r != nullptr);
+		MICRO_TEST(check(r, new_size, 'b'));
+		p = r;
+		size = new_size;
+	}
+	micro_free(p);
+	micro_heap_destroy(h);
+}
+
+static void realloc_thread(unsigned seed, bool* ok)
+{
+	static constexpr int num_buffers = 64;
+	static constexpr size_t min_buffer_size = 1024;
+	static constexpr size_t max_buffer_size = 256 * 1024;
+	static constexpr int num_iterations = 20000;
+
+	char* buffers[num_buffers];
+	size_t sizes[num_buffers];
+	for (int i = 0; i < num_buffers; ++i) {
+		sizes[i] = min_buffer_size;
+		buffers[i] = static_cast<char*>(micro_malloc(min_buffer_size));
+		fill(buffers[i], 0, min_buffer_size, static_cast<char>(i));
+	}
+
+	std::mt19937 gen(seed);
+	std::uniform_int_distribution<> buf_number_distribution(0, num_buffers - 1);
+	std::uniform_int_distribution<> grow_distribution(16, 4096);
+	std::uniform_int_distribution<> shrink_distribution(0, 15);
+
+	*ok = true;
+	for (int i = 0; i < num_iterations && *ok; ++i) {
+		int idx = buf_number_distribution(gen);
+		size_t new_size = sizes[idx] + static_cast<size_t>(grow_distribution(gen));
+		if (new_size > max_buffer_size || shrink_distribution(gen) == 0)
+			new_size = min_buffer_size + (new_size % 4096);
+
+		char* p = static_cast<char*>(micro_realloc(buffers[idx], new_size));
+		if (!p || !check(p, std::min(sizes[idx], new_size), static_cast<char>(idx))) {
+			*ok = false;
+			break;
+		}
+		if (new_size > sizes[idx])
+			fill(p, sizes[idx], new_size, static_cast<char>(idx));
+		buffers[idx] = p;
+		sizes[idx] = new_size;
+	}
+
+	for (int i = 0; i < num_buffers; ++i)
+		micro_free(buffers[i]);
+}
+
+static void test_growing_buffers(unsigned threads)
+{
+	std::vector<std::thread> ths;
+	std::unique_ptr<bool[]> ok(new bool[threads]);
+	for (unsigned i = 0; i < threads; ++i)
+		ths.emplace_back(realloc_thread, 42 + i, &ok[i]);
+	for (auto& t : ths)
+		t.join();
+	for (unsigned i = 0; i < threads; ++i)
+		MICRO_TEST(ok[i]);
+}
+
+int test_realloc(int, char** const)
+{
+	MICRO_TEST_MODULE_RETURN(medium_in_place, 1, test_medium_in_place());
+	MICRO_TEST_MODULE_RETURN(big_remap, 1, test_big_remap());
+	MICRO_TEST_MODULE_RETURN(growing_buffers_1, 1, test_growing_buffers(1));
+	MICRO_TEST_MODULE_RETURN(growing_buffers_4, 1, test_growing_buffers(4));
+	return 0;
+}
@@ -0,0 +1,115 @@
+#include <micro/micro.h>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Small objects allocated by producer threads and freed by consumer threads,
+// with and without deferred remote frees (MicroRemoteFree). Remotely freed
+// objects must keep their content until freed, and be reused by their owner.
+
+static constexpr size_t num_objects = 500000;
+static constexpr size_t queue_size = 1024;
+
+// Single producer single consumer ring buffer
+struct Queue
+{
+	std::atomic<size_t> head{ 0 };
+	std::atomic<size_t> tail{ 0 };
+	void* slots[queue_size];
+
+	void push(void* p)
+	{
+		size_t t = tail.load(std::memory_order_relaxed);
+		while (t - head.load(std::memory_order_acquire) == queue_size)
+			std::this_thread::yield();
+		slots[t % queue_size] = p;
+		tail.store(t + 1, std::memory_order_release);
+	}
+	void* pop()
+	{
+		size_t h = head.load(std::memory_order_relaxed);
+		while (tail.load(std::memory_order_acquire) == h)
+			std::this_thread::yield();
+		void* p = slots[h % queue_size];
+		head.store(h + 1, std::memory_order_release);
+		return p;
+	}
+};
+
+static void producer(micro_heap* h, Queue* q, unsigned seed, bool* ok)
+{
+	std::mt19937 gen(seed);
+	std::uniform_int_distribution<> size_distribution(16, 255);
+	*ok = true;
+	for (size_t i = 0; i < num_objects; ++i) {
+		size_t size = static_cast<size_t>(size_distribution(gen));
+		char* p = static_cast<char*>(micro_heap_malloc(h, size));
+		if (!p) {
+			*ok = false;
+			q->push(nullptr);
+			return;
+		}
+		memset(p, static_cast<char>(size), size);
+		q->push(p);
+	}
+}
+
+static void consumer(Queue* q, bool* ok)
+{
+	*ok = true;
+	for (size_t i = 0; i < num_objects; ++i) {
+		char* p = static_cast<char*>(q->pop());
+		if (!p) {
+			*ok = false;
+			return;
+		}
+		// First byte stores the size
+		size_t size = static_cast<unsigned char>(p[0]);
+		if (size < 16 || p[size - 1] != p[0])
+			*ok = false;
+		micro_free(p);
+	}
+}
+
+static void test_pipeline(unsigned pairs, bool remote_free)
+{
+	micro_heap* h = micro_heap_create();
+	MICRO_TEST(h != nullptr);
+	micro_heap_set_parameter(h, MicroRemoteFree, remote_free);
+
+	std::unique_ptr<Queue[]> queues(new Queue[pairs]);
+	std::unique_ptr<bool[]> ok(new bool[pairs * 2]);
+	std::vector<std::thread> ths;
+	for (unsigned i = 0; i < pairs; ++i) {
+		ths.emplace_back(producer, h, &queues[i], 42 + i, &ok[i * 2]);
+		ths.emplace_back(consumer, &queues[i], &ok[i * 2 + 1]);
+	}
+	for (auto& t : ths)
+		t.join();
+	for (unsigned i = 0; i < pairs * 2; ++i)
+		MICRO_TEST(ok[i]);
+
+	// At most queue_size objects per pair are alive at once: remotely freed objects
+	// are given back to their blocks and reused instead of growing the heap.
+	micro_statistics st;
+	memset(&st, 0, sizeof(st));
+	micro_heap_dump_stats(h, &st);
+	MICRO_TEST(st.current_used_memory < pairs * (16u << 20u));
+
+	micro_heap_destroy(h);
+}
+
+int test_remote_free(int, char** const)
+{
+	MICRO_TEST_MODULE_RETURN(locked_free_1, 1, test_pipeline(1, false));
+	MICRO_TEST_MODULE_RETURN(remote_free_1, 1, test_pipeline(1, true));
+	MICRO_TEST_MODULE_RETURN(locked_free_2, 1, test_pipeline(2, false));
+	MICRO_TEST_MODULE_RETURN(remote_free_2, 1, test_pipeline(2, true));
+	return 0;
+}
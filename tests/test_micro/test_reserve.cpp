@@ -0,0 +1,114 @@
+#include <micro/micro.h>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+// With MicroOSReserveProvider, all page runs of a heap are carved from a single
+// reserved address range, and the heap fails cleanly once the range is exhausted.
+
+static constexpr size_t reserve_size = 256u << 20u;
+
+static micro_heap* create_heap(bool allow_os)
+{
+	micro_heap* h = micro_heap_create();
+	if (h) {
+		micro_heap_set_parameter(h, MicroProviderType, MicroOSReserveProvider);
+		micro_heap_set_parameter(h, MicroPageMemorySize, reserve_size);
+		micro_heap_set_parameter(h, MicroAllowOsPageAlloc, allow_os);
+	}
+	return h;
+}
+
+// Allocate medium and big chunks, free every other chunk and allocate them again
+static void fill(micro_heap* h, size_t count, std::vector<char*>& ptrs, std::vector<size_t>& sizes)
+{
+	std::mt19937 gen(42);
+	std::uniform_int_distribution<size_t> medium_distribution(1024, 64 * 1024);
+	std::uniform_int_distribution<size_t> big_distribution(1024 * 1024, 4 * 1024 * 1024);
+
+	ptrs.assign(count, nullptr);
+	sizes.assign(count, 0);
+	for (size_t i = 0; i < count; ++i) {
+		sizes[i] = (i % 100) ? medium_distribution(gen) : big_distribution(gen);
+		ptrs[i] = static_cast<char*>(micro_heap_malloc(h, sizes[i]));
+		MICRO_TEST(ptrs[i] != nullptr);
+		memset(ptrs[i], static_cast<char>(i), sizes[i]);
+	}
+	for (size_t i = 0; i < count; i += 2)
+		micro_free(ptrs[i]);
+	for (size_t i = 0; i < count; i += 2) {
+		ptrs[i] = static_cast<char*>(micro_heap_malloc(h, sizes[i]));
+		MICRO_TEST(ptrs[i] != nullptr);
+		memset(ptrs[i], static_cast<char>(i), sizes[i]);
+	}
+	for (size_t i = 0; i < count; ++i)
+		MICRO_TEST(ptrs[i][0] == static_cast<char>(i) && ptrs[i][sizes[i] - 1] == static_cast<char>(i));
+}
+
+static void test_single_range()
+{
+	micro_heap* h = create_heap(false);
+	MICRO_TEST(h != nullptr);
+
+	std::vector<char*> ptrs;
+	std::vector<size_t> sizes;
+	fill(h, 2000, ptrs, sizes);
+
+	// All chunks lie within the reserved range
+	std::uintptr_t lo = ~static_cast<std::uintptr_t>(0), hi = 0;
+	for (size_t i = 0; i < ptrs.size(); ++i) {
+		std::uintptr_t p = reinterpret_cast<std::uintptr_t>(ptrs[i]);
+		lo = p < lo ? p : lo;
+		hi = p + sizes[i] > hi ? p + sizes[i] : hi;
+	}
+	MICRO_TEST(hi - lo <= reserve_size);
+
+	// The whole range is released by clear() and can be used again
+	micro_heap_clear(h);
+	fill(h, 2000, ptrs, sizes);
+	for (char* p : ptrs)
+		micro_free(p);
+	micro_heap_destroy(h);
+}
+
+static void test_exhausted(bool allow_os)
+{
+	micro_heap* h = create_heap(allow_os);
+	MICRO_TEST(h != nullptr);
+
+	// Allocate twice the reserved size
+	std::vector<void*> ptrs;
+	size_t failed = 0;
+	for (size_t i = 0; i < (reserve_size * 2) / (1u << 20u); ++i) {
+		void* p = micro_heap_malloc(h, 1u << 20u);
+		if (p)
+			ptrs.push_back(p);
+		else
+			++failed;
+	}
+	if (allow_os)
+		MICRO_TEST(failed == 0);
+	else {
+		MICRO_TEST(failed > 0);
+		MICRO_TEST(ptrs.size() * (1u << 20u) <= reserve_size);
+	}
+
+	// Freed page runs are reused
+	for (void* p : ptrs)
+		micro_free(p);
+	void* p = micro_heap_malloc(h, 1u << 20u);
+	MICRO_TEST(p != nullptr);
+	micro_free(p);
+	micro_heap_destroy(h);
+}
+
+int test_reserve(int, char** const)
+{
+	MICRO_TEST_MODULE_RETURN(reserve_single_range, 1, test_single_range());
+	MICRO_TEST_MODULE_RETURN(reserve_exhausted, 1, test_exhausted(false));
+	MICRO_TEST_MODULE_RETURN(reserve_grow, 1, test_exhausted(true));
+	return 0;
+}
@@ -0,0 +1,229 @@
+#include <micro/micro.h>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// Heap shared between processes (micro_heap_create_shared()): chunks published
+// in a table stored in the heap are freed by other processes, either forked
+// children or separately started processes attaching the heap by filename.
+
+static constexpr size_t num_slots = 1024;
+static constexpr size_t shared_heap_size = 64u << 20u;
+static const char* file_name = "micro_test_shared_heap.bin";
+static const char* other_file_name = "micro_test_shared_heap_other.bin";
+
+struct Table
+{
+	std::atomic<void*> slots[num_slots];
+};
+
+static void* new_chunk(micro_heap* h, std::mt19937& gen)
+{
+	std::uniform_int_distribution<size_t> small_distribution(sizeof(size_t) + 1, 256);
+	std::uniform_int_distribution<size_t> medium_distribution(1024, 64 * 1024);
+	std::uniform_int_distribution<size_t> big_distribution(512 * 1024, 1024 * 1024);
+	unsigned kind = gen() % 1000;
+	size_t size = kind == 0 ? big_distribution(gen) : (kind < 100 ? medium_distribution(gen) : small_distribution(gen));
+
+	char* p = static_cast<char*>(micro_heap_malloc(h, size));
+	MICRO_TEST(p != nullptr);
+	memset(p, static_cast<char>(size), size);
+	memcpy(p, &size, sizeof(size));
+	return p;
+}
+
+static void free_chunk(void* chunk)
+{
+	if (!chunk)
+		return;
+	char* p = static_cast<char*>(chunk);
+	size_t size;
+	memcpy(&size, p, sizeof(size));
+	MICRO_TEST(p[size - 1] == static_cast<char>(size));
+	micro_free(p);
+}
+
+static void replace_chunks(micro_heap* h, Table* table, unsigned seed, size_t operations)
+{
+	std::mt19937 gen(seed);
+	for (size_t i = 0; i < operations; ++i) {
+		// Replace a random slot, or just empty it
+		void* p = (gen() & 3) ? new_chunk(h, gen) : nullptr;
+		free_chunk(table->slots[gen() % num_slots].exchange(p));
+	}
+}
+
+static void test_invalid_files()
+{
+	// Not a shared heap
+	{
+		std::ofstream out(other_file_name, std::ios::binary);
+		std::string garbage(1u << 20u, 'a');
+		out.write(garbage.data(), static_cast<std::streamsize>(garbage.size()));
+	}
+	MICRO_TEST(micro_heap_attach(other_file_name) == nullptr);
+
+	// Shared heap created by an incompatible build: alter the ABI tag following the magic
+	micro_heap* h = micro_heap_create_shared(other_file_name, 4u << 20u);
+	MICRO_TEST(h != nullptr);
+	micro_heap_destroy(h);
+	{
+		std::fstream f(other_file_name, std::ios::binary | std::ios::in | std::ios::out);
+		std::uint64_t abi = 0;
+		f.seekg(8);
+		f.read(reinterpret_cast<char*>(&abi), sizeof(abi));
+		abi = ~abi;
+		f.seekp(8);
+		f.write(reinterpret_cast<const char*>(&abi), sizeof(abi));
+	}
+	MICRO_TEST(micro_heap_attach(other_file_name) == nullptr);
+	std::remove(other_file_name);
+}
+
+#ifndef _WIN32
+
+static void wait_child(pid_t pid)
+{
+	int status = 0;
+	MICRO_TEST(pid > 0);
+	MICRO_TEST(waitpid(pid, &status, 0) == pid);
+	MICRO_TEST(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+static void test_fork_children(micro_heap* h, Table* table)
+{
+	static constexpr unsigned num_workers = 4;
+
+	// Workers inherit the heap, and free chunks allocated by the other ones
+	pid_t pids[num_workers];
+	for (unsigned i = 0; i < num_workers; ++i) {
+		pids[i] = fork();
+		if (pids[i] == 0) {
+			bool ok = true;
+			try {
+				replace_chunks(h, table, i, 20000);
+			}
+			catch (...) {
+				ok = false;
+			}
+			_exit(ok ? 0 : 1);
+		}
+	}
+	for (unsigned i = 0; i < num_workers; ++i)
+		wait_child(pids[i]);
+
+	// Detach the inherited heap and attach it again: same address, same content
+	pid_t pid = fork();
+	if (pid == 0) {
+		micro_heap_destroy(h);
+		micro_heap* attached = micro_heap_attach(file_name);
+		bool ok = attached == h && micro_heap_get_root(attached) == table;
+		try {
+			if (ok)
+				replace_chunks(attached, table, num_workers, 20000);
+		}
+		catch (...) {
+			ok = false;
+		}
+		_exit(ok ? 0 : 1);
+	}
+	wait_child(pid);
+}
+
+static void test_exec_child(char* test_name)
+{
+#ifdef __linux__
+	// The child is a separately started process (with its own load address if built as PIE),
+	// attaching the heap by filename
+	pid_t pid = fork();
+	if (pid == 0) {
+		char attach[] = "attach";
+		char file[64];
+		snprintf(file, sizeof(file), "%s", file_name);
+		char* args[] = { const_cast<char*>("micro_tests"), test_name, attach, file, nullptr };
+		execv("/proc/self/exe", args);
+		_exit(2);
+	}
+	wait_child(pid);
+#else
+	(void)test_name;
+#endif
+}
+
+#endif
+
+static void test_attached_process(const char* filename)
+{
+	micro_heap* h = micro_heap_attach(filename);
+	MICRO_TEST(h != nullptr);
+	Table* table = static_cast<Table*>(micro_heap_get_root(h));
+	MICRO_TEST(table != nullptr);
+
+	// Free the chunks of the creating process and replace them
+	for (size_t i = 0; i < num_slots; ++i)
+		free_chunk(table->slots[i].exchange(nullptr));
+	replace_chunks(h, table, 123, 20000);
+
+	// Attaching twice returns the same heap
+	MICRO_TEST(micro_heap_attach(filename) == h);
+	micro_heap_destroy(h);
+}
+
+static void test_shared_heap(char* test_name)
+{
+	std::remove(file_name);
+	micro_heap* h = micro_heap_create_shared(file_name, shared_heap_size);
+	MICRO_TEST(h != nullptr);
+	Table* table = static_cast<Table*>(micro_heap_malloc(h, sizeof(Table)));
+	MICRO_TEST(table != nullptr);
+	memset(static_cast<void*>(table), 0, sizeof(Table));
+	micro_heap_set_root(h, table);
+
+	replace_chunks(h, table, 42, 20000);
+#ifndef _WIN32
+	test_fork_children(h, table);
+	test_exec_child(test_name);
+#else
+	(void)test_name;
+#endif
+
+	// Chunks allocated by the other processes are freed by the creating one
+	for (size_t i = 0; i < num_slots; ++i)
+		free_chunk(table->slots[i].exchange(nullptr));
+	micro_free(table);
+
+	// Pages released by the other processes can be reused
+	void* big = micro_heap_malloc(h, shared_heap_size / 4u);
+	MICRO_TEST(big != nullptr);
+	micro_free(big);
+
+	micro_heap_destroy(h);
+	std::remove(file_name);
+}
+
+int test_shared_heap(int argc, char** const argv)
+{
+#ifndef MICRO_NO_FILE_MAPPING
+	// Child process started by test_exec_child()
+	if (argc == 3 && strcmp(argv[1], "attach") == 0) {
+		MICRO_TEST_MODULE_RETURN(shared_heap_attach, 1, test_attached_process(argv[2]));
+		return 0;
+	}
+	MICRO_TEST_MODULE_RETURN(shared_heap_invalid_files, 1, test_invalid_files());
+	MICRO_TEST_MODULE_RETURN(shared_heap, 1, test_shared_heap(argv[0]));
+#else
+	(void)argc;
+	(void)argv;
+#endif
+	return 0;
+}
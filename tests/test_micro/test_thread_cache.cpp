@@ -0,0 +1,132 @@
+#include <micro/micro.h>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Per thread magazines (MicroThreadCacheBytes) hold at most the configured
+// budget, are flushed on thread exit, and keep chunks freed by other threads valid.
+
+static std::uint64_t thread_cache_bytes(micro_heap* h)
+{
+	micro_statistics st;
+	memset(&st, 0, sizeof(st));
+	micro_heap_dump_stats(h, &st);
+	return st.thread_cache_bytes;
+}
+
+static void test_cache_budget(std::uint64_t budget)
+{
+	micro_heap* h = micro_heap_create();
+	MICRO_TEST(h != nullptr);
+	micro_heap_set_parameter(h, MicroThreadCacheBytes, budget);
+
+	std::atomic<int> step{ 0 };
+	bool ok = true;
+	std::thread th([&]() {
+		std::vector<void*> ptrs;
+		for (size_t i = 0; i < 4096; ++i) {
+			void* p = micro_heap_malloc(h, 16 + (i % 16) * 16);
+			if (!p)
+				ok = false;
+			ptrs.push_back(p);
+		}
+		for (void* p : ptrs)
+			micro_free(p);
+		// Let the main thread inspect the cache before exiting
+		step = 1;
+		while (step.load() != 2)
+			std::this_thread::yield();
+	});
+	while (step.load() != 1)
+		std::this_thread::yield();
+
+	const std::uint64_t held = thread_cache_bytes(h);
+	step = 2;
+	th.join();
+	MICRO_TEST(ok);
+	MICRO_TEST(held > 0 && held <= budget);
+
+	// All magazines are flushed on thread exit
+	MICRO_TEST(thread_cache_bytes(h) == 0);
+	micro_heap_destroy(h);
+}
+
+static void test_cache_disabled()
+{
+	micro_heap* h = micro_heap_create();
+	MICRO_TEST(h != nullptr);
+	micro_heap_set_parameter(h, MicroThreadCacheBytes, 0);
+	void* p = micro_heap_malloc(h, 32);
+	MICRO_TEST(p != nullptr);
+	micro_free(p);
+	MICRO_TEST(thread_cache_bytes(h) == 0);
+	micro_heap_destroy(h);
+}
+
+static void small_thread(micro_heap* h, unsigned seed, std::atomic<char*>* slots, bool* ok)
+{
+	static constexpr size_t num_slots = 1024;
+	std::mt19937 gen(seed);
+	std::uniform_int_distribution<> size_distribution(16, 255);
+
+	// Slots are shared by all threads: chunks are usually freed by another thread
+	*ok = true;
+	for (int i = 0; i < 200000 && *ok; ++i) {
+		size_t size = static_cast<size_t>(size_distribution(gen));
+		char* p = static_cast<char*>(micro_heap_malloc(h, size));
+		if (!p) {
+			*ok = false;
+			break;
+		}
+		memset(p, static_cast<char>(size), size);
+		if (char* old = slots[gen() % num_slots].exchange(p)) {
+			size_t old_size = static_cast<unsigned char>(old[0]);
+			if (old_size < 16 || old[old_size - 1] != old[0])
+				*ok = false;
+			micro_free(old);
+		}
+	}
+}
+
+static void test_cache_threads(unsigned threads, std::uint64_t budget)
+{
+	static constexpr size_t num_slots = 1024;
+	micro_heap* h = micro_heap_create();
+	MICRO_TEST(h != nullptr);
+	micro_heap_set_parameter(h, MicroThreadCacheBytes, budget);
+
+	std::vector<std::atomic<char*>> slots(num_slots);
+	for (auto& s : slots)
+		s.store(nullptr);
+	std::vector<std::thread> ths;
+	std::unique_ptr<bool[]> ok(new bool[threads]);
+	for (unsigned i = 0; i < threads; ++i)
+		ths.emplace_back(small_thread, h, 42 + i, slots.data(), &ok[i]);
+	for (auto& t : ths)
+		t.join();
+	for (unsigned i = 0; i < threads; ++i)
+		MICRO_TEST(ok[i]);
+	MICRO_TEST(thread_cache_bytes(h) == 0);
+
+	for (auto& s : slots)
+		micro_free(s.load());
+	micro_heap_destroy(h);
+}
+
+int test_thread_cache(int, char** const)
+{
+#ifndef MICRO_NO_LOCK
+	MICRO_TEST_MODULE_RETURN(thread_cache_disabled, 1, test_cache_disabled());
+	MICRO_TEST_MODULE_RETURN(thread_cache_budget_4MB, 1, test_cache_budget(4u << 20u));
+	MICRO_TEST_MODULE_RETURN(thread_cache_budget_32KB, 1, test_cache_budget(32u << 10u));
+	MICRO_TEST_MODULE_RETURN(thread_cache_threads, 1, test_cache_threads(4, 4u << 20u));
+	MICRO_TEST_MODULE_RETURN(thread_cache_tiny_budget, 1, test_cache_threads(4, 4096));
+#endif
+	return 0;
+}
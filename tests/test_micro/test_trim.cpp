@@ -0,0 +1,68 @@
+#include <micro/micro.h>
+#include <micro/testing.hpp>
+#include <iostream>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+// Trim a mostly empty heap: a few scattered chunks keep their page runs alive,
+// the first micro_heap_trim() gives back the free pages, a second call has
+// nothing left to release.
+
+static void test_trim_heap(uint64_t cache_bytes, uint64_t decommit_threshold)
+{
+	static constexpr size_t num_objects = 50000;
+	static constexpr size_t keep_every = 64;
+
+	micro_heap* h = micro_heap_create();
+	MICRO_TEST(h != nullptr);
+	micro_heap_set_parameter(h, MicroThreadCacheBytes, cache_bytes);
+	micro_heap_set_parameter(h, MicroDecommitThreshold, decommit_threshold);
+
+	std::mt19937 gen(42);
+	std::uniform_int_distribution<> small_distribution(16, 256);
+	std::uniform_int_distribution<> medium_distribution(1024, 64 * 1024);
+
+	std::vector<char*> ptrs(num_objects);
+	std::vector<size_t> sizes(num_objects);
+	for (size_t i = 0; i < num_objects; ++i) {
+		size_t size = static_cast<size_t>((i & 7) ? small_distribution(gen) : medium_distribution(gen));
+		char* p = static_cast<char*>(micro_heap_malloc(h, size));
+		MICRO_TEST(p != nullptr);
+		memset(p, static_cast<char>(i), size);
+		ptrs[i] = p;
+		sizes[i] = size;
+	}
+	for (size_t i = 0; i < num_objects; ++i)
+		if (i % keep_every) {
+			micro_free(ptrs[i]);
+			ptrs[i] = nullptr;
+		}
+
+	MICRO_TEST(micro_heap_trim(h, 0) > 0);
+	// Pages already released must not be counted again
+	MICRO_TEST(micro_heap_trim(h, 0) == 0);
+
+	// Remaining chunks must be left untouched
+	for (size_t i = 0; i < num_objects; ++i)
+		if (ptrs[i]) {
+			MICRO_TEST(ptrs[i][0] == static_cast<char>(i) && ptrs[i][sizes[i] - 1] == static_cast<char>(i));
+			micro_free(ptrs[i]);
+		}
+
+	// Freeing the survivors merges them with decommitted chunks,
+	// the released pages are still not counted twice.
+	micro_heap_trim(h, 0);
+	MICRO_TEST(micro_heap_trim(h, 0) == 0);
+
+	micro_heap_destroy(h);
+}
+
+int test_trim(int, char** const)
+{
+	MICRO_TEST_MODULE_RETURN(trim, 1, test_trim_heap(0, 0));
+	MICRO_TEST_MODULE_RETURN(trim_thread_cache, 1, test_trim_heap(1024 * 1024, 0));
+	MICRO_TEST_MODULE_RETURN(trim_decommit_threshold, 1, test_trim_heap(0, 64 * 1024));
+	return 0;
+}